@@ -37,6 +37,8 @@
 #include <limits.h>
 #include <termios.h>
 #include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #define VID       (0x1d50)
 #define PID       (0x6018)
@@ -44,6 +46,15 @@
 #define ENDPOINT  (0x85)
 
 #define TRANSFER_SIZE (64)
+
+/* USB capture engine: number and size of bulk transfers kept queued on the trace endpoint */
+#define USB_NUM_TRANSFERS (8)
+#define USB_TRANSFER_SIZE (16384)
+#define USB_TIMEOUT_MS    (100)
+
+/* Size of the ring between the USB callbacks and the decoder, must be a power of 2 */
+#define RING_SIZE         (1U << 22)
+#define RING_POLL_US      (1000)
 #define NUM_FIFOS     32
 #define MAX_FIFOS     128
 
@@ -70,6 +81,26 @@ struct
   int fifo[MAX_FIFOS];
 } _r;
 
+// Single producer (USB callbacks), single consumer (decoder) lock-free ring
+struct
+{
+  uint8_t buf[RING_SIZE];
+  atomic_size_t wp;
+  atomic_size_t rp;
+  atomic_ulong totalBytes;
+  atomic_ulong overrunBytes;
+  atomic_ulong overrunEvents;
+} _ring;
+
+// USB capture engine state, only touched from the USB thread
+struct
+{
+  struct libusb_transfer *transfer[USB_NUM_TRANSFERS];
+  unsigned char *buf[USB_NUM_TRANSFERS];
+  int active;
+  BOOL alive;
+} _usb;
+
 // ====================================================================================================
 // ====================================================================================================
 // ====================================================================================================
@@ -180,6 +211,63 @@ static void _removeFifoTasks(void)
 // ====================================================================================================
 // ====================================================================================================
 // ====================================================================================================
+// Ring buffer between capture and decode
+// ====================================================================================================
+// ====================================================================================================
+// ====================================================================================================
+static void _ringWrite(const uint8_t *d, size_t len)
+
+/* Called from the USB callback. Data that doesn't fit is dropped and accounted as an overrun */
+
+{
+  size_t wp=atomic_load_explicit(&_ring.wp,memory_order_relaxed);
+  size_t rp=atomic_load_explicit(&_ring.rp,memory_order_acquire);
+  size_t space=RING_SIZE-(wp-rp);
+
+  atomic_fetch_add_explicit(&_ring.totalBytes,len,memory_order_relaxed);
+  if (len>space)
+    {
+      atomic_fetch_add_explicit(&_ring.overrunBytes,len-space,memory_order_relaxed);
+      atomic_fetch_add_explicit(&_ring.overrunEvents,1,memory_order_relaxed);
+      len=space;
+    }
+
+  size_t offset=wp&(RING_SIZE-1);
+  size_t first=(len<RING_SIZE-offset)?len:RING_SIZE-offset;
+  memcpy(&_ring.buf[offset],d,first);
+  memcpy(_ring.buf,d+first,len-first);
+  atomic_store_explicit(&_ring.wp,wp+len,memory_order_release);
+}
+// ====================================================================================================
+static size_t _ringRead(uint8_t *d, size_t maxLen)
+
+/* Called from the decoder thread, returns the number of bytes taken from the ring */
+
+{
+  size_t rp=atomic_load_explicit(&_ring.rp,memory_order_relaxed);
+  size_t wp=atomic_load_explicit(&_ring.wp,memory_order_acquire);
+  size_t len=wp-rp;
+
+  if (len>maxLen)
+    len=maxLen;
+
+  size_t offset=rp&(RING_SIZE-1);
+  size_t first=(len<RING_SIZE-offset)?len:RING_SIZE-offset;
+  memcpy(d,&_ring.buf[offset],first);
+  memcpy(d+first,_ring.buf,len-first);
+  atomic_store_explicit(&_ring.rp,rp+len,memory_order_release);
+  return len;
+}
+// ====================================================================================================
+static void _reportOverruns(void)
+
+{
+  fprintf(stderr,"Captured %lu bytes, %lu bytes lost in %lu host overruns\n",
+	  atomic_load(&_ring.totalBytes),atomic_load(&_ring.overrunBytes),atomic_load(&_ring.overrunEvents));
+}
+// ====================================================================================================
+// ====================================================================================================
+// ====================================================================================================
 // Handlers for each message type
 // ====================================================================================================
 // ====================================================================================================
@@ -410,49 +498,169 @@ int _processOptions(int argc, char *argv[])
   return TRUE;
 }
 // ====================================================================================================
-int usbFeeder(void)
+static void LIBUSB_CALL _usbCallback(struct libusb_transfer *t)
+
+/* Completed trace transfer: hand the data to the decoder and put the transfer straight back in the queue */
 
 {
+  if ((t->status==LIBUSB_TRANSFER_COMPLETED) || (t->status==LIBUSB_TRANSFER_TIMED_OUT))
+    {
+      if (t->actual_length>0)
+	_ringWrite(t->buffer,t->actual_length);
 
-  unsigned char cbw[TRANSFER_SIZE];
+      if ((_usb.alive) && (libusb_submit_transfer(t)==0))
+	return;
+    }
+  else if ((options.verbose) && (t->status!=LIBUSB_TRANSFER_CANCELLED))
+    {
+      fprintf(stderr,"Trace transfer failed (%d)\n",t->status);
+    }
+
+  /* This transfer is out of the queue, so the device has most likely gone away */
+  _usb.alive=FALSE;
+  _usb.active--;
+}
+// ====================================================================================================
+static void _usbFreeTransfers(void)
+
+{
+  for (int t=0; t<USB_NUM_TRANSFERS; t++)
+    {
+      libusb_free_transfer(_usb.transfer[t]);
+      free(_usb.buf[t]);
+      _usb.transfer[t]=NULL;
+      _usb.buf[t]=NULL;
+    }
+}
+// ====================================================================================================
+static void *usbFeeder(void *arg)
+
+/* Capture thread: keep USB_NUM_TRANSFERS asynchronous reads queued on the trace endpoint at all times */
+
+{
   libusb_device_handle *handle;
   libusb_device *dev;
-  int size;
+
+  if (libusb_init(NULL) < 0)
+    {
+      fprintf(stderr,"Failed to initalise USB interface\n");
+      exit(-1);
+    }
 
   while (1)
     {
-      if (libusb_init(NULL) < 0)
+      while (!(handle = libusb_open_device_with_vid_pid(NULL, VID, PID)))
 	{
-	  fprintf(stderr,"Failed to initalise USB interface\n");
-	  return (-1);
+	  usleep(500000);
 	}
 
-      while (!(handle = libusb_open_device_with_vid_pid(NULL, VID, PID)))
+      if ((!(dev = libusb_get_device(handle))) || (libusb_claim_interface (handle, INTERFACE)<0))
 	{
+	  libusb_close(handle);
 	  usleep(500000);
+	  continue;
 	}
 
-      if (!(dev = libusb_get_device(handle)))
-	continue;
+      if (options.verbose)
+	{
+	  fprintf(stderr,"Probe opened\n");
+	}
 
-      if (libusb_claim_interface (handle, INTERFACE)<0)
-	continue;
+      _usb.alive=TRUE;
+      _usb.active=0;
+      for (int t=0; t<USB_NUM_TRANSFERS; t++)
+	{
+	  _usb.transfer[t]=libusb_alloc_transfer(0);
+	  _usb.buf[t]=malloc(USB_TRANSFER_SIZE);
+	  if ((!_usb.transfer[t]) || (!_usb.buf[t]))
+	    {
+	      fprintf(stderr,"Failed to allocate transfers\n");
+	      exit(-1);
+	    }
 
-      while (0==libusb_bulk_transfer(handle, ENDPOINT, cbw, TRANSFER_SIZE, &size, 10))
+	  libusb_fill_bulk_transfer(_usb.transfer[t], handle, ENDPOINT, _usb.buf[t], USB_TRANSFER_SIZE,
+				    _usbCallback, NULL, USB_TIMEOUT_MS);
+	  if (libusb_submit_transfer(_usb.transfer[t])==0)
+	    _usb.active++;
+	}
+
+      /* Callbacks run from here, they keep resubmitting until the probe goes away */
+      BOOL cancelled=FALSE;
+      while (_usb.active)
 	{
-	  unsigned char *c=cbw;
-          if (options.dump)
-          {
-              cbw[size] = 0;
-              printf("%s", (char*)cbw);
-          }
-          else
-              while (size--)
-                  _protocolPump(c++);
+	  /* Treat a failure handling events as the probe going away */
+	  if (libusb_handle_events(NULL)<0)
+	    _usb.alive=FALSE;
+
+	  /* Cancel whatever is still queued, then keep handling events until every callback has fired */
+	  if ((!_usb.alive) && (!cancelled))
+	    {
+	      for (int t=0; t<USB_NUM_TRANSFERS; t++)
+		libusb_cancel_transfer(_usb.transfer[t]);
+	      cancelled=TRUE;
+	    }
+	}
+
+      if (options.verbose)
+	{
+	  fprintf(stderr,"Probe lost\n");
 	}
 
+      _usbFreeTransfers();
+      libusb_release_interface(handle, INTERFACE);
       libusb_close(handle);
     }
+  return arg;
+}
+// ====================================================================================================
+int usbDecoder(void)
+
+/* Start the capture thread and then decode whatever it produces */
+
+{
+  static uint8_t cbw[USB_TRANSFER_SIZE];
+  pthread_t usbThread;
+  unsigned long reportedOverruns=0;
+
+  if (pthread_create(&usbThread,NULL,usbFeeder,NULL)!=0)
+    {
+      fprintf(stderr,"Failed to start USB capture thread\n");
+      return (-1);
+    }
+
+  if (options.verbose)
+    atexit(_reportOverruns);
+
+  while (1)
+    {
+      size_t size=_ringRead(cbw,sizeof(cbw));
+
+      if (!size)
+	{
+	  usleep(RING_POLL_US);
+	  continue;
+	}
+
+      if (options.dump)
+	{
+	  fwrite(cbw,1,size,stdout);
+	  fflush(stdout);
+	}
+      else
+	{
+	  uint8_t *c=cbw;
+	  while (size--)
+	    _protocolPump(c++);
+	}
+
+      unsigned long overruns=atomic_load_explicit(&_ring.overrunEvents,memory_order_relaxed);
+      if ((options.verbose) && (overruns!=reportedOverruns))
+	{
+	  fprintf(stderr,"Host overrun, %lu bytes lost so far\n",
+		  atomic_load_explicit(&_ring.overrunBytes,memory_order_relaxed));
+	  reportedOverruns=overruns;
+	}
+    }
 }
 // ====================================================================================================
 int serialFeeder(void)
@@ -538,7 +746,7 @@ int main(int argc, char *argv[])
 
   /* Using the exit construct rather than return ensures the atexit gets called */
   if (!options.port)
-    exit(usbFeeder());
+    exit(usbDecoder());
   else
     exit(serialFeeder());
   fprintf(stderr,"Returned\n");
@@ -46,6 +46,10 @@
 #include "traceswo.h"
 #endif
 
+#if PC_HOSTED == 1
+#include "flm.h"
+#endif
+
 #if defined(_WIN32)
 #include <malloc.h>
 #else
@@ -72,6 +76,9 @@ static bool cmd_target_power(target_s *t, int argc, const char **argv);
 static bool cmd_traceswo(target_s *t, int argc, const char **argv);
 #endif
 static bool cmd_heapinfo(target_s *t, int argc, const char **argv);
+static bool cmd_mem_fill(target_s *t, int argc, const char **argv);
+static bool cmd_mem_copy(target_s *t, int argc, const char **argv);
+static bool cmd_memtest(target_s *t, int argc, const char **argv);
 #ifdef ENABLE_RTT
 static bool cmd_rtt(target_s *t, int argc, const char **argv);
 #endif
@@ -80,6 +87,7 @@ static bool cmd_debug_bmp(target_s *t, int argc, const char **argv);
 #endif
 #if PC_HOSTED == 1
 static bool cmd_shutdown_bmda(target_s *t, int argc, const char **argv);
+static bool cmd_flm(target_s *t, int argc, const char **argv);
 #endif
 
 const command_s cmd_list[] = {
@@ -113,11 +121,15 @@ const command_s cmd_list[] = {
 #endif
 #endif
 	{"heapinfo", cmd_heapinfo, "Set semihosting heapinfo: HEAPINFO HEAP_BASE HEAP_LIMIT STACK_BASE STACK_LIMIT"},
+	{"mem_fill", cmd_mem_fill, "Fill target memory with a repeating pattern: ADDR LENGTH PATTERN [8|16|32]"},
+	{"mem_copy", cmd_mem_copy, "Copy a block of target memory: DEST SRC LENGTH"},
+	{"memtest", cmd_memtest, "Destructively test target RAM: ADDR LENGTH"},
 #if defined(PLATFORM_HAS_DEBUG) && PC_HOSTED == 0
 	{"debug_bmp", cmd_debug_bmp, "Output BMP \"debug\" strings to the second vcom: [enable|disable]"},
 #endif
 #if PC_HOSTED == 1
 	{"shutdown_bmda", cmd_shutdown_bmda, "Tell the BMDA server to shut down when the GDB connection closes"},
+	{"flm", cmd_flm, "Program Flash using a CMSIS-Pack Flash algorithm: FILE"},
 #endif
 	{NULL, NULL, NULL},
 };
@@ -622,7 +634,7 @@ static bool cmd_traceswo(target_s *t, int argc, const char **argv)
 	}
 
 #if TRACESWO_PROTOCOL == 2
-	gdb_outf("Baudrate: %lu ", baudrate);
+	gdb_outf("Baudrate: %" PRIu32 " ", baudrate);
 #endif
 	gdb_outf("Channel mask: ");
 	for (size_t i = 0; i < 32U; ++i) {
@@ -637,7 +649,9 @@ static bool cmd_traceswo(target_s *t, int argc, const char **argv)
 	traceswo_init(swo_channelmask);
 #endif
 
+#if PC_HOSTED == 0
 	gdb_outf("Trace enabled for BMP serial %s, USB EP 5\n", serial_no);
+#endif
 	return true;
 }
 #endif
@@ -668,6 +682,19 @@ static bool cmd_shutdown_bmda(target_s *t, int argc, const char **argv)
 	shutdown_bmda = true;
 	return true;
 }
+
+static bool cmd_flm(target_s *t, int argc, const char **argv)
+{
+	if (!t || !target_attached(t)) {
+		gdb_out("Attach to a target first\n");
+		return false;
+	}
+	if (argc != 2) {
+		gdb_out("usage: monitor flm FILE\n");
+		return false;
+	}
+	return flm_load(t, argv[1]);
+}
 #endif
 
 static bool cmd_heapinfo(target_s *t, int argc, const char **argv)
@@ -686,3 +713,74 @@ static bool cmd_heapinfo(target_s *t, int argc, const char **argv)
 		gdb_outf("heapinfo heap_base heap_limit stack_base stack_limit\n");
 	return true;
 }
+
+static bool cmd_mem_fill(target_s *t, int argc, const char **argv)
+{
+	if (!t || !target_attached(t)) {
+		gdb_out("Attach to a target first\n");
+		return false;
+	}
+	if (argc != 4 && argc != 5) {
+		gdb_out("usage: monitor mem_fill ADDR LENGTH PATTERN [8|16|32]\n");
+		return false;
+	}
+	const target_addr_t addr = strtoul(argv[1], NULL, 0);
+	const size_t length = strtoul(argv[2], NULL, 0);
+	const uint32_t pattern = strtoul(argv[3], NULL, 0);
+	const uint32_t bits = argc == 5 ? strtoul(argv[4], NULL, 0) : 32U;
+	if (bits != 8U && bits != 16U && bits != 32U) {
+		gdb_out("Pattern width must be 8, 16 or 32 bits\n");
+		return false;
+	}
+	const align_e width = bits == 8U ? ALIGN_8BIT : bits == 16U ? ALIGN_16BIT : ALIGN_32BIT;
+	if (target_mem_fill(t, addr, pattern, width, length)) {
+		gdb_outf("Fill of %zu bytes at 0x%08" PRIx32 " failed\n", length, addr);
+		return false;
+	}
+	return true;
+}
+
+static bool cmd_mem_copy(target_s *t, int argc, const char **argv)
+{
+	if (!t || !target_attached(t)) {
+		gdb_out("Attach to a target first\n");
+		return false;
+	}
+	if (argc != 4) {
+		gdb_out("usage: monitor mem_copy DEST SRC LENGTH\n");
+		return false;
+	}
+	const target_addr_t dest = strtoul(argv[1], NULL, 0);
+	const target_addr_t src = strtoul(argv[2], NULL, 0);
+	const size_t length = strtoul(argv[3], NULL, 0);
+	if (target_mem_copy(t, dest, src, length)) {
+		gdb_outf("Copy of %zu bytes to 0x%08" PRIx32 " failed\n", length, dest);
+		return false;
+	}
+	return true;
+}
+
+static bool cmd_memtest(target_s *t, int argc, const char **argv)
+{
+	if (!t || !target_attached(t)) {
+		gdb_out("Attach to a target first\n");
+		return false;
+	}
+	if (argc != 3) {
+		gdb_out("usage: monitor memtest ADDR LENGTH\n");
+		return false;
+	}
+	const target_addr_t addr = strtoul(argv[1], NULL, 0);
+	const size_t length = strtoul(argv[2], NULL, 0);
+	target_mem_fault_s faults[MEMTEST_MAX_FAULTS];
+	const size_t count = target_mem_test(t, addr, length, faults, ARRAY_LENGTH(faults));
+	if (count == SIZE_MAX) {
+		gdb_out("Memory test could not be run, the range must be word aligned and the target halted\n");
+		return false;
+	}
+	for (size_t idx = 0; idx < count; ++idx)
+		gdb_outf("Fault at 0x%08" PRIx32 ": wrote 0x%08" PRIx32 ", read 0x%08" PRIx32 "\n", faults[idx].addr,
+			faults[idx].expected, faults[idx].actual);
+	gdb_outf("Memory test of %zu bytes at 0x%08" PRIx32 " %s\n", length, addr, count ? "failed" : "passed");
+	return count == 0;
+}
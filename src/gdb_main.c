@@ -63,6 +63,7 @@
 #include <stdlib.h>
 
 typedef enum gdb_signal {
+	GDB_SIGNONE = 0,
 	GDB_SIGINT = 2,
 	GDB_SIGTRAP = 5,
 	GDB_SIGSEGV = 11,
@@ -85,18 +86,22 @@ typedef struct cmd_executer {
 target_s *cur_target;
 target_s *last_target;
 bool gdb_target_running = false;
+bool gdb_non_stop = false;
 static bool gdb_needs_detach_notify = false;
+/* The last stop reply sent, so non-stop mode '?' queries can be answered without polling the target */
+static char gdb_last_stop_reply[32] = "T05";
 
 static void handle_q_packet(char *packet, size_t len);
 static void handle_v_packet(char *packet, size_t len);
 static void handle_z_packet(char *packet, size_t len);
 static void handle_kill_target(void);
+static void gdb_send_stop_reply(const char *reply);
 
 static void gdb_target_destroy_callback(target_controller_s *tc, target_s *t)
 {
 	(void)tc;
 	if (cur_target == t) {
-		gdb_put_notificationz("%Stop:W00");
+		gdb_put_notificationz("Stop:W00");
 		gdb_out("You are now detached from the previous target.\n");
 		cur_target = NULL;
 		gdb_needs_detach_notify = true;
@@ -130,6 +135,25 @@ target_controller_s gdb_controller = {
 	.system = hostio_system,
 };
 
+/*
+ * In non-stop mode GDB can make requests while the target is running. Check whether it's too busy to serve
+ * one: register requests can't be serviced then, memory requests can. On targets that have to be halted for
+ * memory accesses, this starts a brokered access (see target_mem_access_begin()), so as a side effect the
+ * target may be left held halted until the broker lets it go again.
+ */
+static bool gdb_target_busy(const bool memory_access)
+{
+	if (!gdb_non_stop || !gdb_target_running)
+		return false;
+	return !memory_access || !target_mem_access_begin(cur_target);
+}
+
+#define ERROR_IF_TARGET_BUSY(memory_access) \
+	if (gdb_target_busy(memory_access)) {   \
+		gdb_putpacketz("E01");              \
+		break;                              \
+	}
+
 /* execute gdb remote command stored in 'pbuf'. returns immediately, no busy waiting. */
 
 int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t size, bool in_syscall)
@@ -141,6 +165,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 	/* Implementation of these is mandatory! */
 	case 'g': { /* 'g': Read general registers */
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(false);
 		const size_t reg_size = target_regs_size(cur_target);
 		if (reg_size) {
 			uint8_t gp_regs[reg_size];
@@ -154,6 +179,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 	case 'm': { /* 'm addr,len': Read len bytes from addr */
 		uint32_t addr, len;
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(true);
 		sscanf(pbuf, "m%" SCNx32 ",%" SCNx32, &addr, &len);
 		if (len > pbuf_size / 2U) {
 			gdb_putpacketz("E02");
@@ -169,6 +195,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 	}
 	case 'G': { /* 'G XX': Write general registers */
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(false);
 		const size_t reg_size = target_regs_size(cur_target);
 		if (reg_size) {
 			uint8_t gp_regs[reg_size];
@@ -183,6 +210,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 		uint32_t len = 0;
 		int hex;
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(true);
 		sscanf(pbuf, "M%" SCNx32 ",%" SCNx32 ":%n", &addr, &len, &hex);
 		if (len > (unsigned)(size - hex) / 2U) {
 			gdb_putpacketz("E02");
@@ -223,6 +251,12 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 
 		target_halt_resume(cur_target, single_step);
 		SET_RUN_STATE(true);
+		if (gdb_non_stop) {
+			/* In non-stop mode the resume is acknowledged now, and the stop gets reported asynchronously */
+			gdb_target_running = true;
+			gdb_putpacketz("OK");
+			break;
+		}
 		/* fall through */
 	case '?': { /* '?': Request reason for target halt */
 		/*
@@ -234,6 +268,16 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 			break;
 		}
 
+		/* In non-stop mode, answer straight away with either the last stop or OK for "nothing stopped" */
+		if (gdb_non_stop) {
+			if (gdb_target_running)
+				gdb_putpacketz("OK");
+			else
+				gdb_putpacket_f(
+					"%s%s", gdb_last_stop_reply, gdb_last_stop_reply[0] == 'T' ? "thread:1;" : "");
+			break;
+		}
+
 		/*
 		 * The target is running, so there is no response to give.
 		 * The calling function will poll the state of the target
@@ -247,6 +291,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 	/* Optional GDB packet support */
 	case 'p': { /* Read single register */
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(false);
 		if (cur_target->reg_read) {
 			uint32_t reg;
 			sscanf(pbuf, "p%" SCNx32, &reg);
@@ -263,6 +308,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 	}
 	case 'P': { /* Write single register */
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(false);
 		if (cur_target->reg_write) {
 			uint32_t reg;
 			int n;
@@ -335,6 +381,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 		uint32_t addr, len;
 		int bin;
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(true);
 		sscanf(pbuf, "X%" SCNx32 ",%" SCNx32 ":%n", &addr, &len, &bin);
 		if (len > (unsigned)(size - bin)) {
 			gdb_putpacketz("E02");
@@ -361,6 +408,7 @@ int gdb_main_loop(target_controller_s *tc, char *pbuf, size_t pbuf_size, size_t
 	case 'Z': /* Z type,addr,len: Set breakpoint packet */
 	case 'z': /* z type,addr,len: Clear breakpoint packet */
 		ERROR_IF_NO_TARGET();
+		ERROR_IF_TARGET_BUSY(true);
 		handle_z_packet(pbuf, size);
 		break;
 
@@ -438,13 +486,15 @@ static void exec_q_supported(const char *packet, const size_t length)
 	(void)length;
 
 	/*
-	 * This is the first packet sent by GDB, so we can reset the NoAckMode flag here in case
-	 * the previous session was terminated abruptly with NoAckMode enabled
+	 * This is the first packet sent by GDB, so we can reset the NoAckMode and non-stop flags here in case
+	 * the previous session was terminated abruptly with them enabled
 	 */
 	gdb_set_noackmode(false);
+	gdb_non_stop = false;
 
 	gdb_putpacket_f(
-		"PacketSize=%X;qXfer:memory-map:read+;qXfer:features:read+" GDB_QSUPPORTED_NOACKMODE, GDB_MAX_PACKET_SIZE);
+		"PacketSize=%X;qXfer:memory-map:read+;qXfer:features:read+;QNonStop+" GDB_QSUPPORTED_NOACKMODE,
+		GDB_MAX_PACKET_SIZE);
 }
 
 static void exec_q_memory_map(const char *packet, const size_t length)
@@ -487,7 +537,7 @@ static void exec_q_crc(const char *packet, const size_t length)
 	uint32_t addr;
 	uint32_t addr_length;
 	if (sscanf(packet, "%" PRIx32 ",%" PRIx32, &addr, &addr_length) == 2) {
-		if (!cur_target) {
+		if (!cur_target || gdb_target_busy(true)) {
 			gdb_putpacketz("E01");
 			return;
 		}
@@ -540,6 +590,23 @@ static void exec_q_noackmode(const char *packet, const size_t length)
 	gdb_putpacketz("OK");
 }
 
+/*
+ * GDB sends 'QNonStop:1' to switch to non-stop mode, where the target is resumed and stopped with vCont,
+ * stops are reported with %Stop notifications, and requests can be made while the target runs.
+ * 'QNonStop:0' switches back to all-stop mode.
+ */
+static void exec_q_non_stop(const char *packet, const size_t length)
+{
+	(void)length;
+	if (packet[0] != '0' && packet[0] != '1') {
+		gdb_putpacketz("E01");
+		return;
+	}
+	gdb_non_stop = packet[0] == '1';
+	DEBUG_GDB("%s non-stop mode\n", gdb_non_stop ? "Enabling" : "Disabling");
+	gdb_putpacketz("OK");
+}
+
 static const cmd_executer_s q_commands[] = {
 	{"qRcmd,", exec_q_rcmd},
 	{"qSupported", exec_q_supported},
@@ -550,6 +617,7 @@ static const cmd_executer_s q_commands[] = {
 	{"qfThreadInfo", exec_q_thread_info},
 	{"qsThreadInfo", exec_q_thread_info},
 	{"QStartNoAckMode", exec_q_noackmode},
+	{"QNonStop:", exec_q_non_stop},
 	{NULL, NULL},
 };
 
@@ -571,6 +639,53 @@ static void handle_q_packet(char *packet, const size_t length)
 	gdb_putpacket("", 0);
 }
 
+/*
+ * 'vCont[;action[:thread-id]]...': Resume or stop the target. We only have the one thread,
+ * so the first action that applies to it (or to all threads) is the one to perform.
+ */
+static void handle_v_cont(const char *const actions)
+{
+	char action = '\0';
+	for (const char *entry = actions; entry && entry[0] == ';';) {
+		const char *const next = strchr(entry + 1U, ';');
+		const char *const thread = strchr(entry + 1U, ':');
+		if (!thread || (next && thread > next) || thread[1] == '-' || strtoul(thread + 1U, NULL, 16) == 1U) {
+			action = entry[1];
+			break;
+		}
+		entry = next;
+	}
+
+	bool single_step = false;
+	switch (action) {
+	case 's':
+	case 'S':
+		single_step = true;
+		/* fall through */
+	case 'c':
+	case 'C':
+		if (!cur_target) {
+			gdb_putpacketz(gdb_non_stop ? "E01" : "X1D");
+			break;
+		}
+		target_halt_resume(cur_target, single_step);
+		SET_RUN_STATE(true);
+		/* The stop gets reported by gdb_poll_target(), as a stop reply in all-stop mode or a notification in non-stop */
+		gdb_target_running = true;
+		if (gdb_non_stop)
+			gdb_putpacketz("OK");
+		break;
+	case 't':
+		/* Only a running target needs stopping, and so generates a stop notification */
+		if (cur_target && gdb_target_running)
+			target_halt_request(cur_target);
+		gdb_putpacketz("OK");
+		break;
+	default:
+		gdb_putpacketz("E01");
+	}
+}
+
 static void handle_v_packet(char *packet, const size_t plen)
 {
 	uint32_t addr = 0;
@@ -590,8 +705,15 @@ static void handle_v_packet(char *packet, const size_t plen)
 			 * https://sourceware.org/pipermail/gdb-patches/2021-December/184171.html
 			 * https://sourceware.org/pipermail/gdb-patches/2022-April/188058.html
 			 * https://sourceware.org/pipermail/gdb-patches/2022-July/190869.html
+			 *
+			 * In non-stop mode the attach is acknowledged and the stop is reported as a notification.
 			 */
-			gdb_putpacketz("T05thread:1;");
+			gdb_target_running = false;
+			if (gdb_non_stop) {
+				gdb_putpacketz("OK");
+				gdb_send_stop_reply("T05");
+			} else
+				gdb_putpacketz("T05thread:1;");
 		} else
 			gdb_putpacketz("E01");
 
@@ -658,7 +780,7 @@ static void handle_v_packet(char *packet, const size_t plen)
 	} else if (sscanf(packet, "vFlashErase:%08" PRIx32 ",%08" PRIx32, &addr, &len) == 2) {
 		/* Erase Flash Memory */
 		DEBUG_GDB("Flash Erase %08" PRIX32 " %08" PRIX32 "\n", addr, len);
-		if (!cur_target) {
+		if (!cur_target || gdb_target_busy(false)) {
 			gdb_putpacketz("EFF");
 			return;
 		}
@@ -674,7 +796,7 @@ static void handle_v_packet(char *packet, const size_t plen)
 		/* Write Flash Memory */
 		const uint32_t count = plen - bin;
 		DEBUG_GDB("Flash Write %08" PRIX32 " %08" PRIX32 "\n", addr, count);
-		if (cur_target && target_flash_write(cur_target, addr, (void *)packet + bin, count))
+		if (cur_target && !gdb_target_busy(false) && target_flash_write(cur_target, addr, (void *)packet + bin, count))
 			gdb_putpacketz("OK");
 		else {
 			target_flash_complete(cur_target);
@@ -688,6 +810,13 @@ static void handle_v_packet(char *packet, const size_t plen)
 		else
 			gdb_putpacketz("EFF");
 
+	} else if (!strcmp(packet, "vCont?")) {
+		/* Report the vCont actions we support */
+		gdb_putpacketz("vCont;c;C;s;S;t");
+
+	} else if (!strncmp(packet, "vCont;", 6U)) {
+		handle_v_cont(packet + 5U);
+
 	} else if (!strcmp(packet, "vStopped")) {
 		if (gdb_needs_detach_notify) {
 			gdb_putpacketz("W00");
@@ -764,21 +893,41 @@ void gdb_poll_target(void)
 	SET_RUN_STATE(0);
 
 	/* Translate reason to GDB signal */
+	char reply[sizeof(gdb_last_stop_reply)];
 	switch (reason) {
 	case TARGET_HALT_ERROR:
-		gdb_putpacket_f("X%02X", GDB_SIGLOST);
+		snprintf(reply, sizeof(reply), "X%02X", GDB_SIGLOST);
 		morse("TARGET LOST.", true);
 		break;
 	case TARGET_HALT_REQUEST:
-		gdb_putpacket_f("T%02X", GDB_SIGINT);
+		/* In non-stop mode halt requests only come from vCont;t, which GDB expects reported with signal 0 */
+		snprintf(reply, sizeof(reply), "T%02X", gdb_non_stop ? GDB_SIGNONE : GDB_SIGINT);
 		break;
 	case TARGET_HALT_WATCHPOINT:
-		gdb_putpacket_f("T%02Xwatch:%08X;", GDB_SIGTRAP, watch);
+		snprintf(reply, sizeof(reply), "T%02Xwatch:%08" PRIX32 ";", GDB_SIGTRAP, watch);
 		break;
 	case TARGET_HALT_FAULT:
-		gdb_putpacket_f("T%02X", GDB_SIGSEGV);
+		snprintf(reply, sizeof(reply), "T%02X", GDB_SIGSEGV);
 		break;
 	default:
-		gdb_putpacket_f("T%02X", GDB_SIGTRAP);
+		snprintf(reply, sizeof(reply), "T%02X", GDB_SIGTRAP);
+	}
+	gdb_send_stop_reply(reply);
+}
+
+/*
+ * Report the target stopping. In all-stop mode this is the reply to the packet that resumed the target,
+ * in non-stop mode it's sent as an asynchronous %Stop notification that GDB will follow up with vStopped.
+ */
+static void gdb_send_stop_reply(const char *const reply)
+{
+	strncpy(gdb_last_stop_reply, reply, sizeof(gdb_last_stop_reply) - 1U);
+	if (!gdb_non_stop) {
+		gdb_putpacketz(reply);
+		return;
 	}
+	/* Stop replies for a thread have to say which thread it was */
+	char notification[sizeof(gdb_last_stop_reply) + 16U];
+	snprintf(notification, sizeof(notification), "Stop:%s%s", reply, reply[0] == 'T' ? "thread:1;" : "");
+	gdb_put_notificationz(notification);
 }
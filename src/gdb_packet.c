@@ -114,10 +114,8 @@ packet_state_e consume_remote_packet(char *const packet, const size_t size)
 #endif
 }
 
-size_t gdb_getpacket(char *const packet, const size_t size)
+static size_t gdb_packet_capture(char *const packet, const size_t size, packet_state_e state)
 {
-	packet_state_e state = PACKET_IDLE; /* State of the packet capture */
-
 	size_t offset = 0;
 	uint8_t checksum = 0;
 	uint8_t rx_checksum = 0;
@@ -214,15 +212,7 @@ size_t gdb_getpacket(char *const packet, const size_t size)
 				packet[offset] = '\0';
 
 				/* Log packet for debugging */
-				DEBUG_GDB("%s: ", __func__);
-				for (size_t j = 0; j < offset; j++) {
-					const char value = packet[j];
-					if (value >= ' ' && value < '\x7f')
-						DEBUG_GDB("%c", value);
-					else
-						DEBUG_GDB("\\x%02X", (uint8_t)value);
-				}
-				DEBUG_GDB("\n");
+				DEBUG_TRACE_DATA(GDB_PACKET_RX, NULL, packet, offset, 0U);
 
 				/* Return packet captured size */
 				return offset;
@@ -244,12 +234,19 @@ size_t gdb_getpacket(char *const packet, const size_t size)
 	}
 }
 
+size_t gdb_getpacket(char *const packet, const size_t size)
+{
+	return gdb_packet_capture(packet, size, PACKET_IDLE);
+}
+
+/* As gdb_getpacket(), but for when the caller has already consumed the packet start character */
+size_t gdb_getpacket_started(char *const packet, const size_t size)
+{
+	return gdb_packet_capture(packet, size, PACKET_GDB_CAPTURE);
+}
+
 static void gdb_next_char(const char value, uint8_t *const csum)
 {
-	if (value >= ' ' && value < '\x7f')
-		DEBUG_GDB("%c", value);
-	else
-		DEBUG_GDB("\\x%02X", (uint8_t)value);
 	if (value == GDB_PACKET_START || value == GDB_PACKET_END || value == GDB_PACKET_ESCAPE ||
 		value == GDB_PACKET_RUNLENGTH_START) {
 		gdb_if_putchar(GDB_PACKET_ESCAPE, 0);
@@ -267,7 +264,7 @@ void gdb_putpacket2(const char *const packet1, const size_t size1, const char *c
 	size_t tries = 0;
 
 	do {
-		DEBUG_GDB("%s: ", __func__);
+		DEBUG_TRACE_DATA2(GDB_PACKET_TX, packet1, size1, packet2, size2);
 		uint8_t csum = 0;
 		gdb_if_putchar(GDB_PACKET_START, 0);
 
@@ -280,7 +277,6 @@ void gdb_putpacket2(const char *const packet1, const size_t size1, const char *c
 		snprintf(xmit_csum, sizeof(xmit_csum), "%02X", csum);
 		gdb_if_putchar(xmit_csum[0], 0);
 		gdb_if_putchar(xmit_csum[1], 1);
-		DEBUG_GDB("\n");
 	} while (!noackmode && gdb_if_getchar_to(2000) != GDB_PACKET_ACK && tries++ < 3U);
 }
 
@@ -290,7 +286,7 @@ void gdb_putpacket(const char *const packet, const size_t size)
 	size_t tries = 0;
 
 	do {
-		DEBUG_GDB("%s: ", __func__);
+		DEBUG_TRACE_DATA(GDB_PACKET_TX, NULL, packet, size, 0U);
 		uint8_t csum = 0;
 		gdb_if_putchar(GDB_PACKET_START, 0);
 		for (size_t i = 0; i < size; ++i)
@@ -299,7 +295,6 @@ void gdb_putpacket(const char *const packet, const size_t size)
 		snprintf(xmit_csum, sizeof(xmit_csum), "%02X", csum);
 		gdb_if_putchar(xmit_csum[0], 0);
 		gdb_if_putchar(xmit_csum[1], 1);
-		DEBUG_GDB("\n");
 	} while (!noackmode && gdb_if_getchar_to(2000) != GDB_PACKET_ACK && tries++ < 3U);
 }
 
@@ -307,7 +302,7 @@ void gdb_put_notification(const char *const packet, const size_t size)
 {
 	char xmit_csum[3];
 
-	DEBUG_GDB("%s: ", __func__);
+	DEBUG_TRACE_DATA(GDB_NOTIFICATION_TX, NULL, packet, size, 0U);
 	uint8_t csum = 0;
 	gdb_if_putchar(GDB_PACKET_NOTIFICATION_START, 0);
 	for (size_t i = 0; i < size; ++i)
@@ -316,7 +311,6 @@ void gdb_put_notification(const char *const packet, const size_t size)
 	snprintf(xmit_csum, sizeof(xmit_csum), "%02X", csum);
 	gdb_if_putchar(xmit_csum[0], 0);
 	gdb_if_putchar(xmit_csum[1], 1);
-	DEBUG_GDB("\n");
 }
 
 void gdb_putpacket_f(const char *const fmt, ...)
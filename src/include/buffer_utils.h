@@ -68,4 +68,19 @@ static inline uint32_t read_be4(const uint8_t *const buffer, const size_t offset
 		((uint32_t)buffer[offset + 2U] << 8U) | buffer[offset + 3U];
 }
 
+/* Copy a run of bits between LSB-first packed bit buffers, starting at arbitrary bit offsets in each */
+static inline void copy_bits(
+	uint8_t *const dest, const size_t dest_offset, const uint8_t *const src, const size_t src_offset, const size_t bits)
+{
+	for (size_t bit = 0; bit < bits; ++bit) {
+		const size_t src_bit = src_offset + bit;
+		const size_t dest_bit = dest_offset + bit;
+		const uint8_t dest_mask = 1U << (dest_bit & 7U);
+		if (src[src_bit >> 3U] & (1U << (src_bit & 7U)))
+			dest[dest_bit >> 3U] |= dest_mask;
+		else
+			dest[dest_bit >> 3U] &= ~dest_mask;
+	}
+}
+
 #endif /*INCLUDE_BUFFER_UTILS_H*/
@@ -26,6 +26,7 @@
 #define GDB_PACKET_BUFFER_SIZE 1024U
 
 extern bool gdb_target_running;
+extern bool gdb_non_stop;
 extern target_s *cur_target;
 
 void gdb_poll_target(void);
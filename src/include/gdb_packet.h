@@ -36,6 +36,7 @@
 
 void gdb_set_noackmode(bool enable);
 size_t gdb_getpacket(char *packet, size_t size);
+size_t gdb_getpacket_started(char *packet, size_t size);
 void gdb_putpacket(const char *packet, size_t size);
 void gdb_putpacket2(const char *packet1, size_t size1, const char *packet2, size_t size2);
 #define gdb_putpacketz(packet) gdb_putpacket((packet), strlen(packet))
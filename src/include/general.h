@@ -91,6 +91,11 @@
 #define DEBUG_PROBE(...)  PRINT_NOOP(__VA_ARGS__)
 #define DEBUG_WIRE(...)   PRINT_NOOP(__VA_ARGS__)
 
+#define DEBUG_TRACE(...)       PRINT_NOOP(__VA_ARGS__)
+#define DEBUG_TRACE_FN(...)    PRINT_NOOP(__VA_ARGS__)
+#define DEBUG_TRACE_DATA(...)  PRINT_NOOP(__VA_ARGS__)
+#define DEBUG_TRACE_DATA2(...) PRINT_NOOP(__VA_ARGS__)
+
 void debug_serial_send_stdout(const uint8_t *data, size_t len);
 #else
 #include "debug.h"
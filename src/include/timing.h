@@ -31,10 +31,28 @@
 #define MORSECNT  ((SYSTICKHZ / 10U) - 1U)
 
 struct platform_timeout {
+#if PC_HOSTED == 1
+	uint64_t time; /* Deadline on the monotonic clock, in microseconds */
+#else
 	uint32_t time;
+#endif
 };
 
 extern uint32_t target_clk_divider;
 uint32_t platform_time_ms(void);
 
+#if PC_HOSTED == 1
+uint64_t platform_time_us(void);
+void platform_delay_us(uint32_t us);
+void platform_timeout_set_us(struct platform_timeout *timeout, uint32_t us);
+uint64_t platform_timeout_remaining_us(const struct platform_timeout *timeout);
+/*
+ * Ask the poll loop to wake no later than the given deadline.
+ * Requests are collected until the next platform_pace_poll(), which sleeps until the earliest.
+ * This is only for work done from the idle poll loop. Waits inside a target operation, such as
+ * Flash busy polls, have the link round trip of each status read to pace them instead.
+ */
+void platform_poll_schedule(const struct platform_timeout *deadline);
+#endif
+
 #endif /* INCLUDE_TIMING_H */
@@ -0,0 +1 @@
+#define FIRMWARE_VERSION "da1d0bc"
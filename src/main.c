@@ -54,6 +54,12 @@ static void bmp_poll_loop(void)
 		char c = gdb_if_getchar_to(0);
 		if (c == '\x03' || c == '\x04')
 			target_halt_request(cur_target);
+		else if (c == GDB_PACKET_START && gdb_non_stop) {
+			/* In non-stop mode GDB can keep making requests while the target runs, so service them here */
+			const size_t size = gdb_getpacket_started(pbuf, GDB_PACKET_BUFFER_SIZE);
+			gdb_main(pbuf, GDB_PACKET_BUFFER_SIZE, size);
+			continue;
+		}
 		platform_pace_poll();
 #ifdef ENABLE_RTT
 		if (rtt_enabled)
@@ -88,12 +88,14 @@ typedef struct bmda_probe {
 	uint8_t interface_num;
 	uint8_t in_ep;
 	uint8_t out_ep;
+	uint8_t swo_ep;
 #endif
 } bmda_probe_s;
 
 typedef struct timeval timeval_s;
 
 extern bmda_probe_s bmda_probe_info;
+probe_type_e bmda_probe_type(void);
 void bmp_ident(bmda_probe_s *info);
 int find_debuggers(bmda_cli_options_s *cl_opts, bmda_probe_s *info);
 void libusb_exit_function(bmda_probe_s *info);
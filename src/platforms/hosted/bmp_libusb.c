@@ -406,16 +406,19 @@ static void check_cmsis_interface_type(libusb_device *const device, bmda_probe_s
 			if (strstr(interface_string, "CMSIS") == NULL)
 				continue;
 
-			/* Check if it's a CMSIS-DAP v2 interface */
-			if (descriptor->bInterfaceClass == 0xffU && descriptor->bNumEndpoints == 2U) {
+			/* Check if it's a CMSIS-DAP v2 interface (with an optional third endpoint for SWO trace) */
+			if (descriptor->bInterfaceClass == 0xffU &&
+				(descriptor->bNumEndpoints == 2U || descriptor->bNumEndpoints == 3U)) {
 				info->interface_num = descriptor->bInterfaceNumber;
-				/* Extract the endpoints required */
+				/* Extract the endpoints required, the first IN endpoint is for responses, the second for SWO */
 				for (uint8_t index = 0; index < descriptor->bNumEndpoints; ++index) {
 					const uint8_t ep = descriptor->endpoint[index].bEndpointAddress;
-					if (ep & 0x80U)
+					if (!(ep & 0x80U))
+						info->out_ep = ep;
+					else if (!info->in_ep)
 						info->in_ep = ep;
 					else
-						info->out_ep = ep;
+						info->swo_ep = ep;
 				}
 			}
 		}
@@ -578,12 +581,7 @@ int bmda_usb_transfer(
 	if (tx_len) {
 		uint8_t *tx_data = (uint8_t *)tx_buffer;
 		/* Display the request */
-		DEBUG_WIRE(" request:");
-		for (size_t i = 0; i < tx_len && i < 32U; ++i)
-			DEBUG_WIRE(" %02x", tx_data[i]);
-		if (tx_len > 32U)
-			DEBUG_WIRE(" ...");
-		DEBUG_WIRE("\n");
+		DEBUG_TRACE_DATA(USB_REQUEST, NULL, tx_data, tx_len, 0U);
 
 		/* Perform the transfer */
 		const int result = libusb_bulk_transfer(
@@ -614,12 +612,7 @@ int bmda_usb_transfer(
 		}
 
 		/* Display the response */
-		DEBUG_WIRE("response:");
-		for (size_t i = 0; i < (size_t)rx_bytes && i < 32U; ++i)
-			DEBUG_WIRE(" %02x", rx_data[i]);
-		if (rx_bytes > 32)
-			DEBUG_WIRE(" ...");
-		DEBUG_WIRE("\n");
+		DEBUG_TRACE_DATA(USB_RESPONSE, NULL, rx_data, (size_t)rx_bytes, 0U);
 		return rx_bytes;
 	}
 	return LIBUSB_SUCCESS;
@@ -36,6 +36,8 @@
 
 #include "cli.h"
 #include "bmp_hosted.h"
+#include "flm.h"
+#include "buffer_utils.h"
 
 #ifndef O_BINARY
 #define O_BINARY 0
@@ -131,7 +133,8 @@ static void cl_help(char **argv)
 	DEBUG_INFO("\n"
 			   "Usage: %s [-h | -l | [-v BITMASK] [-O] [-d PATH | -P NUMBER | -s SERIAL | -c TYPE]\n"
 			   "\t[-n NUMBER] [-j | -A] [-C] [-t | -T] [-e] [-p] [-R[h]] [-H] [-M STRING ...]\n"
-			   "\t[-f | -m] [-E | -w | -V | -r] [-a ADDR] [-S number] [file]]\n"
+			   "\t[-f | -m] [-L FILE | -Y FILE | -Z FILE] [-E | -w | -V | -r | -X FILE] [-a ADDR]\n"
+			   "\t[-S number] [file]]\n"
 			   "\n"
 			   "The default is to start a debug server at localhost:2000\n\n"
 			   "Single-shot and verbosity options [-h | -l | -v BITMASK]:\n"
@@ -178,19 +181,44 @@ static void cl_help(char **argv)
 			   "\t-f, --freq       Set an operating frequency for SWD\n"
 			   "\t-m, --mult-drop  Use the given target ID for selection in SWD multi-drop\n"
 			   "\n"
-			   "Flash operation selection options [-E | -w | -V | -r]:\n"
+			   "Flash operation selection options [-E | -w | -V | -r | -X FILE | -k]:\n"
 			   "\t-E, --erase      Erase the target device Flash\n"
 			   "\t-w, --write      Write the specified binary file to the target device\n"
 			   "\t                   Flash (the default)\n"
 			   "\t-V, --verify     Verify the target device Flash against the specified\n"
 			   "\t                   binary file\n"
 			   "\t-r, --read       Read the target device Flash\n"
+			   "\t-X, --manifest   Write and verify every image listed in the given manifest in\n"
+			   "\t                   a single session. Each line of the manifest is of the form\n"
+			   "\t                   'TARGET ADDRESS FILE [noverify]', with '#' starting a comment\n"
+			   "\t                   and relative FILEs taken from the manifest's directory\n"
+			   "\t-k, --memtest    Destructively test the target's RAM, or the range given by\n"
+			   "\t                   -a and -S, running the test on the target itself\n"
 			   "\n"
-			   "Flash operation modifiers options: [-a ADDR] [-S number] [FILE]\n"
+			   "Transaction log options [-L FILE | -Y FILE | -Z FILE]:\n"
+			   "\t-L, --record     Record every transaction performed with the probe, with\n"
+			   "\t                   timing information, to the given file\n"
+			   "\t-Y, --replay     Use the given transaction log as the probe, replaying the\n"
+			   "\t                   recorded session instead of talking to hardware\n"
+			   "\t-Z, --analyse    Report transaction counts and latencies for the given\n"
+			   "\t                   transaction log, then exit\n"
+			   "\n"
+			   "Trace options [-o DESTINATION] [-K FREQUENCY]:\n"
+			   "\t-o, --swo-output Write SWO trace captured with 'monitor traceswo' to the given\n"
+			   "\t                   file, or to a TCP socket given as tcp:HOST:PORT, instead of\n"
+			   "\t                   stdout\n"
+			   "\t-K, --trace-clock Frequency in Hz of the target's trace (TPIU) clock. When\n"
+			   "\t                   given, the target's ITM and TPIU are set up for SWO output\n"
+			   "\t                   when trace is started, otherwise its firmware must do this\n"
+			   "\n"
+			   "Flash operation modifiers options: [-a ADDR] [-S number] [-G FLM] [FILE]\n"
 			   "\t-a, --addr       Start address for the given Flash operation (defaults to\n"
 			   "\t                   the start of Flash)\n"
 			   "\t-S, --byte-count Number of bytes to work on in the Flash operation (default\n"
 			   "\t                   is till the operation fails or is complete)\n"
+			   "\t-G, --flm        CMSIS-Pack Flash algorithm (.FLM) to program the target's\n"
+			   "\t                   Flash with instead of the built-in driver, used for every\n"
+			   "\t                   target programmed when given with -X\n"
 			   "\t<file>           Binary file to use in Flash operations\n",
 		argv[0]);
 	exit(0);
@@ -223,8 +251,16 @@ static const getopt_option_s long_options[] = {
 	{"write", no_argument, NULL, 'W'},
 	{"verify", no_argument, NULL, 'V'},
 	{"read", no_argument, NULL, 'r'},
+	{"manifest", required_argument, NULL, 'X'},
+	{"memtest", no_argument, NULL, 'k'},
 	{"addr", required_argument, NULL, 'a'},
 	{"byte-count", required_argument, NULL, 'S'},
+	{"flm", required_argument, NULL, 'G'},
+	{"record", required_argument, NULL, 'L'},
+	{"replay", required_argument, NULL, 'Y'},
+	{"analyse", required_argument, NULL, 'Z'},
+	{"swo-output", required_argument, NULL, 'o'},
+	{"trace-clock", required_argument, NULL, 'K'},
 	{NULL, 0, NULL, 0},
 };
 
@@ -237,7 +273,8 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 	opt->opt_scanmode = BMP_SCAN_SWD;
 	opt->opt_mode = BMP_MODE_DEBUG;
 	while (true) {
-		const int option = getopt_long(argc, argv, "eEFhHv:Od:f:s:I:c:Cln:m:M:wVtTa:S:jApP:rR::", long_options, NULL);
+		const int option =
+			getopt_long(argc, argv, "eEFhHv:Od:f:s:I:c:Cln:m:M:wVtTa:S:jApP:rR::L:Y:Z:o:K:X:G:k", long_options, NULL);
 		if (option == -1)
 			break;
 
@@ -342,6 +379,19 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 		case 'r':
 			opt->opt_mode = BMP_MODE_FLASH_READ;
 			break;
+		case 'G':
+			if (optarg)
+				opt->opt_flm_file = optarg;
+			break;
+		case 'X':
+			if (optarg) {
+				opt->opt_mode = BMP_MODE_FLASH_MANIFEST;
+				opt->opt_manifest_file = optarg;
+			}
+			break;
+		case 'k':
+			opt->opt_mode = BMP_MODE_MEMTEST;
+			break;
 		case 'R':
 			if ((optarg) && (tolower(optarg[0]) == 'h'))
 				opt->opt_mode = BMP_MODE_RESET_HW;
@@ -371,6 +421,28 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 			if (optarg)
 				opt->opt_position = strtol(optarg, NULL, 0);
 			break;
+		case 'L':
+			if (optarg)
+				opt->opt_record_log = optarg;
+			break;
+		case 'Y':
+			if (optarg)
+				opt->opt_replay_log = optarg;
+			break;
+		case 'o':
+			if (optarg)
+				opt->opt_swo_output = optarg;
+			break;
+		case 'K':
+			if (optarg)
+				opt->opt_trace_clock = strtoul(optarg, NULL, 0);
+			break;
+		case 'Z':
+			if (optarg) {
+				opt->opt_analyse_log = optarg;
+				bmda_debug_flags |= BMD_DEBUG_INFO;
+			}
+			break;
 		case 'S':
 			if (optarg) {
 				char *endptr;
@@ -400,7 +472,7 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 	/* Checks */
 	if (opt->opt_flash_file &&
 		(opt->opt_mode == BMP_MODE_TEST || opt->opt_mode == BMP_MODE_SWJ_TEST || opt->opt_mode == BMP_MODE_RESET ||
-			opt->opt_mode == BMP_MODE_RESET_HW)) {
+			opt->opt_mode == BMP_MODE_RESET_HW || opt->opt_mode == BMP_MODE_MEMTEST)) {
 		DEBUG_WARN("Ignoring filename in reset/test mode\n");
 		opt->opt_flash_file = NULL;
 	}
@@ -433,6 +505,393 @@ bool scan_for_targets(const bmda_cli_options_s *const opt)
 	return false;
 }
 
+/*
+ * Manifest driven programming: each line of a manifest names a target, an address and a binary image.
+ * The images are grouped per target and sorted by address, the erases they need are merged into as few
+ * block-aligned ranges as possible and carried out before anything is written (so images sharing an
+ * erase block don't wipe each other out), then every image is written and each verified once.
+ * Images at addresses outside the target's Flash are loaded straight into memory, with any long runs
+ * of a repeated word (zero-initialised sections and the like) filled in on the target.
+ */
+#define MANIFEST_MAX_IMAGES 64U
+#define MANIFEST_LINE_MAX   1024U
+#define MANIFEST_WORKSIZE   0x1000U
+#define MANIFEST_FILL_MIN   0x1000U
+
+typedef struct manifest_image {
+	char *file;
+	size_t target_idx;
+	uint32_t addr;
+	bool verify;
+	bool mapped;
+	mmap_data_s map;
+} manifest_image_s;
+
+typedef struct manifest_range {
+	uint32_t start;
+	uint32_t end;
+} manifest_range_s;
+
+static char *manifest_next_field(char **const cursor)
+{
+	char *field = *cursor;
+	while (*field && isspace((unsigned char)*field))
+		++field;
+	if (!*field)
+		return NULL;
+	char *end = field;
+	while (*end && !isspace((unsigned char)*end))
+		++end;
+	if (*end)
+		*end++ = '\0';
+	*cursor = end;
+	return field;
+}
+
+/* Image paths are taken relative to the directory the manifest is in, unless they are absolute */
+static char *manifest_image_path(const char *const manifest_path, const char *const file)
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+	const bool absolute = file[0] == '/' || file[0] == '\\' || (file[0] && file[1] == ':');
+	const char *separator = strrchr(manifest_path, '\\');
+	const char *const slash = strrchr(manifest_path, '/');
+	if (!separator || (slash && slash > separator))
+		separator = slash;
+#else
+	const bool absolute = file[0] == '/';
+	const char *const separator = strrchr(manifest_path, '/');
+#endif
+	if (absolute || !separator)
+		return strdup(file);
+	const size_t directory_length = (size_t)(separator - manifest_path) + 1U;
+	const size_t file_length = strlen(file);
+	char *const result = malloc(directory_length + file_length + 1U);
+	if (!result)
+		return NULL;
+	memcpy(result, manifest_path, directory_length);
+	memcpy(result + directory_length, file, file_length + 1U);
+	return result;
+}
+
+/*
+ * Parse one manifest line into an image description. Blank and comment-only lines return false,
+ * malformed lines are reported and returned with no file set.
+ */
+static bool manifest_parse_line(
+	const char *const path, const size_t line_number, char *line, manifest_image_s *const image)
+{
+	char *const comment = strchr(line, '#');
+	if (comment)
+		*comment = '\0';
+
+	const char *const target_field = manifest_next_field(&line);
+	if (!target_field)
+		return false;
+	const char *const addr_field = manifest_next_field(&line);
+	const char *const file_field = manifest_next_field(&line);
+	if (!addr_field || !file_field) {
+		DEBUG_ERROR("%s:%zu: expected 'TARGET ADDRESS FILE [noverify]'\n", path, line_number);
+		image->file = NULL;
+		return true;
+	}
+
+	char *end = NULL;
+	image->target_idx = strtoul(target_field, &end, 0);
+	if (*end || !image->target_idx) {
+		DEBUG_ERROR("%s:%zu: invalid target number '%s'\n", path, line_number, target_field);
+		image->file = NULL;
+		return true;
+	}
+	image->addr = strtoul(addr_field, &end, 0);
+	if (*end) {
+		DEBUG_ERROR("%s:%zu: invalid address '%s'\n", path, line_number, addr_field);
+		image->file = NULL;
+		return true;
+	}
+	image->verify = true;
+	for (const char *option = manifest_next_field(&line); option; option = manifest_next_field(&line)) {
+		if (strcmp(option, "noverify") == 0)
+			image->verify = false;
+		else {
+			DEBUG_ERROR("%s:%zu: unknown option '%s'\n", path, line_number, option);
+			image->file = NULL;
+			return true;
+		}
+	}
+	image->file = manifest_image_path(path, file_field);
+	if (!image->file)
+		DEBUG_ERROR("malloc: failed in %s\n", __func__);
+	return true;
+}
+
+static void manifest_free(manifest_image_s *const images, const size_t count)
+{
+	for (size_t idx = 0; idx < count; ++idx) {
+		if (images[idx].mapped)
+			bmp_munmap(&images[idx].map);
+		free(images[idx].file);
+	}
+}
+
+/* Read the manifest, returning the number of images or SIZE_MAX on error */
+static size_t manifest_load(const char *const path, manifest_image_s *const images)
+{
+	FILE *const manifest = fopen(path, "r");
+	if (!manifest) {
+		DEBUG_ERROR("Can not open manifest %s: %s\n", path, strerror(errno));
+		return SIZE_MAX;
+	}
+
+	size_t count = 0;
+	size_t line_number = 0;
+	bool result = true;
+	char line[MANIFEST_LINE_MAX];
+	while (result && fgets(line, sizeof(line), manifest)) {
+		++line_number;
+		manifest_image_s image = {0};
+		if (!manifest_parse_line(path, line_number, line, &image))
+			continue;
+		if (count == MANIFEST_MAX_IMAGES) {
+			DEBUG_ERROR("%s:%zu: too many images, at most %u are supported\n", path, line_number, MANIFEST_MAX_IMAGES);
+			free(image.file);
+			result = false;
+		} else if (!image.file)
+			result = false;
+		else
+			images[count++] = image;
+	}
+	fclose(manifest);
+
+	for (size_t idx = 0; result && idx < count; ++idx) {
+		manifest_image_s *const image = &images[idx];
+		image->mapped = bmp_mmap(image->file, &image->map);
+		if (!image->mapped || !image->map.size) {
+			DEBUG_ERROR("Can not map image %s, or it is empty\n", image->file);
+			result = false;
+		}
+	}
+	if (!result) {
+		manifest_free(images, count);
+		return SIZE_MAX;
+	}
+	return count;
+}
+
+static int manifest_image_compare(const void *const lhs, const void *const rhs)
+{
+	const manifest_image_s *const a = (const manifest_image_s *)lhs;
+	const manifest_image_s *const b = (const manifest_image_s *)rhs;
+	if (a->target_idx != b->target_idx)
+		return a->target_idx < b->target_idx ? -1 : 1;
+	if (a->addr != b->addr)
+		return a->addr < b->addr ? -1 : 1;
+	return 0;
+}
+
+/* Compute the erase block aligned range covering an image */
+static bool manifest_erase_range(target_s *const target, const manifest_image_s *const image, manifest_range_s *range)
+{
+	const uint32_t end = image->addr + image->map.size;
+	const target_flash_s *const first = target_flash_for_addr(target, image->addr);
+	const target_flash_s *const last = target_flash_for_addr(target, end - 1U);
+	if (!first || !last) {
+		DEBUG_ERROR("Image %s at 0x%08" PRIx32 " does not fit in the target's Flash\n", image->file, image->addr);
+		return false;
+	}
+	range->start = image->addr - ((image->addr - first->start) % first->blocksize);
+	range->end = end + ((last->blocksize - ((end - last->start) % last->blocksize)) % last->blocksize);
+	return true;
+}
+
+static bool manifest_verify(target_s *const target, const manifest_image_s *const image)
+{
+	uint8_t data[MANIFEST_WORKSIZE];
+	const uint8_t *const expected = (const uint8_t *)image->map.data;
+	for (size_t offset = 0; offset < image->map.size; offset += MANIFEST_WORKSIZE) {
+		const size_t worksize = MIN(image->map.size - offset, MANIFEST_WORKSIZE);
+		if (target_mem_read(target, data, image->addr + offset, worksize)) {
+			DEBUG_ERROR("Read failed at flash address 0x%08" PRIx32 "\n", (uint32_t)(image->addr + offset));
+			return false;
+		}
+		if (memcmp(data, expected + offset, worksize) != 0) {
+			DEBUG_ERROR("Verify of %s failed in region 0x%08" PRIx32 "\n", image->file, (uint32_t)(image->addr + offset));
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Load an image into RAM, leaving long runs of the same word to be filled on the target */
+static bool manifest_write_ram(target_s *const target, const manifest_image_s *const image)
+{
+	const uint8_t *const data = (const uint8_t *)image->map.data;
+	const size_t size = image->map.size;
+	size_t written = 0;
+	for (size_t offset = 0; offset + 4U <= size;) {
+		size_t run = 4U;
+		while (offset + run + 4U <= size && memcmp(data + offset + run, data + offset, 4U) == 0)
+			run += 4U;
+		if (run >= MANIFEST_FILL_MIN) {
+			if ((offset > written && target_mem_write(target, image->addr + written, data + written, offset - written)) ||
+				target_mem_fill(target, image->addr + offset, read_le4(data, offset), ALIGN_32BIT, run)) {
+				DEBUG_ERROR("Loading %s failed at 0x%08" PRIx32 "\n", image->file, (uint32_t)(image->addr + written));
+				return false;
+			}
+			written = offset + run;
+		}
+		offset += run;
+	}
+	if (written < size && target_mem_write(target, image->addr + written, data + written, size - written)) {
+		DEBUG_ERROR("Loading %s failed at 0x%08" PRIx32 "\n", image->file, (uint32_t)(image->addr + written));
+		return false;
+	}
+	return true;
+}
+
+/* Erase, write and verify a run of address-sorted images all destined for the same target */
+static bool manifest_program(target_s *const target, const manifest_image_s *const images, const size_t count)
+{
+	manifest_range_s ranges[MANIFEST_MAX_IMAGES];
+	size_t range_count = 0;
+	size_t total_size = 0;
+	for (size_t idx = 0; idx < count; ++idx) {
+		const manifest_image_s *const image = &images[idx];
+		if (idx && images[idx - 1U].addr + images[idx - 1U].map.size > image->addr) {
+			DEBUG_ERROR("Images %s and %s overlap\n", images[idx - 1U].file, image->file);
+			return false;
+		}
+		/* Images outside Flash are loaded into memory directly and have nothing to erase */
+		if (!target_flash_for_addr(target, image->addr))
+			continue;
+		manifest_range_s range;
+		if (!manifest_erase_range(target, image, &range))
+			return false;
+		/* Images are sorted, so a range can only ever merge with the one before it */
+		if (range_count && range.start <= ranges[range_count - 1U].end)
+			ranges[range_count - 1U].end = MAX(ranges[range_count - 1U].end, range.end);
+		else
+			ranges[range_count++] = range;
+		total_size += image->map.size;
+	}
+
+	const uint32_t start_time = platform_time_ms();
+	for (size_t idx = 0; idx < range_count; ++idx) {
+		DEBUG_INFO("Erasing 0x%08" PRIx32 "-0x%08" PRIx32 "\n", ranges[idx].start, ranges[idx].end);
+		if (!target_flash_erase(target, ranges[idx].start, ranges[idx].end - ranges[idx].start)) {
+			DEBUG_ERROR("Flash erase failed!\n");
+			return false;
+		}
+	}
+	for (size_t idx = 0; idx < count; ++idx) {
+		if (!target_flash_for_addr(target, images[idx].addr))
+			continue;
+		DEBUG_INFO("Flashing %s, %zu bytes at 0x%08" PRIx32 "\n", images[idx].file, images[idx].map.size,
+			images[idx].addr);
+		if (!target_flash_write(target, images[idx].addr, images[idx].map.data, images[idx].map.size)) {
+			DEBUG_ERROR("Flashing failed!\n");
+			return false;
+		}
+	}
+	if (!target_flash_complete(target)) {
+		DEBUG_ERROR("Flashing failed!\n");
+		return false;
+	}
+	const uint32_t end_time = platform_time_ms();
+	DEBUG_WARN("Flash Write succeeded for %zu bytes in %zu images with %zu erase ranges, %8.3fkiB/s\n", total_size,
+		count, range_count, (double)total_size / (end_time - start_time));
+
+	for (size_t idx = 0; idx < count; ++idx) {
+		if (target_flash_for_addr(target, images[idx].addr))
+			continue;
+		DEBUG_INFO("Loading %s, %zu bytes at 0x%08" PRIx32 "\n", images[idx].file, images[idx].map.size,
+			images[idx].addr);
+		if (!manifest_write_ram(target, &images[idx]))
+			return false;
+	}
+
+	for (size_t idx = 0; idx < count; ++idx) {
+		if (images[idx].verify && !manifest_verify(target, &images[idx]))
+			return false;
+	}
+	return true;
+}
+
+static bool cl_memtest_range(target_s *const target, const target_addr_t start, const size_t length)
+{
+	target_mem_fault_s faults[MEMTEST_MAX_FAULTS];
+	DEBUG_INFO("Testing %zu bytes of RAM at 0x%08" PRIx32 "\n", length, start);
+	const uint32_t start_time = platform_time_ms();
+	const size_t count = target_mem_test(target, start, length, faults, ARRAY_LENGTH(faults));
+	const uint32_t end_time = platform_time_ms();
+	if (count == SIZE_MAX) {
+		DEBUG_ERROR("RAM test could not be run, the range must be word aligned\n");
+		return false;
+	}
+	for (size_t idx = 0; idx < count; ++idx)
+		DEBUG_ERROR("Fault at 0x%08" PRIx32 ": wrote 0x%08" PRIx32 ", read 0x%08" PRIx32 "\n", faults[idx].addr,
+			faults[idx].expected, faults[idx].actual);
+	if (count)
+		return false;
+	DEBUG_WARN("RAM test passed for %zu bytes at 0x%08" PRIx32 " in %" PRIu32 "ms\n", length, start,
+		end_time - start_time);
+	return true;
+}
+
+/* Test the range given on the command line, or failing that every RAM region the target has */
+static bool cl_memtest(target_s *const target, const bmda_cli_options_s *const opt)
+{
+	if (opt->opt_flash_start != 0xffffffffU) {
+		if (opt->opt_flash_size == 0xffffffffU) {
+			DEBUG_ERROR("Give the number of bytes to test with -S\n");
+			return false;
+		}
+		return cl_memtest_range(target, opt->opt_flash_start, opt->opt_flash_size);
+	}
+	bool result = true;
+	for (const target_ram_s *ram = target->ram; ram; ram = ram->next)
+		result &= cl_memtest_range(target, ram->start, ram->length);
+	return result;
+}
+
+static int cl_execute_manifest(const bmda_cli_options_s *const opt, const size_t num_targets)
+{
+	manifest_image_s images[MANIFEST_MAX_IMAGES];
+	const size_t count = manifest_load(opt->opt_manifest_file, images);
+	if (count == SIZE_MAX)
+		return -1;
+	qsort(images, count, sizeof(*images), manifest_image_compare);
+
+	int res = 0;
+	for (size_t begin = 0; begin < count && !res;) {
+		size_t end = begin + 1U;
+		while (end < count && images[end].target_idx == images[begin].target_idx)
+			++end;
+
+		const size_t target_idx = images[begin].target_idx;
+		target_s *const target = target_idx <= num_targets ? target_attach_n(target_idx, &cl_controller) : NULL;
+		if (!target) {
+			DEBUG_ERROR("Can not attach to target %zu\n", target_idx);
+			res = -1;
+			break;
+		}
+		if (opt->opt_flm_file && !flm_load(target, opt->opt_flm_file)) {
+			target_detach(target);
+			res = -1;
+			break;
+		}
+		DEBUG_INFO("Programming %zu images into target %zu\n", end - begin, target_idx);
+		if (manifest_program(target, images + begin, end - begin))
+			target_reset(target);
+		else
+			res = -1;
+		target_detach(target);
+		begin = end;
+	}
+
+	manifest_free(images, count);
+	return res;
+}
+
 int cl_execute(bmda_cli_options_s *opt)
 {
 	if (opt->opt_mode == BMP_MODE_RESET_HW) {
@@ -459,6 +918,11 @@ int cl_execute(bmda_cli_options_s *opt)
 		DEBUG_ERROR("Given target number %" PRIu32 " not available max %zu\n", opt->opt_target_dev, num_targets);
 		return -1;
 	}
+	if (opt->opt_mode == BMP_MODE_FLASH_MANIFEST) {
+		const int res = cl_execute_manifest(opt, num_targets);
+		target_list_free();
+		return res;
+	}
 	target_s *target = target_attach_n(opt->opt_target_dev, &cl_controller);
 
 	int res = 0;
@@ -468,6 +932,10 @@ int cl_execute(bmda_cli_options_s *opt)
 		res = -1;
 		goto target_detach;
 	}
+	if (opt->opt_flm_file && !flm_load(target, opt->opt_flm_file)) {
+		res = -1;
+		goto target_detach;
+	}
 
 	/* List each defined RAM region */
 	size_t ram_regions = 0;
@@ -509,6 +977,10 @@ int cl_execute(bmda_cli_options_s *opt)
 		}
 	}
 
+	if (opt->opt_mode == BMP_MODE_MEMTEST) {
+		res = cl_memtest(target, opt) ? 0 : -1;
+		goto target_detach;
+	}
 	if (opt->opt_flash_start == 0xffffffffU)
 		opt->opt_flash_start = lowest_flash_start;
 	if (opt->opt_flash_size == 0xffffffffU && opt->opt_mode != BMP_MODE_FLASH_WRITE &&
@@ -36,6 +36,8 @@ typedef enum bmda_cli_mode {
 	BMP_MODE_FLASH_WRITE_VERIFY,
 	BMP_MODE_FLASH_READ,
 	BMP_MODE_FLASH_VERIFY,
+	BMP_MODE_FLASH_MANIFEST,
+	BMP_MODE_MEMTEST,
 	BMP_MODE_SWJ_TEST,
 	BMP_MODE_MONITOR,
 } bmda_cli_mode_e;
@@ -56,6 +58,8 @@ typedef struct bmda_cli_options {
 	bool fast_poll;
 	bool opt_no_hl;
 	char *opt_flash_file;
+	char *opt_manifest_file;
+	char *opt_flm_file;
 	char *opt_device;
 	char *opt_serial;
 	uint32_t opt_targetid;
@@ -63,6 +67,11 @@ typedef struct bmda_cli_options {
 	size_t opt_position;
 	char *opt_cable;
 	char *opt_monitor;
+	char *opt_record_log;
+	char *opt_replay_log;
+	char *opt_analyse_log;
+	char *opt_swo_output;
+	uint32_t opt_trace_clock;
 	uint32_t opt_target_dev;
 	uint32_t opt_flash_start;
 	uint32_t opt_max_swj_frequency;
@@ -66,6 +66,7 @@
 #include <hidapi.h>
 #include <wchar.h>
 #include <sys/stat.h>
+#include <pthread.h>
 
 #include "bmp_hosted.h"
 #include "dap.h"
@@ -105,6 +106,8 @@ static uint8_t in_ep;
 static uint8_t out_ep;
 static hid_device *handle = NULL;
 static uint8_t buffer[1024U];
+/* Serialises command exchanges, as the SWO poll thread shares the command pipe (and buffer) with the main thread */
+static pthread_mutex_t dap_command_lock = PTHREAD_MUTEX_INITIALIZER;
 static size_t report_size = 64U + 1U; // TODO: read actual report size
 bool dap_has_swd_sequence = false;
 
@@ -142,6 +145,12 @@ static inline size_t dap_max_transfer_data(size_t command_header_len)
 	return result;
 }
 
+/* The largest request or response the adaptor can handle in a single packet */
+size_t dap_packet_size(void)
+{
+	return report_size - 1U;
+}
+
 #ifdef __linux__
 static void dap_hid_print_permissions_for(const hid_device_info_s *const dev)
 {
@@ -376,6 +385,12 @@ uint32_t dap_dp_read_reg(adiv5_debug_port_s *const target_dp, const uint16_t add
 	return result;
 }
 
+/* The trace endpoint is read directly as it's a stream independent of the command exchanges */
+libusb_device_handle *dap_usb_handle(void)
+{
+	return type == CMSIS_TYPE_BULK ? usb_handle : NULL;
+}
+
 void dap_exit_function(void)
 {
 	if (type == CMSIS_TYPE_HID) {
@@ -451,26 +466,23 @@ ssize_t dbg_dap_cmd_bulk(const uint8_t *const request_data, const size_t request
 static ssize_t dap_run_cmd_raw(const uint8_t *const request_data, const size_t request_length,
 	uint8_t *const response_data, const size_t response_length)
 {
-	DEBUG_WIRE(" command: ");
-	for (size_t i = 0; i < request_length; ++i)
-		DEBUG_WIRE("%02x ", request_data[i]);
-	DEBUG_WIRE("\n");
+	DEBUG_TRACE_DATA(DAP_COMMAND, NULL, request_data, request_length, 0U);
 
 	uint8_t data[65];
 
+	/* Each request has to be paired with its own response, so nothing else may use the pipe in between */
+	pthread_mutex_lock(&dap_command_lock);
 	ssize_t response = -1;
 	if (type == CMSIS_TYPE_HID)
 		response = dbg_dap_cmd_hid(request_data, request_length, data, report_size);
 	else if (type == CMSIS_TYPE_BULK)
 		response = dbg_dap_cmd_bulk(request_data, request_length, data, report_size);
+	pthread_mutex_unlock(&dap_command_lock);
 	if (response < 0)
 		return response;
 	const size_t result = (size_t)response;
 
-	DEBUG_WIRE("response: ");
-	for (size_t i = 0; i < result; i++)
-		DEBUG_WIRE("%02x ", data[i]);
-	DEBUG_WIRE("\n");
+	DEBUG_TRACE_DATA(DAP_RESPONSE, NULL, data, result, 0U);
 
 	if (response_length)
 		memcpy(response_data, data + 1, MIN(response_length, result));
@@ -479,6 +491,23 @@ static ssize_t dap_run_cmd_raw(const uint8_t *const request_data, const size_t r
 
 bool dap_run_cmd(const void *const request_data, const size_t request_length, void *const response_data,
 	const size_t response_length)
+{
+	/* Any JTAG sequences still queued have to reach the adaptor before this command to keep them in order */
+	if (!dap_jtag_sequence_flush()) {
+		DEBUG_ERROR("Failed to flush queued JTAG sequences\n");
+		return false;
+	}
+	return dap_run_cmd_unordered(request_data, request_length, response_data, response_length);
+}
+
+/*
+ * As dap_run_cmd(), but without flushing the JTAG sequence queue first. This is for commands that
+ * are independent of the target state and get issued from threads other than the main one (SWO polling).
+ * The queue belongs to the main thread, so it must not be touched from those. The command exchange itself
+ * is serialised by dap_run_cmd_raw().
+ */
+bool dap_run_cmd_unordered(const void *const request_data, const size_t request_length, void *const response_data,
+	const size_t response_length)
 {
 	/* This subtracts one off the result to account for the command byte that gets stripped above */
 	const ssize_t result =
@@ -499,10 +528,11 @@ static void dap_mem_read(adiv5_access_port_s *ap, void *dest, uint32_t src, size
 	}
 	/* Otherwise proceed blockwise */
 	const size_t blocks_per_transfer = dap_max_transfer_data(DAP_CMD_BLOCK_READ_HDR_LEN) >> 2U;
+	/* If the adaptor can execute batches, the AP setup can go in the same packet as the first block read */
+	const bool batched = dap_caps & DAP_CAP_ATOMIC_CMDS;
+	const size_t blocks_per_batch = (dap_packet_size() - DAP_BATCH_BLOCK_READ_OVERHEAD) >> 2U;
 	uint8_t *const data = (uint8_t *)dest;
 	for (size_t offset = 0; offset < len;) {
-		/* Setup AP_TAR every loop as failing to do so results in it wrapping */
-		dap_ap_mem_access_setup(ap, src + offset, align);
 		/*
 		 * src can start out unaligned to a 1024 byte chunk size,
 		 * so we have to calculate how much is left of the chunk.
@@ -511,7 +541,19 @@ static void dap_mem_read(adiv5_access_port_s *ap, void *dest, uint32_t src, size
 		 */
 		const size_t chunk_remaining = MIN(1024 - ((src + offset) & 0x3ffU), len - offset);
 		const size_t blocks = chunk_remaining >> align;
-		for (size_t i = 0; i < blocks; i += blocks_per_transfer) {
+		size_t i = 0;
+		/* Setup AP_TAR every loop as failing to do so results in it wrapping */
+		if (batched) {
+			const size_t transfer_length = MIN(blocks, blocks_per_batch) << align;
+			if (!dap_read_block_setup(ap, data + offset, src + offset, transfer_length, align)) {
+				DEBUG_WIRE("mem_read failed: %u\n", ap->dp->fault);
+				return;
+			}
+			offset += transfer_length;
+			i = transfer_length >> align;
+		} else
+			dap_ap_mem_access_setup(ap, src + offset, align);
+		for (; i < blocks; i += blocks_per_transfer) {
 			/* blocks - i gives how many blocks are left to transfer in this 1024 byte chunk */
 			const size_t transfer_length = MIN(blocks - i, blocks_per_transfer) << align;
 			if (!dap_read_block(ap, data + offset, src + offset, transfer_length, align)) {
@@ -536,10 +578,12 @@ static void dap_mem_write(adiv5_access_port_s *ap, uint32_t dest, const void *sr
 	}
 	/* Otherwise proceed blockwise */
 	const size_t blocks_per_transfer = dap_max_transfer_data(DAP_CMD_BLOCK_WRITE_HDR_LEN) >> 2U;
+	/* If the adaptor can execute batches, the AP setup can go in the same packet as the first block write */
+	const bool batched = dap_caps & DAP_CAP_ATOMIC_CMDS;
+	const size_t blocks_per_batch = (dap_packet_size() - DAP_BATCH_BLOCK_WRITE_OVERHEAD) >> 2U;
+	bool completed = false;
 	const uint8_t *const data = (const uint8_t *)src;
 	for (size_t offset = 0; offset < len;) {
-		/* Setup AP_TAR every loop as failing to do so results in it wrapping */
-		dap_ap_mem_access_setup(ap, dest + offset, align);
 		/*
 		 * dest can start out unaligned to a 1024 byte chunk size,
 		 * so we have to calculate how much is left of the chunk.
@@ -548,7 +592,21 @@ static void dap_mem_write(adiv5_access_port_s *ap, uint32_t dest, const void *sr
 		 */
 		const size_t chunk_remaining = MIN(1024 - ((dest + offset) & 0x3ffU), len - offset);
 		const size_t blocks = chunk_remaining >> align;
-		for (size_t i = 0; i < blocks; i += blocks_per_transfer) {
+		size_t i = 0;
+		/* Setup AP_TAR every loop as failing to do so results in it wrapping */
+		if (batched) {
+			const size_t transfer_length = MIN(blocks, blocks_per_batch) << align;
+			/* If this batch finishes the write, have it complete the write too */
+			completed = offset + transfer_length == len;
+			if (!dap_write_block_setup(ap, dest + offset, data + offset, transfer_length, align, completed)) {
+				DEBUG_WIRE("mem_write failed: %u\n", ap->dp->fault);
+				return;
+			}
+			offset += transfer_length;
+			i = transfer_length >> align;
+		} else
+			dap_ap_mem_access_setup(ap, dest + offset, align);
+		for (; i < blocks; i += blocks_per_transfer) {
 			/* blocks - i gives how many blocks are left to transfer in this 1024 byte chunk */
 			const size_t transfer_length = MIN(blocks - i, blocks_per_transfer) << align;
 			if (!dap_write_block(ap, dest + offset, data + offset, transfer_length, align)) {
@@ -560,7 +618,52 @@ static void dap_mem_write(adiv5_access_port_s *ap, uint32_t dest, const void *sr
 	}
 	DEBUG_WIRE("dap_mem_write_sized transferred %zu blocks\n", len >> align);
 
-	/* Make sure this write is complete by doing a dummy read */
+	/* Make sure this write is complete by doing a dummy read, unless the final batch already did */
+	if (!completed)
+		adiv5_dp_read(ap->dp, ADIV5_DP_RDBUFF);
+}
+
+/*
+ * FIFO accesses leave the TAR where it is, so there's no 1KiB wrap to split on and the whole transfer
+ * can go out as back to back block transfers after a single AP setup.
+ */
+static void dap_mem_read_fifo(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align)
+{
+	const size_t count = len >> align;
+	if (!count)
+		return;
+	DEBUG_WIRE("dap_mem_read_fifo @ %" PRIx32 " len %zu, align %d\n", src, len, align);
+	dap_ap_fifo_access_setup(ap, src, align);
+	const size_t blocks_per_transfer = dap_max_transfer_data(DAP_CMD_BLOCK_READ_HDR_LEN) >> 2U;
+	uint8_t *const data = (uint8_t *)dest;
+	for (size_t offset = 0; offset < count;) {
+		const size_t blocks = MIN(count - offset, blocks_per_transfer);
+		if (!dap_read_fifo(ap, data + (offset << align), src, blocks << align, align)) {
+			DEBUG_WIRE("mem_read_fifo failed: %u\n", ap->dp->fault);
+			return;
+		}
+		offset += blocks;
+	}
+}
+
+static void dap_mem_write_fifo(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align)
+{
+	const size_t count = len >> align;
+	if (!count)
+		return;
+	DEBUG_WIRE("dap_mem_write_fifo @ %" PRIx32 " len %zu, align %d\n", dest, len, align);
+	dap_ap_fifo_access_setup(ap, dest, align);
+	const size_t blocks_per_transfer = dap_max_transfer_data(DAP_CMD_BLOCK_WRITE_HDR_LEN) >> 2U;
+	const uint8_t *const data = (const uint8_t *)src;
+	for (size_t offset = 0; offset < count;) {
+		const size_t blocks = MIN(count - offset, blocks_per_transfer);
+		if (!dap_write_fifo(ap, dest, data + (offset << align), blocks << align, align)) {
+			DEBUG_WIRE("mem_write_fifo failed: %u\n", ap->dp->fault);
+			return;
+		}
+		offset += blocks;
+	}
+	/* Make sure the last write is complete by doing a dummy read */
 	adiv5_dp_read(ap->dp, ADIV5_DP_RDBUFF);
 }
 
@@ -571,4 +674,6 @@ void dap_adiv5_dp_init(adiv5_debug_port_s *target_dp)
 	target_dp->ap_write = dap_ap_write;
 	target_dp->mem_read = dap_mem_read;
 	target_dp->mem_write = dap_mem_write;
+	target_dp->mem_read_fifo = dap_mem_read_fifo;
+	target_dp->mem_write_fifo = dap_mem_write_fifo;
 }
@@ -33,5 +33,9 @@ void dap_jtag_dp_init(adiv5_debug_port_s *dp);
 uint32_t dap_max_frequency(uint32_t clock);
 void dap_swd_configure(uint8_t cfg);
 void dap_nrst_set_val(bool assert);
+libusb_device_handle *dap_usb_handle(void);
+
+bool dap_swo_init(uint32_t baudrate);
+void dap_swo_deinit(void);
 
 #endif /* PLATFORMS_HOSTED_CMSIS_DAP_H */
@@ -260,41 +260,50 @@ void dap_write_reg(adiv5_debug_port_s *target_dp, const uint8_t reg, const uint3
 	} while (target_dp->fault == DAP_TRANSFER_WAIT);
 }
 
-bool dap_read_block(
-	adiv5_access_port_s *const target_ap, void *dest, uint32_t src, const size_t len, const align_e align)
+static void dap_unpack_block(void *dest, uint32_t src, const uint32_t *const data, const size_t len, const align_e align)
 {
-	const size_t blocks = len >> MIN(align, 2U);
-	uint32_t data[256];
-	if (!perform_dap_transfer_block_read(target_ap->dp, SWD_AP_DRW, blocks, data)) {
-		DEBUG_ERROR("dap_read_block failed\n");
-		return false;
-	}
-
 	if (align > ALIGN_16BIT)
 		memcpy(dest, data, len);
 	else {
-		for (size_t i = 0; i < blocks; ++i) {
+		for (size_t i = 0; i < len >> align; ++i) {
 			dest = adiv5_unpack_data(dest, src, data[i], align);
 			src += 1U << align;
 		}
 	}
-	return true;
 }
 
-bool dap_write_block(
-	adiv5_access_port_s *const target_ap, uint32_t dest, const void *src, const size_t len, const align_e align)
+static void dap_pack_block(uint32_t *const data, uint32_t dest, const void *src, const size_t len, const align_e align)
 {
-	const size_t blocks = len >> MAX(align, 2U);
-	uint32_t data[256];
-
 	if (align > ALIGN_16BIT)
 		memcpy(data, src, len);
 	else {
-		for (size_t i = 0; i < blocks; ++i) {
+		for (size_t i = 0; i < len >> align; ++i) {
 			src = adiv5_pack_data(dest, src, data + i, align);
 			dest += 1U << align;
 		}
 	}
+}
+
+bool dap_read_block(
+	adiv5_access_port_s *const target_ap, void *dest, uint32_t src, const size_t len, const align_e align)
+{
+	const size_t blocks = len >> MIN(align, 2U);
+	uint32_t data[256];
+	if (!perform_dap_transfer_block_read(target_ap->dp, SWD_AP_DRW, blocks, data)) {
+		DEBUG_ERROR("dap_read_block failed\n");
+		return false;
+	}
+	dap_unpack_block(dest, src, data, len, align);
+	return true;
+}
+
+bool dap_write_block(
+	adiv5_access_port_s *const target_ap, uint32_t dest, const void *src, const size_t len, const align_e align)
+{
+	/* Sub-word accesses take one block per item, so this must be MIN() to match dap_read_block() */
+	const size_t blocks = len >> MIN(align, 2U);
+	uint32_t data[256];
+	dap_pack_block(data, dest, src, len, align);
 
 	const bool result = perform_dap_transfer_block_write(target_ap->dp, SWD_AP_DRW, blocks, data);
 	if (!result)
@@ -302,6 +311,38 @@ bool dap_write_block(
 	return result;
 }
 
+/*
+ * Block transfers against an AP set up by dap_ap_fifo_access_setup(). Each block is one access of the
+ * given width, and as the address never moves, the data lane each uses is the same throughout.
+ */
+bool dap_read_fifo(
+	adiv5_access_port_s *const target_ap, void *dest, const uint32_t src, const size_t len, const align_e align)
+{
+	const size_t blocks = len >> MIN(align, 2U);
+	uint32_t data[256];
+	if (!perform_dap_transfer_block_read(target_ap->dp, SWD_AP_DRW, blocks, data)) {
+		DEBUG_ERROR("dap_read_fifo failed\n");
+		return false;
+	}
+	for (size_t i = 0; i < blocks; ++i)
+		dest = adiv5_unpack_data(dest, src, data[i], align);
+	return true;
+}
+
+bool dap_write_fifo(
+	adiv5_access_port_s *const target_ap, const uint32_t dest, const void *src, const size_t len, const align_e align)
+{
+	const size_t blocks = len >> MIN(align, 2U);
+	uint32_t data[256];
+	for (size_t i = 0; i < blocks; ++i)
+		src = adiv5_pack_data(dest, src, data + i, align);
+
+	const bool result = perform_dap_transfer_block_write(target_ap->dp, SWD_AP_DRW, blocks, data);
+	if (!result)
+		DEBUG_ERROR("dap_write_fifo failed\n");
+	return result;
+}
+
 void dap_reset_link(adiv5_debug_port_s *const target_dp)
 {
 	uint8_t sequence[18U];
@@ -332,9 +373,9 @@ void dap_reset_link(adiv5_debug_port_s *const target_dp)
 }
 
 static void mem_access_setup(const adiv5_access_port_s *const target_ap,
-	dap_transfer_request_s *const transfer_requests, const uint32_t addr, const align_e align)
+	dap_transfer_request_s *const transfer_requests, const uint32_t addr, const align_e align, const uint32_t addrinc)
 {
-	uint32_t csw = target_ap->csw | ADIV5_AP_CSW_ADDRINC_SINGLE;
+	uint32_t csw = target_ap->csw | addrinc;
 	switch (align) {
 	case ALIGN_8BIT:
 		csw |= ADIV5_AP_CSW_SIZE_BYTE;
@@ -358,11 +399,12 @@ static void mem_access_setup(const adiv5_access_port_s *const target_ap,
 	transfer_requests[2].data = addr;
 }
 
-void dap_ap_mem_access_setup(adiv5_access_port_s *const target_ap, const uint32_t addr, const align_e align)
+static void dap_ap_access_setup(
+	adiv5_access_port_s *const target_ap, const uint32_t addr, const align_e align, const uint32_t addrinc)
 {
 	/* Start by setting up the transfer and attempting it */
 	dap_transfer_request_s requests[3];
-	mem_access_setup(target_ap, requests, addr, align);
+	mem_access_setup(target_ap, requests, addr, align, addrinc);
 	adiv5_debug_port_s *const target_dp = target_ap->dp;
 	const bool result = perform_dap_transfer_recoverable(target_dp, requests, 3U, NULL, 0U);
 	/* If it didn't go well, say something and abort */
@@ -375,6 +417,17 @@ void dap_ap_mem_access_setup(adiv5_access_port_s *const target_ap, const uint32_
 	}
 }
 
+void dap_ap_mem_access_setup(adiv5_access_port_s *const target_ap, const uint32_t addr, const align_e align)
+{
+	dap_ap_access_setup(target_ap, addr, align, ADIV5_AP_CSW_ADDRINC_SINGLE);
+}
+
+/* Set up the AP for repeated accesses to a single address, such as a peripheral's data FIFO */
+void dap_ap_fifo_access_setup(adiv5_access_port_s *const target_ap, const uint32_t addr, const align_e align)
+{
+	dap_ap_access_setup(target_ap, addr, align, ADIV5_AP_CSW_ADDRINC_NONE);
+}
+
 uint32_t dap_ap_read(adiv5_access_port_s *const target_ap, const uint16_t addr)
 {
 	dap_transfer_request_s requests[2];
@@ -411,7 +464,7 @@ void dap_ap_write(adiv5_access_port_s *const target_ap, const uint16_t addr, con
 void dap_read_single(adiv5_access_port_s *const target_ap, void *const dest, const uint32_t src, const align_e align)
 {
 	dap_transfer_request_s requests[4];
-	mem_access_setup(target_ap, requests, src, align);
+	mem_access_setup(target_ap, requests, src, align, ADIV5_AP_CSW_ADDRINC_SINGLE);
 	requests[3].request = SWD_AP_DRW | DAP_TRANSFER_RnW;
 	uint32_t result;
 	adiv5_debug_port_s *target_dp = target_ap->dp;
@@ -428,7 +481,7 @@ void dap_write_single(
 	adiv5_access_port_s *const target_ap, const uint32_t dest, const void *const src, const align_e align)
 {
 	dap_transfer_request_s requests[4];
-	mem_access_setup(target_ap, requests, dest, align);
+	mem_access_setup(target_ap, requests, dest, align, ADIV5_AP_CSW_ADDRINC_SINGLE);
 	requests[3].request = SWD_AP_DRW;
 	/* Pack data into correct data lane */
 	adiv5_pack_data(dest, src, &requests[3].data, align);
@@ -436,3 +489,70 @@ void dap_write_single(
 	if (!perform_dap_transfer_recoverable(target_dp, requests, 4U, NULL, 0U))
 		DEBUG_ERROR("dap_write_single failed (fault = %u)\n", target_dp->fault);
 }
+
+/*
+ * Set up the AP for a memory access and perform a block read from it, all in one DAP_ExecuteCommands request.
+ * The caller must size the read to fit, see DAP_BATCH_BLOCK_READ_OVERHEAD.
+ */
+bool dap_read_block_setup(
+	adiv5_access_port_s *const target_ap, void *const dest, const uint32_t src, const size_t len, const align_e align)
+{
+	const uint16_t blocks = len >> MIN(align, 2U);
+	dap_transfer_request_s requests[3];
+	mem_access_setup(target_ap, requests, src, align, ADIV5_AP_CSW_ADDRINC_SINGLE);
+	adiv5_debug_port_s *const target_dp = target_ap->dp;
+
+	dap_batch_s batch;
+	dap_batch_init(&batch);
+	const size_t setup_response = dap_batch_transfer(&batch, target_dp, requests, 3U, 0U);
+	const size_t block_response = dap_batch_transfer_block_read(&batch, target_dp, SWD_AP_DRW, blocks);
+	if (!setup_response || !block_response)
+		return false;
+
+	uint8_t response[DAP_BATCH_MAX_LENGTH];
+	uint32_t data[256];
+	if (!perform_dap_batch(&batch, response) ||
+		!dap_batch_transfer_result(target_dp, response + setup_response, 3U, NULL, 0U) ||
+		!dap_batch_transfer_block_result(target_dp, response + block_response, blocks, data)) {
+		DEBUG_ERROR("dap_read_block_setup failed\n");
+		return false;
+	}
+	dap_unpack_block(dest, src, data, len, align);
+	return true;
+}
+
+/*
+ * Set up the AP for a memory access and perform a block write to it, all in one DAP_ExecuteCommands request.
+ * If complete is true, an RDBUFF read is added to make sure the write has finished before the response.
+ * The caller must size the write to fit, see DAP_BATCH_BLOCK_WRITE_OVERHEAD.
+ */
+bool dap_write_block_setup(adiv5_access_port_s *const target_ap, const uint32_t dest, const void *const src,
+	const size_t len, const align_e align, const bool complete)
+{
+	const uint16_t blocks = len >> MIN(align, 2U);
+	dap_transfer_request_s requests[3];
+	mem_access_setup(target_ap, requests, dest, align, ADIV5_AP_CSW_ADDRINC_SINGLE);
+	adiv5_debug_port_s *const target_dp = target_ap->dp;
+	uint32_t data[256];
+	dap_pack_block(data, dest, src, len, align);
+
+	dap_batch_s batch;
+	dap_batch_init(&batch);
+	const size_t setup_response = dap_batch_transfer(&batch, target_dp, requests, 3U, 0U);
+	const size_t block_response = dap_batch_transfer_block_write(&batch, target_dp, SWD_AP_DRW, blocks, data);
+	const dap_transfer_request_s rdbuff = {.request = SWD_DP_R_RDBUFF | DAP_TRANSFER_RnW};
+	const size_t rdbuff_response = complete ? dap_batch_transfer(&batch, target_dp, &rdbuff, 1U, 1U) : 0U;
+	if (!setup_response || !block_response || (complete && !rdbuff_response))
+		return false;
+
+	uint8_t response[DAP_BATCH_MAX_LENGTH];
+	uint32_t value = 0U;
+	if (!perform_dap_batch(&batch, response) ||
+		!dap_batch_transfer_result(target_dp, response + setup_response, 3U, NULL, 0U) ||
+		!dap_batch_transfer_block_result(target_dp, response + block_response, blocks, NULL) ||
+		(complete && !dap_batch_transfer_result(target_dp, response + rdbuff_response, 1U, &value, 1U))) {
+		DEBUG_ERROR("dap_write_block_setup failed\n");
+		return false;
+	}
+	return true;
+}
@@ -66,6 +66,13 @@ typedef enum dap_led_type {
 
 #define DAP_QUIRK_NO_JTAG_MUTLI_TAP (1U << 0U)
 
+/*
+ * Bytes of a DAP_ExecuteCommands packet that aren't block data when doing the AP memory access setup and
+ * a block read or write in one go - the write case includes the trailing RDBUFF read that completes it
+ */
+#define DAP_BATCH_BLOCK_READ_OVERHEAD  9U
+#define DAP_BATCH_BLOCK_WRITE_OVERHEAD 29U
+
 extern uint8_t dap_caps;
 extern dap_cap_e dap_mode;
 extern uint8_t dap_quirks;
@@ -85,11 +92,20 @@ void dap_reset_link(adiv5_debug_port_s *target_dp);
 bool dap_read_block(adiv5_access_port_s *target_ap, void *dest, uint32_t src, size_t len, align_e align);
 bool dap_write_block(adiv5_access_port_s *target_ap, uint32_t dest, const void *src, size_t len, align_e align);
 void dap_ap_mem_access_setup(adiv5_access_port_s *target_ap, uint32_t addr, align_e align);
+void dap_ap_fifo_access_setup(adiv5_access_port_s *target_ap, uint32_t addr, align_e align);
+bool dap_read_fifo(adiv5_access_port_s *target_ap, void *dest, uint32_t src, size_t len, align_e align);
+bool dap_write_fifo(adiv5_access_port_s *target_ap, uint32_t dest, const void *src, size_t len, align_e align);
 uint32_t dap_ap_read(adiv5_access_port_s *target_ap, uint16_t addr);
 void dap_ap_write(adiv5_access_port_s *target_ap, uint16_t addr, uint32_t value);
 void dap_read_single(adiv5_access_port_s *target_ap, void *dest, uint32_t src, align_e align);
 void dap_write_single(adiv5_access_port_s *target_ap, uint32_t dest, const void *src, align_e align);
 bool dap_run_cmd(const void *request_data, size_t request_length, void *response_data, size_t response_length);
+bool dap_run_cmd_unordered(
+	const void *request_data, size_t request_length, void *response_data, size_t response_length);
+size_t dap_packet_size(void);
+bool dap_read_block_setup(adiv5_access_port_s *target_ap, void *dest, uint32_t src, size_t len, align_e align);
+bool dap_write_block_setup(
+	adiv5_access_port_s *target_ap, uint32_t dest, const void *src, size_t len, align_e align, bool complete);
 bool dap_jtag_configure(void);
 
 void dap_dp_abort(adiv5_debug_port_s *target_dp, uint32_t abort);
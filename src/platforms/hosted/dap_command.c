@@ -236,104 +236,148 @@ bool perform_dap_swj_sequence(size_t clock_cycles, const uint8_t *data)
 	return response == DAP_RESPONSE_OK;
 }
 
-bool perform_dap_jtag_sequence(
-	const uint8_t *const data_in, uint8_t *const data_out, const bool final_tms, const size_t clock_cycles)
+/*
+ * Pending DAP_JTAG_Sequence command. Sequences that don't capture TDO are held here and packed
+ * together, so a run of TMS moves and TDI shifts costs one command rather than one each.
+ * The queue is sent when a sequence needs its TDO back, when the next sequence won't fit in the
+ * packet, or by dap_run_cmd() before any other command so ordering on the wire is preserved.
+ */
+#define DAP_JTAG_SEQUENCE_MAX_COUNT    255U
+#define DAP_JTAG_SEQUENCE_MAX_CAPTURES 64U
+
+typedef struct dap_jtag_capture {
+	uint8_t *data_out;
+	size_t offset;
+	uint8_t cycles;
+} dap_jtag_capture_s;
+
+typedef struct dap_jtag_sequence_queue {
+	uint8_t request[DAP_BATCH_MAX_LENGTH];
+	size_t request_length;
+	size_t response_length;
+	dap_jtag_capture_s captures[DAP_JTAG_SEQUENCE_MAX_CAPTURES];
+	size_t capture_count;
+} dap_jtag_sequence_queue_s;
+
+static dap_jtag_sequence_queue_s dap_jtag_queue;
+
+bool dap_jtag_sequence_flush(void)
 {
-	/* Check for any over-long sequences */
-	if (clock_cycles > 64)
-		return false;
-
-	DEBUG_PROBE("-> dap_jtag_sequence (%zu cycles)\n", clock_cycles);
-	/* Check for 0-length sequences */
-	if (!clock_cycles)
+	const size_t request_length = dap_jtag_queue.request_length;
+	if (!request_length)
 		return true;
-
-	const uint8_t capture_tdo = data_out ? DAP_JTAG_TDO_CAPTURE : 0U;
-	/*
-	 * If final_tms is true, we need to generate 2 sequences because of how TMS data is sent,
-	 * except if we need to generate just a single clock cycle.
-	 */
-	const uint8_t sequences = final_tms && clock_cycles > 1 ? 2U : 1U;
-	/* Adjust clock_cycles accordingly */
-	const uint8_t cycles = clock_cycles - (sequences - 1U);
-
-	/* 3 + 2 bytes for the request preambles + 9 for the sending data */
-	uint8_t request[14] = {
-		DAP_JTAG_SEQUENCE,
-		sequences,
-		/* The number of clock cycles to run is encoded with 64 remapped to 0 */
-		(cycles & 63U) | (final_tms && sequences == 1U ? DAP_JTAG_TMS_SET : DAP_JTAG_TMS_CLEAR) | capture_tdo,
-	};
-	/* Copy in a suitable amount of data from the source buffer */
-	const size_t sequence_length = (cycles + 7U) >> 3U;
-	memcpy(request + 3U, data_in, sequence_length);
-	size_t offset = 3U + sequence_length;
-	/* Figure out where the final bit is */
-	const uint8_t final_byte = cycles >> 3U;
-	const uint8_t final_bit = cycles & 7U;
-	/* If we need to build a second sequence, set up for it */
-	if (sequences == 2U) {
-		request[offset++] = 1U | DAP_JTAG_TMS_SET | DAP_JTAG_TDO_CAPTURE | capture_tdo;
-		/* Copy the final bit out to the request LSb */
-		request[offset++] = data_in[final_byte] >> final_bit;
-	}
-
-	/*
-	 * If we should capture TDO, then calculate the response length as the sequence length + 1 if final_tms needs.
-	 * Otherwise, if not capturing TDO, it is 0
-	 */
-	const size_t response_length = capture_tdo ? sequence_length + (sequences == 2U ? 1U : 0U) : 0U;
-	uint8_t response[6U] = {DAP_RESPONSE_OK};
-	/* Run the request having set up the request buffer */
-	if (!dap_run_cmd(request, offset, response, 1U + response_length)) {
-		DEBUG_PROBE("-> sequence failed with %u\n", response[0U]);
+	/* Empty the queue before running the command so dap_run_cmd() doesn't try to flush it again */
+	dap_jtag_queue.request_length = 0U;
+	const size_t response_length = dap_jtag_queue.response_length;
+	const size_t capture_count = dap_jtag_queue.capture_count;
+	dap_jtag_queue.response_length = 0U;
+	dap_jtag_queue.capture_count = 0U;
+
+	DEBUG_PROBE("-> dap_jtag_sequence (%u sequences)\n", dap_jtag_queue.request[1]);
+	uint8_t response[DAP_BATCH_MAX_LENGTH] = {DAP_RESPONSE_OK};
+	if (!dap_run_cmd(dap_jtag_queue.request, request_length, response, 1U + response_length) ||
+		response[0] != DAP_RESPONSE_OK) {
+		DEBUG_ERROR("dap_jtag_sequence failed with %u\n", response[0]);
 		return false;
 	}
 
-	if (response_length) {
-		/* Copy the captured data out */
-		memcpy(data_out, response + 1U, sequence_length);
-		/* And the final bit from the second response LSb */
-		if (sequences == 2U)
-			data_out[final_byte] = (response[1 + sequence_length] & 1U) << final_bit;
+	/* Scatter the captured TDO data back out to where each sequence wanted it */
+	size_t offset = 1U;
+	for (size_t idx = 0; idx < capture_count; ++idx) {
+		const dap_jtag_capture_s *const capture = &dap_jtag_queue.captures[idx];
+		copy_bits(capture->data_out, capture->offset, response + offset, 0U, capture->cycles);
+		offset += (capture->cycles + 7U) >> 3U;
 	}
-	/* And check that it succeeded */
-	return response[0] == DAP_RESPONSE_OK;
+	return true;
 }
 
-bool perform_dap_jtag_tms_sequence(const uint64_t tms_states, const size_t clock_cycles)
+/*
+ * Append one sequence of up to 64 cycles with a fixed TMS value to the queue. TDI is taken from
+ * data_in starting at bit data_in_offset, or held high if data_in is NULL. If data_out is not NULL,
+ * TDO is captured into it starting at bit data_out_offset once the queue is flushed.
+ */
+static bool dap_jtag_queue_sequence(const uint8_t clock_cycles, const bool tms, const uint8_t *const data_in,
+	const size_t data_in_offset, uint8_t *const data_out, const size_t data_out_offset)
 {
-	/* Check for any over-long sequences */
-	if (clock_cycles > 64)
+	const size_t bytes = (clock_cycles + 7U) >> 3U;
+	const size_t max_length = MIN(dap_packet_size(), DAP_BATCH_MAX_LENGTH);
+	/* Make room if this sequence won't fit in the request or its TDO won't fit in the response */
+	if (dap_jtag_queue.request_length &&
+		(dap_jtag_queue.request[1] == DAP_JTAG_SEQUENCE_MAX_COUNT ||
+			dap_jtag_queue.request_length + 1U + bytes > max_length ||
+			(data_out &&
+				(dap_jtag_queue.capture_count == DAP_JTAG_SEQUENCE_MAX_CAPTURES ||
+					2U + dap_jtag_queue.response_length + bytes > max_length))) &&
+		!dap_jtag_sequence_flush())
 		return false;
 
+	uint8_t *const request = dap_jtag_queue.request;
+	if (!dap_jtag_queue.request_length) {
+		request[0] = DAP_JTAG_SEQUENCE;
+		request[1] = 0U;
+		dap_jtag_queue.request_length = 2U;
+	}
+	size_t offset = dap_jtag_queue.request_length;
+	/* The number of clock cycles to run is encoded with 64 remapped to 0 */
+	request[offset++] = (clock_cycles & 63U) | (tms ? DAP_JTAG_TMS_SET : DAP_JTAG_TMS_CLEAR) |
+		(data_out ? DAP_JTAG_TDO_CAPTURE : 0U);
+	if (data_in) {
+		memset(request + offset, 0, bytes);
+		copy_bits(request + offset, 0U, data_in, data_in_offset, clock_cycles);
+	} else
+		memset(request + offset, 0xff, bytes);
+	dap_jtag_queue.request_length = offset + bytes;
+	++request[1];
+
+	if (data_out) {
+		dap_jtag_capture_s *const capture = &dap_jtag_queue.captures[dap_jtag_queue.capture_count++];
+		capture->data_out = data_out;
+		capture->offset = data_out_offset;
+		capture->cycles = clock_cycles;
+		dap_jtag_queue.response_length += bytes;
+	}
+	return true;
+}
+
+bool perform_dap_jtag_sequence(
+	const uint8_t *const data_in, uint8_t *const data_out, const bool final_tms, const size_t clock_cycles)
+{
 	DEBUG_PROBE("-> dap_jtag_sequence (%zu cycles)\n", clock_cycles);
 	/* Check for 0-length sequences */
 	if (!clock_cycles)
 		return true;
 
-	/* 2 + (2 * 64) bytes for the request */
-	uint8_t request[130] = {
-		DAP_JTAG_SEQUENCE,
-		clock_cycles,
-	};
-	size_t offset = 2;
-	/* Build all the TMS cycles required */
-	for (size_t cycle = 0; cycle < clock_cycles; ++cycle) {
-		const bool tms = (tms_states >> cycle) & 1U;
-		request[offset + 0] = 1U | (tms ? DAP_JTAG_TMS_SET : DAP_JTAG_TMS_CLEAR);
-		request[offset + 1] = 1U;
-		offset += 2U;
+	/* If final_tms is true, the last cycle needs its own sequence because TMS is fixed per sequence */
+	const size_t body_cycles = final_tms ? clock_cycles - 1U : clock_cycles;
+	for (size_t cycle = 0; cycle < body_cycles; cycle += 64U) {
+		const uint8_t cycles = MIN(body_cycles - cycle, 64U);
+		if (!dap_jtag_queue_sequence(cycles, false, data_in, cycle, data_out, cycle))
+			return false;
 	}
+	if (final_tms && !dap_jtag_queue_sequence(1U, true, data_in, body_cycles, data_out, body_cycles))
+		return false;
+	/* Only sequences that capture TDO have to go out now, as the caller expects the data on return */
+	return data_out ? dap_jtag_sequence_flush() : true;
+}
 
-	uint8_t response = DAP_RESPONSE_OK;
-	/* Run the request having set up the request buffer */
-	if (!dap_run_cmd(request, offset, &response, 1U)) {
-		DEBUG_PROBE("-> sequence failed with %u\n", response);
+bool perform_dap_jtag_tms_sequence(const uint64_t tms_states, const size_t clock_cycles)
+{
+	/* Check for any over-long sequences */
+	if (clock_cycles > 64)
 		return false;
+
+	DEBUG_PROBE("-> dap_jtag_tms_sequence (%zu cycles)\n", clock_cycles);
+	/* Queue one sequence per run of cycles that share the same TMS state */
+	for (size_t cycle = 0; cycle < clock_cycles;) {
+		const bool tms = (tms_states >> cycle) & 1U;
+		size_t run = 1U;
+		while (cycle + run < clock_cycles && ((tms_states >> (cycle + run)) & 1U) == tms)
+			++run;
+		if (!dap_jtag_queue_sequence(run, tms, NULL, 0U, NULL, 0U))
+			return false;
+		cycle += run;
 	}
-	/* And check that it succeeded */
-	return response == DAP_RESPONSE_OK;
+	return true;
 }
 
 static size_t dap_encode_swd_sequence(
@@ -406,3 +450,147 @@ bool perform_dap_swd_sequences(dap_swd_sequence_s *const sequences, const uint8_
 	/* Finally, check that it all succeeded */
 	return response[0] == DAP_RESPONSE_OK;
 }
+
+void dap_batch_init(dap_batch_s *const batch)
+{
+	batch->request[0] = DAP_EXECUTE_COMMANDS;
+	batch->request[1] = 0U;
+	batch->request_length = 2U;
+	/* The response starts with the executed command count, after the command byte that gets stripped */
+	batch->response_length = 1U;
+	batch->max_length = MIN(dap_packet_size(), DAP_BATCH_MAX_LENGTH);
+}
+
+/*
+ * Reserve room in the batch for a command, returning where its response will be found in the batch response,
+ * or 0 if it doesn't fit in a packet. The stripped leading command byte is accounted for in the response check.
+ */
+static size_t dap_batch_reserve(dap_batch_s *const batch, const size_t request_length, const size_t response_length)
+{
+	if (batch->request[1] == UINT8_MAX || batch->request_length + request_length > batch->max_length ||
+		batch->response_length + response_length + 1U > batch->max_length)
+		return 0U;
+	const size_t response_offset = batch->response_length;
+	batch->request_length += request_length;
+	batch->response_length += response_length;
+	++batch->request[1];
+	return response_offset;
+}
+
+/* https://arm-software.github.io/CMSIS_5/DAP/html/group__DAP__ExecuteCommands.html */
+size_t dap_batch_transfer(dap_batch_s *const batch, const adiv5_debug_port_s *const target_dp,
+	const dap_transfer_request_s *const transfer_requests, const size_t requests, const size_t responses)
+{
+	/* We artificially limit the number of requests in a transfer to 12 as with perform_dap_transfer() */
+	if (!requests || requests > 12U)
+		return 0U;
+	/* 63 is 3 + (12 * 5) where 5 is the max length of each transfer request */
+	uint8_t request[63] = {
+		DAP_TRANSFER,
+		target_dp->dev_index,
+		requests,
+	};
+	size_t request_length = 3U;
+	for (size_t i = 0; i < requests; ++i)
+		request_length += dap_encode_transfer(&transfer_requests[i], request, request_length);
+
+	const size_t request_offset = batch->request_length;
+	const size_t response_offset = dap_batch_reserve(batch, request_length, 3U + (responses * 4U));
+	if (response_offset)
+		memcpy(batch->request + request_offset, request, request_length);
+	return response_offset;
+}
+
+size_t dap_batch_transfer_block_read(
+	dap_batch_s *const batch, const adiv5_debug_port_s *const target_dp, const uint8_t reg, const uint16_t block_count)
+{
+	if (!block_count || block_count > 256U)
+		return 0U;
+	const size_t request_offset = batch->request_length;
+	const size_t response_offset =
+		dap_batch_reserve(batch, sizeof(dap_transfer_block_request_read_s), 4U + (block_count * 4U));
+	if (!response_offset)
+		return 0U;
+	uint8_t *const request = batch->request + request_offset;
+	request[0] = DAP_TRANSFER_BLOCK;
+	request[1] = target_dp->dev_index;
+	write_le2(request, 2U, block_count);
+	request[4] = reg | DAP_TRANSFER_RnW;
+	return response_offset;
+}
+
+size_t dap_batch_transfer_block_write(dap_batch_s *const batch, const adiv5_debug_port_s *const target_dp,
+	const uint8_t reg, const uint16_t block_count, const uint32_t *const blocks)
+{
+	if (!block_count || block_count > 256U)
+		return 0U;
+	const size_t request_offset = batch->request_length;
+	const size_t response_offset = dap_batch_reserve(batch, DAP_CMD_BLOCK_WRITE_HDR_LEN + (block_count * 4U), 4U);
+	if (!response_offset)
+		return 0U;
+	uint8_t *const request = batch->request + request_offset;
+	request[0] = DAP_TRANSFER_BLOCK;
+	request[1] = target_dp->dev_index;
+	write_le2(request, 2U, block_count);
+	request[4] = reg & ~DAP_TRANSFER_RnW;
+	for (size_t i = 0; i < block_count; ++i)
+		write_le4(request, DAP_CMD_BLOCK_WRITE_HDR_LEN + (i * 4U), blocks[i]);
+	return response_offset;
+}
+
+bool perform_dap_batch(const dap_batch_s *const batch, uint8_t *const response)
+{
+	DEBUG_PROBE("-> dap_execute_commands (%u commands)\n", batch->request[1]);
+	/*
+	 * A failed transfer comes back short, making the whole response short. That's not treated as an error here,
+	 * it's left to the per-command result checks which must be done in order, stopping at the first failure.
+	 */
+	memset(response, 0, batch->response_length);
+	dap_run_cmd(batch->request, batch->request_length, response, batch->response_length);
+	return response[0] == batch->request[1];
+}
+
+bool dap_batch_transfer_result(adiv5_debug_port_s *const target_dp, const uint8_t *const response,
+	const size_t requests, uint32_t *const response_data, const size_t responses)
+{
+	if (response[0] != DAP_TRANSFER) {
+		DEBUG_PROBE("-> batched transfer missing from response\n");
+		return false;
+	}
+	const uint8_t processed = response[1];
+	const uint8_t status = response[2];
+	if (processed == requests && status == DAP_TRANSFER_OK) {
+		for (size_t i = 0; i < responses; ++i)
+			response_data[i] = read_le4(response, 3U + (i * 4U));
+		return true;
+	}
+
+	DEBUG_PROBE("-> transfer failed with %u after processing %u requests\n", status, processed);
+	dap_dispatch_status(target_dp, status);
+	return false;
+}
+
+bool dap_batch_transfer_block_result(adiv5_debug_port_s *const target_dp, const uint8_t *const response,
+	const uint16_t block_count, uint32_t *const blocks)
+{
+	if (response[0] != DAP_TRANSFER_BLOCK) {
+		DEBUG_PROBE("-> batched transfer block missing from response\n");
+		return false;
+	}
+	const uint16_t blocks_processed = read_le2(response, 1U);
+	const uint8_t status = response[3];
+	if (blocks_processed == block_count && status == DAP_TRANSFER_OK) {
+		if (blocks) {
+			for (size_t i = 0; i < block_count; ++i)
+				blocks[i] = read_le4(response, 4U + (i * 4U));
+		}
+		return true;
+	}
+	if (status != DAP_TRANSFER_OK)
+		target_dp->fault = status;
+	else
+		target_dp->fault = 0;
+
+	DEBUG_PROBE("-> transfer failed with %u after processing %u blocks\n", status, blocks_processed);
+	return false;
+}
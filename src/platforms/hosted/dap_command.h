@@ -53,7 +53,14 @@ typedef enum dap_command {
 	DAP_SWD_CONFIGURE = 0x13U,
 	DAP_JTAG_SEQUENCE = 0x14U,
 	DAP_JTAG_CONFIGURE = 0x15U,
+	DAP_SWO_TRANSPORT = 0x17U,
+	DAP_SWO_MODE = 0x18U,
+	DAP_SWO_BAUDRATE = 0x19U,
+	DAP_SWO_CONTROL = 0x1aU,
+	DAP_SWO_STATUS = 0x1bU,
+	DAP_SWO_DATA = 0x1cU,
 	DAP_SWD_SEQUENCE = 0x1dU,
+	DAP_EXECUTE_COMMANDS = 0x7fU,
 } dap_command_e;
 
 typedef enum dap_response_status {
@@ -79,11 +86,34 @@ typedef enum dap_info_status {
 	DAP_INFO_NO_STRING = 1U,
 } dap_info_status_e;
 
+typedef enum dap_swo_transport {
+	DAP_SWO_TRANSPORT_NONE = 0U,
+	/* Trace data is retrieved with DAP_SWO_Data commands */
+	DAP_SWO_TRANSPORT_DATA_COMMAND = 1U,
+	/* Trace data is streamed over the dedicated (CMSIS-DAP v2) trace endpoint */
+	DAP_SWO_TRANSPORT_ENDPOINT = 2U,
+} dap_swo_transport_e;
+
+typedef enum dap_swo_mode {
+	DAP_SWO_MODE_OFF = 0U,
+	DAP_SWO_MODE_UART = 1U,
+	DAP_SWO_MODE_MANCHESTER = 2U,
+} dap_swo_mode_e;
+
+#define DAP_SWO_CONTROL_STOP  0U
+#define DAP_SWO_CONTROL_START 1U
+
+#define DAP_SWO_STATUS_ACTIVE  (1U << 0U)
+#define DAP_SWO_STATUS_ERROR   (1U << 6U)
+#define DAP_SWO_STATUS_OVERRUN (1U << 7U)
+
 #define DAP_SWD_OUT_SEQUENCE 0U
 #define DAP_SWD_IN_SEQUENCE  1U
 
 #define DAP_INFO_MAX_LENGTH 256U
 
+#define DAP_BATCH_MAX_LENGTH 1024U
+
 #define DAP_SWJ_SWCLK_TCK (1U << 0U)
 #define DAP_SWJ_SWDIO_TMS (1U << 1U)
 #define DAP_SWJ_TDI       (1U << 2U)
@@ -138,6 +168,22 @@ typedef struct dap_swd_sequence {
 	uint8_t data[8];
 } dap_swd_sequence_s;
 
+/*
+ * A DAP_ExecuteCommands batch being built up. Responses are laid out in the order commands were added,
+ * each starting with the command byte, after a leading count of the commands executed.
+ *
+ * Batches only ever cover a single ADIv5 operation (AP setup plus the block access it's for), as the
+ * adiv5 layer expects each access to have completed, and any fault to be known, by the time it returns.
+ * Sequences spanning several target_mem_write32() calls, such as Flash controller unlock and command
+ * writes, would need writes to be posted and their faults reported later, so those are not batched.
+ */
+typedef struct dap_batch {
+	uint8_t request[DAP_BATCH_MAX_LENGTH];
+	size_t request_length;
+	size_t response_length;
+	size_t max_length;
+} dap_batch_s;
+
 typedef struct dap_swj_pins_request {
 	uint8_t request;
 	uint8_t pin_values;
@@ -158,7 +204,21 @@ bool perform_dap_swj_sequence(size_t clock_cycles, const uint8_t *data);
 
 bool perform_dap_jtag_sequence(const uint8_t *data_in, uint8_t *data_out, bool final_tms, size_t clock_cycles);
 bool perform_dap_jtag_tms_sequence(uint64_t tms_states, size_t clock_cycles);
+bool dap_jtag_sequence_flush(void);
 
 bool perform_dap_swd_sequences(dap_swd_sequence_s *sequences, uint8_t sequence_count);
 
+void dap_batch_init(dap_batch_s *batch);
+size_t dap_batch_transfer(dap_batch_s *batch, const adiv5_debug_port_s *target_dp,
+	const dap_transfer_request_s *transfer_requests, size_t requests, size_t responses);
+size_t dap_batch_transfer_block_read(
+	dap_batch_s *batch, const adiv5_debug_port_s *target_dp, uint8_t reg, uint16_t block_count);
+size_t dap_batch_transfer_block_write(dap_batch_s *batch, const adiv5_debug_port_s *target_dp, uint8_t reg,
+	uint16_t block_count, const uint32_t *blocks);
+bool perform_dap_batch(const dap_batch_s *batch, uint8_t *response);
+bool dap_batch_transfer_result(adiv5_debug_port_s *target_dp, const uint8_t *response, size_t requests,
+	uint32_t *response_data, size_t responses);
+bool dap_batch_transfer_block_result(
+	adiv5_debug_port_s *target_dp, const uint8_t *response, uint16_t block_count, uint32_t *blocks);
+
 #endif /*PLATFORMS_HOSTED_DAP_COMMAND_H*/
@@ -0,0 +1,219 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements SWO trace capture for CMSIS-DAP adaptors. The trace is taken either from the
+ * dedicated CMSIS-DAP v2 trace endpoint, using the shared asynchronous endpoint capture, or by polling
+ * with DAP_SWO_Data commands on adaptors without one.
+ */
+
+#include "general.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include "bmp_hosted.h"
+#include "dap.h"
+#include "dap_command.h"
+#include "cmsis_dap.h"
+#include "traceswo.h"
+#include "buffer_utils.h"
+#include "gdb_packet.h"
+#include "timing.h"
+
+#define DAP_SWO_TRANSFER_SIZE 8192U
+/*
+ * A DAP_SWO_Data response has a 3 byte header, which with the command byte leaves 60 bytes of a 64 byte
+ * packet for trace
+ */
+#define DAP_SWO_DATA_MAX 60U
+
+static pthread_t dap_swo_thread;
+static atomic_bool dap_swo_running = false;
+static bool dap_swo_started = false;
+static dap_swo_transport_e dap_swo_transport_mode = DAP_SWO_TRANSPORT_NONE;
+
+static bool dap_swo_simple_request(const uint8_t command, const uint8_t value)
+{
+	const uint8_t request[2] = {command, value};
+	uint8_t result = DAP_RESPONSE_OK;
+	/* Execute it and check if it failed */
+	if (!dap_run_cmd(request, 2U, &result, 1U))
+		return false;
+	return result == DAP_RESPONSE_OK;
+}
+
+static bool dap_swo_configure_transport(const dap_swo_transport_e transport)
+{
+	if (!dap_swo_simple_request(DAP_SWO_TRANSPORT, transport)) {
+		DEBUG_PROBE("%s failed\n", __func__);
+		return false;
+	}
+	return true;
+}
+
+static bool dap_swo_configure_mode(const dap_swo_mode_e mode)
+{
+	if (!dap_swo_simple_request(DAP_SWO_MODE, mode)) {
+		DEBUG_PROBE("%s failed\n", __func__);
+		return false;
+	}
+	return true;
+}
+
+static bool dap_swo_control(const uint8_t control)
+{
+	if (!dap_swo_simple_request(DAP_SWO_CONTROL, control)) {
+		DEBUG_PROBE("%s failed\n", __func__);
+		return false;
+	}
+	return true;
+}
+
+/* Returns the baud rate the adaptor actually selected, or 0 if it can't do anything close to what was asked */
+static uint32_t dap_swo_configure_baudrate(const uint32_t baudrate)
+{
+	uint8_t request[5] = {DAP_SWO_BAUDRATE};
+	write_le4(request, 1, baudrate);
+	uint8_t response[4] = {0};
+	/* Execute it and check if it failed */
+	if (!dap_run_cmd(request, 5U, response, 4U)) {
+		DEBUG_PROBE("%s failed\n", __func__);
+		return 0U;
+	}
+	return read_le4(response, 0);
+}
+
+/* Fetch as much trace as will fit in one response, returning how many bytes were retrieved */
+static size_t dap_swo_data(uint8_t *const data, uint8_t *const status)
+{
+	uint8_t request[3] = {DAP_SWO_DATA};
+	write_le2(request, 1, DAP_SWO_DATA_MAX);
+	uint8_t response[DAP_SWO_DATA_MAX + 3U] = {0};
+	/*
+	 * The response is variable length, so rather than checking the result, validate the count it contains.
+	 * This runs on the poll thread, so must not touch the main thread's JTAG sequence queue.
+	 */
+	dap_run_cmd_unordered(request, 3U, response, sizeof(response));
+	*status = response[0];
+	const size_t count = MIN(read_le2(response, 1), DAP_SWO_DATA_MAX);
+	memcpy(data, response + 3U, count);
+	return count;
+}
+
+static void *dap_swo_poll_thread(void *const arg)
+{
+	(void)arg;
+	bool overrun_reported = false;
+	while (atomic_load(&dap_swo_running)) {
+		uint8_t data[DAP_SWO_DATA_MAX];
+		uint8_t status = 0U;
+		const size_t count = dap_swo_data(data, &status);
+		if ((status & DAP_SWO_STATUS_OVERRUN) && !overrun_reported) {
+			DEBUG_WARN("CMSIS-DAP SWO buffer overrun, trace data has been lost\n");
+			overrun_reported = true;
+		}
+		if (count)
+			traceswo_data(data, count);
+		/* Back off when the adaptor has nothing buffered so we don't monopolise the probe */
+		if (count < DAP_SWO_DATA_MAX)
+			platform_delay(1U);
+	}
+	return NULL;
+}
+
+static bool dap_swo_start_capture(void)
+{
+	if (dap_swo_transport_mode == DAP_SWO_TRANSPORT_ENDPOINT)
+		return traceswo_usb_start(dap_usb_handle(), bmda_probe_info.swo_ep, DAP_SWO_TRANSFER_SIZE);
+	atomic_store(&dap_swo_running, true);
+	if (pthread_create(&dap_swo_thread, NULL, dap_swo_poll_thread, NULL) == 0)
+		return true;
+	atomic_store(&dap_swo_running, false);
+	DEBUG_ERROR("Failed to start the SWO capture thread\n");
+	return false;
+}
+
+bool dap_swo_init(const uint32_t baudrate)
+{
+	if (!(dap_caps & (DAP_CAP_SWO_ASYNC | DAP_CAP_SWO_MANCHESTER))) {
+		gdb_out("This CMSIS-DAP adaptor does not support SWO trace\n");
+		return false;
+	}
+	dap_swo_deinit();
+
+	/* Prefer UART (NRZ) encoding, falling back to Manchester if that's all the adaptor can do */
+	const dap_swo_mode_e mode = (dap_caps & DAP_CAP_SWO_ASYNC) ? DAP_SWO_MODE_UART : DAP_SWO_MODE_MANCHESTER;
+	/* Likewise prefer streaming over the trace endpoint, falling back to polling with DAP_SWO_Data */
+	dap_swo_transport_mode = (dap_caps & DAP_CAP_SWO_STREAMING) && bmda_probe_info.swo_ep && dap_usb_handle() ?
+		DAP_SWO_TRANSPORT_ENDPOINT :
+		DAP_SWO_TRANSPORT_DATA_COMMAND;
+
+	if (!dap_swo_configure_transport(dap_swo_transport_mode) || !dap_swo_configure_mode(mode))
+		return false;
+	const uint32_t actual_baudrate = dap_swo_configure_baudrate(baudrate);
+	if (!actual_baudrate) {
+		gdb_outf("CMSIS-DAP adaptor cannot capture SWO at %" PRIu32 " baud\n", baudrate);
+		dap_swo_configure_mode(DAP_SWO_MODE_OFF);
+		return false;
+	}
+	if (actual_baudrate != baudrate)
+		gdb_outf("CMSIS-DAP adaptor is using the closest baud rate it supports: %" PRIu32 "\n", actual_baudrate);
+	traceswo_target_setup(actual_baudrate, mode == DAP_SWO_MODE_MANCHESTER);
+	if (!dap_swo_control(DAP_SWO_CONTROL_START)) {
+		dap_swo_configure_mode(DAP_SWO_MODE_OFF);
+		return false;
+	}
+	if (!dap_swo_start_capture()) {
+		dap_swo_control(DAP_SWO_CONTROL_STOP);
+		dap_swo_configure_mode(DAP_SWO_MODE_OFF);
+		return false;
+	}
+	dap_swo_started = true;
+	DEBUG_INFO("CMSIS-DAP SWO capture started in %s mode via %s\n", mode == DAP_SWO_MODE_UART ? "UART" : "Manchester",
+		dap_swo_transport_mode == DAP_SWO_TRANSPORT_ENDPOINT ? "trace endpoint" : "DAP_SWO_Data");
+	return true;
+}
+
+void dap_swo_deinit(void)
+{
+	if (!dap_swo_started)
+		return;
+	if (dap_swo_transport_mode == DAP_SWO_TRANSPORT_ENDPOINT)
+		traceswo_usb_stop();
+	else {
+		atomic_store(&dap_swo_running, false);
+		pthread_join(dap_swo_thread, NULL);
+	}
+	dap_swo_control(DAP_SWO_CONTROL_STOP);
+	dap_swo_configure_mode(DAP_SWO_MODE_OFF);
+	dap_swo_configure_transport(DAP_SWO_TRANSPORT_NONE);
+	dap_swo_started = false;
+}
@@ -32,8 +32,10 @@
  */
 
 #include <stdarg.h>
+#include <stdatomic.h>
 #include "general.h"
 #include "debug.h"
+#include "timing.h"
 
 uint16_t bmda_debug_flags = BMD_DEBUG_ERROR | BMD_DEBUG_WARNING;
 
@@ -42,6 +44,8 @@ static void debug_print(const uint16_t level, const char *format, va_list args)
 	/* Check if the required level is enabled */
 	if (!(bmda_debug_flags & level))
 		return;
+	/* Make sure anything traced before this message comes out before it */
+	bmda_trace_flush();
 	/* Check to see which of stderr and stdout the message should go to */
 	FILE *const where = bmda_debug_flags & BMD_DEBUG_USE_STDERR ? stderr : stdout;
 	/* And shoot the message to the correct place */
@@ -94,3 +98,217 @@ void debug_wire(const char *format, ...)
 {
 	DEBUG_PRINT(BMD_DEBUG_WIRE);
 }
+
+/* Must be a power of 2 */
+#define BMDA_TRACE_RING_ENTRIES   16384U
+#define BMDA_TRACE_RING_MASK      (BMDA_TRACE_RING_ENTRIES - 1U)
+#define BMDA_TRACE_INLINE_PAYLOAD 28U
+#define BMDA_TRACE_TRUNCATED      0x8000U
+#define BMDA_TRACE_LENGTH_MASK    0x7fffU
+
+/*
+ * A trace entry holds an event's arguments and the start of its payload. Payloads that don't fit
+ * carry on into the following entries, which are then treated as raw bytes.
+ */
+typedef struct bmda_trace_entry {
+	uint64_t time_us;
+	const char *str;
+	uint16_t event;
+	uint16_t length;
+	uint32_t args[4];
+	uint8_t payload[BMDA_TRACE_INLINE_PAYLOAD];
+} bmda_trace_entry_s;
+
+typedef struct bmda_trace_ring bmda_trace_ring_s;
+
+/* Single producer (the owning thread), single consumer (whichever thread holds the drain lock) */
+struct bmda_trace_ring {
+	atomic_size_t head;
+	atomic_size_t tail;
+	atomic_size_t dropped;
+	bmda_trace_ring_s *next;
+	bmda_trace_entry_s entries[BMDA_TRACE_RING_ENTRIES];
+};
+
+#define BMDA_TRACE_EVENT_FORMAT(name, level, display, limit, format)  format,
+#define BMDA_TRACE_EVENT_DISPLAY(name, level, display, limit, format) BMDA_TRACE_DISPLAY_##display,
+#define BMDA_TRACE_EVENT_LIMIT(name, level, display, limit, format)   (limit) ? (limit) : BMDA_TRACE_MAX_PAYLOAD,
+
+static const char *const bmda_trace_formats[BMDA_TRACE_EVENT_COUNT] = {BMDA_TRACE_EVENTS(BMDA_TRACE_EVENT_FORMAT)};
+static const uint8_t bmda_trace_displays[BMDA_TRACE_EVENT_COUNT] = {BMDA_TRACE_EVENTS(BMDA_TRACE_EVENT_DISPLAY)};
+static const uint16_t bmda_trace_limits[BMDA_TRACE_EVENT_COUNT] = {BMDA_TRACE_EVENTS(BMDA_TRACE_EVENT_LIMIT)};
+
+static _Atomic(bmda_trace_ring_s *) bmda_trace_rings = NULL;
+static _Thread_local bmda_trace_ring_s *bmda_trace_ring = NULL;
+static _Thread_local bool bmda_trace_draining = false;
+static atomic_flag bmda_trace_drain_lock = ATOMIC_FLAG_INIT;
+/* Only ever touched with the drain lock held */
+static char bmda_trace_line[(BMDA_TRACE_MAX_PAYLOAD * 4U) + 8U];
+
+static bmda_trace_ring_s *bmda_trace_ring_create(void)
+{
+	bmda_trace_ring_s *const ring = calloc(1, sizeof(*ring));
+	if (!ring) /* calloc failed: heap exhaustion */
+		return NULL;
+	/* Publish the new ring to the drainer - rings live for as long as BMDA does */
+	ring->next = atomic_load_explicit(&bmda_trace_rings, memory_order_relaxed);
+	while (!atomic_compare_exchange_weak_explicit(
+		&bmda_trace_rings, &ring->next, ring, memory_order_release, memory_order_relaxed))
+		continue;
+	bmda_trace_ring = ring;
+	return ring;
+}
+
+static size_t bmda_trace_slots(const size_t length)
+{
+	if (length <= BMDA_TRACE_INLINE_PAYLOAD)
+		return 1U;
+	return 1U + (length - BMDA_TRACE_INLINE_PAYLOAD + sizeof(bmda_trace_entry_s) - 1U) / sizeof(bmda_trace_entry_s);
+}
+
+/* Locate the payload byte at the given offset for the entry at index, and how many bytes follow it contiguously */
+static uint8_t *bmda_trace_payload(bmda_trace_ring_s *const ring, const size_t index, const size_t offset, size_t *const span)
+{
+	if (offset < BMDA_TRACE_INLINE_PAYLOAD) {
+		*span = BMDA_TRACE_INLINE_PAYLOAD - offset;
+		return ring->entries[index & BMDA_TRACE_RING_MASK].payload + offset;
+	}
+	const size_t overflow = offset - BMDA_TRACE_INLINE_PAYLOAD;
+	const size_t slot = (index + 1U + overflow / sizeof(bmda_trace_entry_s)) & BMDA_TRACE_RING_MASK;
+	*span = sizeof(bmda_trace_entry_s) - (overflow % sizeof(bmda_trace_entry_s));
+	return (uint8_t *)&ring->entries[slot] + (overflow % sizeof(bmda_trace_entry_s));
+}
+
+static size_t bmda_trace_copy_in(bmda_trace_ring_s *const ring, const size_t index, size_t offset,
+	const uint8_t *const data, const size_t length)
+{
+	for (size_t copied = 0; copied < length;) {
+		size_t span = 0;
+		uint8_t *const dest = bmda_trace_payload(ring, index, offset, &span);
+		const size_t amount = MIN(span, length - copied);
+		memcpy(dest, data + copied, amount);
+		copied += amount;
+		offset += amount;
+	}
+	return offset;
+}
+
+void bmda_trace_record(const bmda_trace_event_e event, const char *const str, const uint32_t args[4],
+	const void *const data1, const size_t length1, const void *const data2, const size_t length2)
+{
+	bmda_trace_ring_s *const ring = bmda_trace_ring ? bmda_trace_ring : bmda_trace_ring_create();
+	if (!ring)
+		return;
+
+	size_t length = length1 + length2;
+	uint16_t flags = 0U;
+	if (length > bmda_trace_limits[event]) {
+		length = bmda_trace_limits[event];
+		flags |= BMDA_TRACE_TRUNCATED;
+	}
+	const size_t slots = bmda_trace_slots(length);
+	const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	if (BMDA_TRACE_RING_ENTRIES - (head - tail) < slots) {
+		/* The ring is full - try to make room before resorting to dropping the event */
+		bmda_trace_flush();
+		tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (BMDA_TRACE_RING_ENTRIES - (head - tail) < slots) {
+			atomic_fetch_add_explicit(&ring->dropped, 1U, memory_order_relaxed);
+			return;
+		}
+	}
+
+	bmda_trace_entry_s *const entry = &ring->entries[head & BMDA_TRACE_RING_MASK];
+	entry->time_us = platform_time_us();
+	entry->str = str;
+	entry->event = event;
+	entry->length = (uint16_t)length | flags;
+	memcpy(entry->args, args, sizeof(entry->args));
+	const size_t first = MIN(length1, length);
+	const size_t offset = bmda_trace_copy_in(ring, head, 0U, data1, first);
+	bmda_trace_copy_in(ring, head, offset, data2, length - first);
+	atomic_store_explicit(&ring->head, head + slots, memory_order_release);
+}
+
+static void bmda_trace_print(const uint16_t level, const char *const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	debug_print(level, format, args);
+	va_end(args);
+}
+
+static void bmda_trace_render(bmda_trace_ring_s *const ring, const size_t index)
+{
+	const bmda_trace_entry_s *const entry = &ring->entries[index & BMDA_TRACE_RING_MASK];
+	const bmda_trace_event_e event = (bmda_trace_event_e)entry->event;
+	const uint16_t level = bmda_trace_event_level(event);
+	const char *const format = bmda_trace_formats[event];
+	const uint32_t *const args = entry->args;
+
+	if (bmda_trace_displays[event] == BMDA_TRACE_DISPLAY_ADIV5) {
+		bmda_decode_adiv5_access(args[0], args[1], args[2], args[3]);
+		bmda_trace_print(level, format, args[3]);
+		bmda_trace_print(level, "\n");
+		return;
+	}
+	if (entry->str)
+		bmda_trace_print(level, format, entry->str, args[0], args[1], args[2], args[3]);
+	else
+		bmda_trace_print(level, format, args[0], args[1], args[2], args[3]);
+
+	/* Build the payload up as a single line so it only costs a single write */
+	const size_t length = entry->length & BMDA_TRACE_LENGTH_MASK;
+	size_t line_length = 0;
+	for (size_t offset = 0; offset < length;) {
+		size_t span = 0;
+		const uint8_t *const data = bmda_trace_payload(ring, index, offset, &span);
+		for (size_t idx = 0; idx < span && offset < length; ++idx, ++offset) {
+			const uint8_t value = data[idx];
+			if (bmda_trace_displays[event] == BMDA_TRACE_DISPLAY_TEXT && value >= ' ' && value < 0x7fU)
+				bmda_trace_line[line_length++] = (char)value;
+			else
+				line_length += (size_t)snprintf(bmda_trace_line + line_length, sizeof(bmda_trace_line) - line_length,
+					bmda_trace_displays[event] == BMDA_TRACE_DISPLAY_TEXT ? "\\x%02X" : " %02x", value);
+		}
+	}
+	bmda_trace_line[line_length] = '\0';
+	bmda_trace_print(level, "%s%s\n", bmda_trace_line, entry->length & BMDA_TRACE_TRUNCATED ? " ..." : "");
+}
+
+/* Format out everything traced so far, merging the per-thread rings back into time order */
+void bmda_trace_flush(void)
+{
+	if (bmda_trace_draining || atomic_flag_test_and_set_explicit(&bmda_trace_drain_lock, memory_order_acquire))
+		return;
+	bmda_trace_draining = true;
+
+	while (true) {
+		bmda_trace_ring_s *next_ring = NULL;
+		size_t next_index = 0;
+		uint64_t next_time = UINT64_MAX;
+		for (bmda_trace_ring_s *ring = atomic_load_explicit(&bmda_trace_rings, memory_order_acquire); ring;
+			 ring = ring->next) {
+			const size_t dropped = atomic_exchange_explicit(&ring->dropped, 0U, memory_order_relaxed);
+			if (dropped)
+				bmda_trace_print(BMD_DEBUG_WARNING, "*** %zu trace events dropped\n", dropped);
+			const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+			if (tail == atomic_load_explicit(&ring->head, memory_order_acquire))
+				continue;
+			if (ring->entries[tail & BMDA_TRACE_RING_MASK].time_us < next_time) {
+				next_ring = ring;
+				next_index = tail;
+				next_time = ring->entries[tail & BMDA_TRACE_RING_MASK].time_us;
+			}
+		}
+		if (!next_ring)
+			break;
+		bmda_trace_render(next_ring, next_index);
+		const size_t length = next_ring->entries[next_index & BMDA_TRACE_RING_MASK].length & BMDA_TRACE_LENGTH_MASK;
+		atomic_store_explicit(&next_ring->tail, next_index + bmda_trace_slots(length), memory_order_release);
+	}
+
+	bmda_trace_draining = false;
+	atomic_flag_clear_explicit(&bmda_trace_drain_lock, memory_order_release);
+}
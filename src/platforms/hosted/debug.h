@@ -39,6 +39,7 @@
 #define __USE_MINGW_ANSI_STDIO 1
 #endif
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
 typedef const char *debug_str_t;
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -72,4 +73,106 @@ void debug_protocol(const char *format, ...) DEBUG_FORMAT_ATTR;
 void debug_probe(const char *format, ...) DEBUG_FORMAT_ATTR;
 void debug_wire(const char *format, ...) DEBUG_FORMAT_ATTR;
 
+/*
+ * Binary tracing for hot paths
+ *
+ * Events are registered here at compile time with the debug level that gates them, how their payload
+ * (if any) should be displayed, how many bytes of it are kept (0 for up to BMDA_TRACE_MAX_PAYLOAD), and
+ * the format string for their arguments. Recording an event only copies its arguments and payload into a
+ * per-thread lock-free ring - all formatting is deferred until the rings are drained, which happens before
+ * any other debug output is written and whenever BMDA is otherwise idle. Events with a string argument take
+ * a pointer to a string with static storage duration (such as __func__) which must be the first conversion
+ * in the format string. Payloads cut short are displayed with a trailing " ...".
+ *
+ * X(name, level, payload display, payload limit, format)
+ */
+#define BMDA_TRACE_EVENTS(X)                                                                   \
+	X(GDB_PACKET_RX, BMD_DEBUG_GDB, TEXT, 0U, "gdb_getpacket: ")                               \
+	X(GDB_PACKET_TX, BMD_DEBUG_GDB, TEXT, 0U, "gdb_putpacket: ")                               \
+	X(GDB_NOTIFICATION_TX, BMD_DEBUG_GDB, TEXT, 0U, "gdb_put_notification: ")                  \
+	X(USB_REQUEST, BMD_DEBUG_WIRE, HEX, 32U, " request:")                                      \
+	X(USB_RESPONSE, BMD_DEBUG_WIRE, HEX, 32U, "response:")                                     \
+	X(DAP_COMMAND, BMD_DEBUG_WIRE, HEX, 0U, " command:")                                       \
+	X(DAP_RESPONSE, BMD_DEBUG_WIRE, HEX, 0U, "response:")                                      \
+	X(FTDI_WRITE, BMD_DEBUG_WIRE, HEX, 0U, "%s: %u bytes:")                                    \
+	X(FTDI_READ, BMD_DEBUG_WIRE, HEX, 0U, "%s: %u bytes:")                                     \
+	X(REMOTE_TX, BMD_DEBUG_WIRE, TEXT, 0U, "")                                                 \
+	X(REMOTE_RX, BMD_DEBUG_WIRE, TEXT, 0U, "       ")                                          \
+	X(SWD_SEQ, BMD_DEBUG_PROBE, NONE, 0U, "%s %u clock_cycles: %08x")                          \
+	X(SWD_SEQ_PARITY_OK, BMD_DEBUG_PROBE, NONE, 0U, "%s %u clock_cycles: %08x OK")             \
+	X(SWD_SEQ_PARITY_ERR, BMD_DEBUG_PROBE, NONE, 0U, "%s %u clock_cycles: %08x ERR")           \
+	X(PROBE_REG_READ, BMD_DEBUG_PROBE, NONE, 0U, "%s: addr %04x -> %08x")                      \
+	X(PROBE_REG_WRITE, BMD_DEBUG_PROBE, NONE, 0U, "%s: addr %04x <- %08x")                     \
+	X(ADIV5_ACCESS, BMD_DEBUG_PROTO, ADIV5, 0U, "0x%08x")                                      \
+	X(ADIV5_DP_ERROR, BMD_DEBUG_PROTO, NONE, 0U, "DP Error 0x%08x")                            \
+	X(ADIV5_DP_ABORT, BMD_DEBUG_PROTO, NONE, 0U, "Abort: %08x")                                \
+	X(ADIV5_MEM_READ, BMD_DEBUG_PROTO, HEX, 16U, "ap_memread @ %x len %u:")                    \
+	X(ADIV5_MEM_WRITE, BMD_DEBUG_PROTO, HEX, 16U, "ap_mem_write_sized @ %x len %u, align %u:") \
+	X(ADIV5_FIFO_READ, BMD_DEBUG_PROTO, HEX, 16U, "ap_fifo_read @ %x len %u, align %u:")       \
+	X(ADIV5_FIFO_WRITE, BMD_DEBUG_PROTO, HEX, 16U, "ap_fifo_write @ %x len %u, align %u:")
+
+#define BMDA_TRACE_EVENT_ID(name, level, display, limit, format) BMDA_TRACE_##name,
+#define BMDA_TRACE_EVENT_LEVEL(name, level, display, limit, format) \
+	case BMDA_TRACE_##name:                                         \
+		return level;
+
+typedef enum bmda_trace_event {
+	BMDA_TRACE_EVENTS(BMDA_TRACE_EVENT_ID) BMDA_TRACE_EVENT_COUNT,
+} bmda_trace_event_e;
+
+/* How an event's payload is displayed - ADIV5 events have their register address decoded */
+typedef enum bmda_trace_display {
+	BMDA_TRACE_DISPLAY_NONE,
+	BMDA_TRACE_DISPLAY_HEX,
+	BMDA_TRACE_DISPLAY_TEXT,
+	BMDA_TRACE_DISPLAY_ADIV5,
+} bmda_trace_display_e;
+
+/* Payloads longer than this are truncated */
+#define BMDA_TRACE_MAX_PAYLOAD 2048U
+
+static inline uint16_t bmda_trace_event_level(const bmda_trace_event_e event)
+{
+	switch (event) {
+		BMDA_TRACE_EVENTS(BMDA_TRACE_EVENT_LEVEL)
+	default:
+		return 0U;
+	}
+}
+
+void bmda_trace_record(bmda_trace_event_e event, const char *str, const uint32_t args[4], const void *data1,
+	size_t length1, const void *data2, size_t length2);
+void bmda_trace_flush(void);
+
+/* Render callback for BMDA_TRACE_DISPLAY_ADIV5 events, args are address, RnW and AP number */
+void bmda_decode_adiv5_access(uint16_t addr, uint8_t rnw, uint8_t apsel, uint32_t value);
+
+/* Recording is gated on the same verbosity flags as the rest of the debug output */
+#define BMDA_TRACE_ENABLED(id)     ((bmda_debug_flags & bmda_trace_event_level(id)) != 0U)
+#define DEBUG_TRACE_ENABLED(event) BMDA_TRACE_ENABLED(BMDA_TRACE_##event)
+
+#define DEBUG_TRACE(event, ...)                                                                              \
+	do {                                                                                                     \
+		if (BMDA_TRACE_ENABLED(BMDA_TRACE_##event))                                                          \
+			bmda_trace_record(BMDA_TRACE_##event, NULL, (const uint32_t[4]){__VA_ARGS__}, NULL, 0, NULL, 0); \
+	} while (0)
+
+#define DEBUG_TRACE_FN(event, str, ...)                                                                     \
+	do {                                                                                                    \
+		if (BMDA_TRACE_ENABLED(BMDA_TRACE_##event))                                                         \
+			bmda_trace_record(BMDA_TRACE_##event, str, (const uint32_t[4]){__VA_ARGS__}, NULL, 0, NULL, 0); \
+	} while (0)
+
+#define DEBUG_TRACE_DATA(event, str, data, length, ...)                                                          \
+	do {                                                                                                         \
+		if (BMDA_TRACE_ENABLED(BMDA_TRACE_##event))                                                              \
+			bmda_trace_record(BMDA_TRACE_##event, str, (const uint32_t[4]){__VA_ARGS__}, data, length, NULL, 0); \
+	} while (0)
+
+#define DEBUG_TRACE_DATA2(event, data1, length1, data2, length2)                                                 \
+	do {                                                                                                         \
+		if (BMDA_TRACE_ENABLED(BMDA_TRACE_##event))                                                              \
+			bmda_trace_record(BMDA_TRACE_##event, NULL, (const uint32_t[4]){0}, data1, length1, data2, length2); \
+	} while (0)
+
 #endif /*PLATFORMS_HOSTED_DEBUG_H*/
@@ -0,0 +1,595 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * This file implements loading and running CMSIS-Pack Flash algorithms (.FLM files) so that parts
+ * and external memories without a dedicated driver can still be programmed.
+ *
+ * An FLM is a 32-bit little endian ARM ELF file holding position independent code (PrgCode) and
+ * data (PrgData), a FlashDevice structure describing the memory (DevDscr), and the Init, UnInit,
+ * EraseSector and ProgramPage entry points. The algorithm is placed in the target's largest RAM
+ * region laid out as:
+ *
+ *   load address             - breakpoint the entry points return to through LR
+ *   + FLM_CODE_OFFSET        - PrgCode and PrgData as laid out in the ELF, with R9 pointing at PrgData
+ *   + FLM_STACK_SIZE         - the algorithm's stack
+ *   two page sized buffers   - data for ProgramPage
+ *
+ * Page programming is double buffered: while ProgramPage runs on one buffer the next page is written
+ * into the other, and the result of the running call is only collected once the next page is ready.
+ */
+
+#include "general.h"
+#include "target.h"
+#include "target_internal.h"
+#include "cortex.h"
+#include "cortexm.h"
+#include "buffer_utils.h"
+#include "flm.h"
+
+#define ELF_HEADER_SIZE         52U
+#define ELF_SECTION_HEADER_SIZE 40U
+#define ELF_SYMBOL_SIZE         16U
+#define ELF_CLASS_32            1U
+#define ELF_DATA_LSB            1U
+#define ELF_MACHINE_ARM         40U
+#define ELF_SHT_PROGBITS        1U
+#define ELF_SHT_SYMTAB          2U
+#define ELF_SHT_STRTAB          3U
+#define ELF_SHT_NOBITS          8U
+#define ELF_SHF_ALLOC           0x2U
+#define ELF_SHN_UNDEF           0U
+
+/* Layout of the FlashDevice structure in the DevDscr section */
+#define FLM_DEV_NAME          2U
+#define FLM_DEV_NAME_LENGTH   128U
+#define FLM_DEV_ADDR          132U
+#define FLM_DEV_SIZE          136U
+#define FLM_DEV_PAGE_SIZE     140U
+#define FLM_DEV_ERASED        148U
+#define FLM_DEV_TIMEOUT_PROG  152U
+#define FLM_DEV_TIMEOUT_ERASE 156U
+#define FLM_DEV_SECTORS       160U
+#define FLM_SECTOR_SIZE       8U
+#define FLM_SECTOR_END        0xffffffffU
+
+/* Values for the fnc argument of Init and UnInit */
+#define FLM_FNC_ERASE   1U
+#define FLM_FNC_PROGRAM 2U
+
+#define FLM_MAX_FILE_SIZE  (1024U * 1024U)
+#define FLM_MAX_IMAGE_SIZE (64U * 1024U)
+#define FLM_MAX_PAGE_SIZE  (64U * 1024U)
+#define FLM_BKPT_INSNS     0xbe00be00U
+#define FLM_CODE_OFFSET    0x20U
+#define FLM_STACK_SIZE     0x800U
+#define FLM_MIN_TIMEOUT    1000U
+#define FLM_INIT_TIMEOUT   1000U
+
+typedef enum flm_function {
+	FLM_INIT,
+	FLM_UNINIT,
+	FLM_ERASE_SECTOR,
+	FLM_PROGRAM_PAGE,
+	FLM_FUNCTION_COUNT,
+} flm_function_e;
+
+static const char *const flm_function_names[FLM_FUNCTION_COUNT] = {
+	"Init",
+	"UnInit",
+	"EraseSector",
+	"ProgramPage",
+};
+
+typedef struct elf_section {
+	uint32_t name;
+	uint32_t type;
+	uint32_t flags;
+	uint32_t addr;
+	uint32_t offset;
+	uint32_t size;
+	uint32_t link;
+} elf_section_s;
+
+typedef struct flm {
+	target_s *target;
+	uint8_t *image;
+	size_t image_length;
+	uint32_t static_base;
+	uint32_t functions[FLM_FUNCTION_COUNT];
+	uint32_t dev_addr;
+	uint32_t page_size;
+	uint32_t timeout_prog;
+	uint32_t timeout_erase;
+	/* Where the algorithm lives in target RAM */
+	target_addr_t load_addr;
+	target_addr_t stack_top;
+	target_addr_t buffers[2];
+	/* Double buffering state for ProgramPage */
+	uint8_t next_buffer;
+	bool busy;
+} flm_s;
+
+/* The algorithm currently loaded, shared by all the Flash regions its FlashDevice describes */
+static flm_s flm;
+
+static bool flm_flash_prepare(target_flash_s *flash);
+static bool flm_flash_erase(target_flash_s *flash, target_addr_t addr, size_t len);
+static bool flm_flash_write(target_flash_s *flash, target_addr_t dest, const void *src, size_t len);
+static bool flm_flash_done(target_flash_s *flash);
+
+static bool elf_section(const uint8_t *const data, const size_t size, const size_t index, elf_section_s *const section)
+{
+	const uint32_t table = read_le4(data, 0x20U);
+	const uint16_t count = read_le2(data, 0x30U);
+	const uint16_t entry_size = read_le2(data, 0x2eU);
+	if (index >= count || entry_size < ELF_SECTION_HEADER_SIZE)
+		return false;
+	const size_t offset = table + index * entry_size;
+	if (offset < table || offset + ELF_SECTION_HEADER_SIZE > size)
+		return false;
+	section->name = read_le4(data, offset + 0x00U);
+	section->type = read_le4(data, offset + 0x04U);
+	section->flags = read_le4(data, offset + 0x08U);
+	section->addr = read_le4(data, offset + 0x0cU);
+	section->offset = read_le4(data, offset + 0x10U);
+	section->size = read_le4(data, offset + 0x14U);
+	section->link = read_le4(data, offset + 0x18U);
+	/* NOBITS sections take no space in the file, everything else has to fit in it */
+	return section->type == ELF_SHT_NOBITS ||
+		(section->offset <= size && section->size <= size - section->offset);
+}
+
+/* As elf_section(), but only for string tables, which have to be backed by the file */
+static bool elf_string_table(
+	const uint8_t *const data, const size_t size, const size_t index, elf_section_s *const section)
+{
+	return elf_section(data, size, index, section) && section->type == ELF_SHT_STRTAB;
+}
+
+/* Check if the NUL terminated string at offset in the given string table section matches name */
+static bool elf_string_matches(
+	const uint8_t *const data, const elf_section_s *const strings, const uint32_t offset, const char *const name)
+{
+	const size_t length = strlen(name);
+	if (offset >= strings->size || length >= strings->size - offset)
+		return false;
+	const char *const string = (const char *)data + strings->offset + offset;
+	return memcmp(string, name, length) == 0 && string[length] == '\0';
+}
+
+static size_t elf_section_count(const uint8_t *const data)
+{
+	return read_le2(data, 0x30U);
+}
+
+static bool elf_find_section(
+	const uint8_t *const data, const size_t size, const char *const name, size_t *const index, elf_section_s *section)
+{
+	elf_section_s strings;
+	if (!elf_string_table(data, size, read_le2(data, 0x32U), &strings))
+		return false;
+	for (size_t idx = 0; idx < elf_section_count(data); ++idx) {
+		if (elf_section(data, size, idx, section) && elf_string_matches(data, &strings, section->name, name)) {
+			if (index)
+				*index = idx;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Look a defined symbol up by name, returning its value and the section it belongs to */
+static bool elf_find_symbol(const uint8_t *const data, const size_t size, const char *const name,
+	uint32_t *const value, uint16_t *const section_index)
+{
+	for (size_t idx = 0; idx < elf_section_count(data); ++idx) {
+		elf_section_s symbols;
+		elf_section_s strings;
+		if (!elf_section(data, size, idx, &symbols) || symbols.type != ELF_SHT_SYMTAB ||
+			!elf_string_table(data, size, symbols.link, &strings))
+			continue;
+		for (size_t offset = 0; offset + ELF_SYMBOL_SIZE <= symbols.size; offset += ELF_SYMBOL_SIZE) {
+			const uint8_t *const symbol = data + symbols.offset + offset;
+			const uint16_t shndx = read_le2(symbol, 14U);
+			if (shndx == ELF_SHN_UNDEF || !elf_string_matches(data, &strings, read_le4(symbol, 0U), name))
+				continue;
+			*value = read_le4(symbol, 4U);
+			if (section_index)
+				*section_index = shndx;
+			return true;
+		}
+	}
+	return false;
+}
+
+static uint8_t *flm_read_file(target_s *const target, const char *const path, size_t *const size)
+{
+	FILE *const file = fopen(path, "rb");
+	if (!file) {
+		tc_printf(target, "Could not open Flash algorithm '%s'\n", path);
+		return NULL;
+	}
+	uint8_t *const data = malloc(FLM_MAX_FILE_SIZE);
+	if (!data) { /* malloc failed: heap exhaustion */
+		DEBUG_ERROR("malloc: failed in %s\n", __func__);
+		fclose(file);
+		return NULL;
+	}
+	*size = fread(data, 1, FLM_MAX_FILE_SIZE, file);
+	const bool too_big = !feof(file);
+	fclose(file);
+	if (too_big || *size < ELF_HEADER_SIZE) {
+		tc_printf(target, "'%s' is not a valid Flash algorithm\n", path);
+		free(data);
+		return NULL;
+	}
+	return data;
+}
+
+/*
+ * Build the RAM image of the algorithm: every allocated section other than the device description,
+ * at its link address. FLMs are linked at 0, so the image is relative to where it gets loaded.
+ */
+static bool flm_build_image(const uint8_t *const data, const size_t size, const size_t devdscr, flm_s *const algo)
+{
+	size_t length = 0;
+	for (size_t idx = 0; idx < elf_section_count(data); ++idx) {
+		elf_section_s section;
+		if (idx == devdscr || !elf_section(data, size, idx, &section) || !(section.flags & ELF_SHF_ALLOC) ||
+			(section.type != ELF_SHT_PROGBITS && section.type != ELF_SHT_NOBITS))
+			continue;
+		if (section.addr > FLM_MAX_IMAGE_SIZE || section.size > FLM_MAX_IMAGE_SIZE - section.addr)
+			return false;
+		length = MAX(length, section.addr + section.size);
+	}
+	if (!length)
+		return false;
+
+	/* Everything not covered by a PROGBITS section (including the .bss in PrgData) starts out zeroed */
+	algo->image = calloc(1, length);
+	if (!algo->image) { /* calloc failed: heap exhaustion */
+		DEBUG_ERROR("calloc: failed in %s\n", __func__);
+		return false;
+	}
+	algo->image_length = length;
+	for (size_t idx = 0; idx < elf_section_count(data); ++idx) {
+		elf_section_s section;
+		if (idx == devdscr || !elf_section(data, size, idx, &section) || !(section.flags & ELF_SHF_ALLOC) ||
+			section.type != ELF_SHT_PROGBITS)
+			continue;
+		memcpy(algo->image + section.addr, data + section.offset, section.size);
+	}
+	return true;
+}
+
+static bool flm_is_power_of_two(const uint32_t value)
+{
+	return value && !(value & (value - 1U));
+}
+
+/* Register a Flash region for each run of equally sized sectors in the FlashDevice sector table */
+static bool flm_add_regions(target_s *const target, const uint8_t *const device, const size_t length)
+{
+	const uint32_t dev_size = read_le4(device, FLM_DEV_SIZE);
+	const uint8_t erased = device[FLM_DEV_ERASED];
+	size_t regions = 0;
+	for (size_t offset = FLM_DEV_SECTORS; offset + FLM_SECTOR_SIZE <= length; offset += FLM_SECTOR_SIZE) {
+		const uint32_t sector_size = read_le4(device, offset);
+		const uint32_t sector_addr = read_le4(device, offset + 4U);
+		if (sector_size == FLM_SECTOR_END && sector_addr == FLM_SECTOR_END)
+			break;
+		/* This run of sectors ends where the next starts, or at the end of the device */
+		uint32_t end = dev_size;
+		if (offset + FLM_SECTOR_SIZE * 2U <= length && read_le4(device, offset + FLM_SECTOR_SIZE) != FLM_SECTOR_END)
+			end = read_le4(device, offset + FLM_SECTOR_SIZE + 4U);
+		if (end <= sector_addr || end > dev_size || !flm_is_power_of_two(sector_size) ||
+			sector_size < flm.page_size || (end - sector_addr) % sector_size) {
+			tc_printf(target, "Unsupported sector layout in Flash algorithm at offset 0x%08" PRIx32 "\n", sector_addr);
+			return false;
+		}
+
+		target_flash_s *const flash = calloc(1, sizeof(*flash));
+		if (!flash) { /* calloc failed: heap exhaustion */
+			DEBUG_ERROR("calloc: failed in %s\n", __func__);
+			return false;
+		}
+		flash->start = flm.dev_addr + sector_addr;
+		flash->length = end - sector_addr;
+		flash->blocksize = sector_size;
+		flash->writesize = flm.page_size;
+		flash->erased = erased;
+		flash->prepare = flm_flash_prepare;
+		flash->erase = flm_flash_erase;
+		flash->write = flm_flash_write;
+		flash->done = flm_flash_done;
+		target_add_flash(target, flash);
+		DEBUG_INFO("FLM Flash region 0x%08" PRIx32 "+0x%zx, %zu byte sectors\n", flash->start, flash->length,
+			flash->blocksize);
+		++regions;
+	}
+	return regions != 0;
+}
+
+/* Drop any regions registered from a previously loaded algorithm, as they'd run this one instead */
+static void flm_remove_regions(target_s *const target)
+{
+	target_flash_s **link = &target->flash;
+	while (*link) {
+		target_flash_s *const flash = *link;
+		if (flash->erase == flm_flash_erase) {
+			*link = flash->next;
+			free(flash->buf);
+			free(flash);
+		} else
+			link = &flash->next;
+	}
+}
+
+static void flm_free(void)
+{
+	free(flm.image);
+	memset(&flm, 0, sizeof(flm));
+}
+
+/* Find the largest RAM region and lay the algorithm, its stack and the page buffers out in it */
+static bool flm_place(target_s *const target)
+{
+	const target_ram_s *ram = NULL;
+	for (const target_ram_s *region = target->ram; region; region = region->next) {
+		if (!ram || region->length > ram->length)
+			ram = region;
+	}
+	const size_t image_length = (flm.image_length + 7U) & ~7U;
+	const size_t required = FLM_CODE_OFFSET + image_length + FLM_STACK_SIZE + flm.page_size * 2U;
+	if (!ram || ram->length < required) {
+		tc_printf(target, "Not enough target RAM to run the Flash algorithm (need %zu bytes)\n", required);
+		return false;
+	}
+	flm.load_addr = ram->start;
+	flm.stack_top = ram->start + FLM_CODE_OFFSET + image_length + FLM_STACK_SIZE;
+	flm.buffers[0] = flm.stack_top;
+	flm.buffers[1] = flm.stack_top + flm.page_size;
+	return true;
+}
+
+bool flm_load(target_s *const target, const char *const path)
+{
+	if (target->halt_resume != cortexm_halt_resume) {
+		tc_printf(target, "Flash algorithms can only be run on Cortex-M targets\n");
+		return false;
+	}
+	size_t size = 0;
+	uint8_t *const data = flm_read_file(target, path, &size);
+	if (!data)
+		return false;
+
+	bool result = false;
+	flm_remove_regions(target);
+	flm_free();
+	if (memcmp(data, "\x7f" "ELF", 4U) != 0 || data[4] != ELF_CLASS_32 || data[5] != ELF_DATA_LSB ||
+		read_le2(data, 0x12U) != ELF_MACHINE_ARM) {
+		tc_printf(target, "'%s' is not a 32-bit little endian ARM ELF file\n", path);
+		goto out;
+	}
+
+	/* Find the FlashDevice description */
+	uint32_t device_addr = 0;
+	uint16_t devdscr = 0;
+	elf_section_s section;
+	if (!elf_find_symbol(data, size, "FlashDevice", &device_addr, &devdscr) ||
+		!elf_section(data, size, devdscr, &section) || section.type != ELF_SHT_PROGBITS ||
+		device_addr < section.addr || device_addr - section.addr + FLM_DEV_SECTORS > section.size) {
+		tc_printf(target, "Flash algorithm has no FlashDevice description\n");
+		goto out;
+	}
+	const uint8_t *const device = data + section.offset + (device_addr - section.addr);
+	const size_t device_length = section.size - (device_addr - section.addr);
+
+	/* Find the entry points, Init and UnInit being optional */
+	for (size_t function = 0; function < FLM_FUNCTION_COUNT; ++function) {
+		if (elf_find_symbol(data, size, flm_function_names[function], &flm.functions[function], NULL))
+			continue;
+		flm.functions[function] = UINT32_MAX;
+		if (function == FLM_ERASE_SECTOR || function == FLM_PROGRAM_PAGE) {
+			tc_printf(target, "Flash algorithm has no %s function\n", flm_function_names[function]);
+			goto out;
+		}
+	}
+
+	/* PrgData is where the algorithm's R9-relative static data lives */
+	elf_section_s prg_data;
+	if (!elf_find_section(data, size, "PrgData", NULL, &prg_data) || !flm_build_image(data, size, devdscr, &flm)) {
+		tc_printf(target, "Flash algorithm has no usable PrgCode/PrgData\n");
+		goto out;
+	}
+	flm.static_base = prg_data.addr;
+
+	char name[FLM_DEV_NAME_LENGTH + 1U] = {0};
+	memcpy(name, device + FLM_DEV_NAME, FLM_DEV_NAME_LENGTH);
+	flm.target = target;
+	flm.dev_addr = read_le4(device, FLM_DEV_ADDR);
+	flm.page_size = read_le4(device, FLM_DEV_PAGE_SIZE);
+	flm.timeout_prog = MAX(read_le4(device, FLM_DEV_TIMEOUT_PROG), FLM_MIN_TIMEOUT);
+	flm.timeout_erase = MAX(read_le4(device, FLM_DEV_TIMEOUT_ERASE), FLM_MIN_TIMEOUT);
+	if (!flm_is_power_of_two(flm.page_size) || flm.page_size > FLM_MAX_PAGE_SIZE) {
+		tc_printf(target, "Flash algorithm has an unusable page size of %" PRIu32 " bytes\n", flm.page_size);
+		goto out;
+	}
+	if (!flm_place(target) || !flm_add_regions(target, device, device_length))
+		goto out;
+	DEBUG_INFO("Loaded Flash algorithm for %s, %zu bytes at 0x%08" PRIx32 "\n", name, flm.image_length,
+		flm.load_addr + FLM_CODE_OFFSET);
+	result = true;
+
+out:
+	free(data);
+	if (!result) {
+		flm_remove_regions(target);
+		flm_free();
+	}
+	return result;
+}
+
+/* Set the core up to run one of the algorithm's entry points and let it go */
+static void flm_call_start(
+	target_s *const target, const flm_function_e function, const uint32_t r0, const uint32_t r1, const uint32_t r2)
+{
+	const target_addr_t code_addr = flm.load_addr + FLM_CODE_OFFSET;
+	uint32_t regs[CORTEXM_GENERAL_REG_COUNT + CORTEX_FLOAT_REG_COUNT] = {0};
+	target_regs_read(target, regs);
+	regs[0] = r0;
+	regs[1] = r1;
+	regs[2] = r2;
+	regs[9] = code_addr + flm.static_base;
+	regs[CORTEX_REG_SP] = flm.stack_top;
+	regs[CORTEX_REG_MSP] = flm.stack_top;
+	/* Return to the breakpoint at the load address */
+	regs[CORTEX_REG_LR] = flm.load_addr | 1U;
+	regs[CORTEX_REG_PC] = code_addr + (flm.functions[function] & ~1U);
+	regs[CORTEX_REG_XPSR] = CORTEXM_XPSR_THUMB;
+	/* Run on the main stack with interrupts masked (PRIMASK set) */
+	regs[CORTEX_REG_SPECIAL] = 1U;
+	target_regs_write(target, regs);
+	target_halt_resume(target, false);
+}
+
+/* Wait for a running entry point to return, fetching its result */
+static bool flm_call_wait(target_s *const target, const uint32_t timeout_ms, uint32_t *const result)
+{
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, timeout_ms);
+	target_halt_reason_e reason = TARGET_HALT_RUNNING;
+	while (reason == TARGET_HALT_RUNNING) {
+		if (platform_timeout_is_expired(&timeout)) {
+			target_halt_request(target);
+			DEBUG_ERROR("Flash algorithm timed out\n");
+			return false;
+		}
+		reason = target_halt_poll(target, NULL);
+	}
+
+	uint32_t pc = 0;
+	target_reg_read(target, CORTEX_REG_PC, &pc, sizeof(pc));
+	if (reason != TARGET_HALT_BREAKPOINT || pc != flm.load_addr) {
+		DEBUG_ERROR("Flash algorithm stopped unexpectedly at 0x%08" PRIx32 " (reason %d)\n", pc, reason);
+		return false;
+	}
+	target_reg_read(target, 0U, result, sizeof(*result));
+	return true;
+}
+
+static bool flm_call(target_s *const target, const flm_function_e function, const uint32_t r0, const uint32_t r1,
+	const uint32_t r2, const uint32_t timeout_ms)
+{
+	flm_call_start(target, function, r0, r1, r2);
+	uint32_t result = 0;
+	if (!flm_call_wait(target, timeout_ms, &result))
+		return false;
+	if (result != 0U)
+		DEBUG_ERROR("Flash algorithm %s failed (%" PRIu32 ")\n", flm_function_names[function], result);
+	return result == 0U;
+}
+
+/* Collect the result of any ProgramPage call still in flight */
+static bool flm_program_wait(target_s *const target)
+{
+	if (!flm.busy)
+		return true;
+	flm.busy = false;
+	uint32_t result = 0;
+	if (!flm_call_wait(target, flm.timeout_prog, &result))
+		return false;
+	if (result != 0U)
+		DEBUG_ERROR("Flash algorithm ProgramPage failed (%" PRIu32 ")\n", result);
+	return result == 0U;
+}
+
+static uint32_t flm_operation_fnc(const target_flash_s *const flash)
+{
+	return flash->operation == FLASH_OPERATION_ERASE ? FLM_FNC_ERASE : FLM_FNC_PROGRAM;
+}
+
+/* (Re)load the algorithm, as the target's program may have used the RAM since, and initialise it */
+static bool flm_flash_prepare(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	if (flm.target != target || !flm.image) {
+		DEBUG_ERROR("The Flash algorithm for this region is no longer loaded\n");
+		return false;
+	}
+	uint8_t header[FLM_CODE_OFFSET] = {0};
+	write_le4(header, 0U, FLM_BKPT_INSNS);
+	target_mem_write(target, flm.load_addr, header, sizeof(header));
+	target_mem_write(target, flm.load_addr + FLM_CODE_OFFSET, flm.image, flm.image_length);
+	if (target_check_error(target))
+		return false;
+
+	flm.busy = false;
+	flm.next_buffer = 0U;
+	if (flm.functions[FLM_INIT] == UINT32_MAX)
+		return true;
+	return flm_call(target, FLM_INIT, flm.dev_addr, 0U, flm_operation_fnc(flash), FLM_INIT_TIMEOUT);
+}
+
+static bool flm_flash_erase(target_flash_s *const flash, const target_addr_t addr, const size_t len)
+{
+	for (size_t offset = 0; offset < len; offset += flash->blocksize) {
+		if (!flm_call(flash->t, FLM_ERASE_SECTOR, addr + offset, 0U, 0U, flm.timeout_erase))
+			return false;
+	}
+	return true;
+}
+
+static bool flm_flash_write(target_flash_s *const flash, const target_addr_t dest, const void *const src, const size_t len)
+{
+	target_s *const target = flash->t;
+	/* Fill the idle buffer while the previous page is still being programmed from the other */
+	const target_addr_t buffer = flm.buffers[flm.next_buffer];
+	target_mem_write(target, buffer, src, len);
+	if (!flm_program_wait(target) || target_check_error(target))
+		return false;
+	flm_call_start(target, FLM_PROGRAM_PAGE, dest, len, buffer);
+	flm.busy = true;
+	flm.next_buffer ^= 1U;
+	return true;
+}
+
+static bool flm_flash_done(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	bool result = flm_program_wait(target);
+	if (flm.functions[FLM_UNINIT] != UINT32_MAX)
+		result &= flm_call(target, FLM_UNINIT, flm_operation_fnc(flash), 0U, 0U, FLM_INIT_TIMEOUT);
+	return result;
+}
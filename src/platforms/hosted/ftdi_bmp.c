@@ -31,6 +31,7 @@
 #include <sys/time.h>
 
 #include "ftdi_bmp.h"
+#include "exception.h"
 #include <ftdi.h>
 
 /*
@@ -47,8 +48,32 @@ typedef struct ftdi_transfer_control ftdi_transfer_control_s;
 #endif
 
 #define BUF_SIZE 4096U
-static uint8_t outbuf[BUF_SIZE];
+/*
+ * Commands are built up in one of two buffers. With async transfers available, a full buffer is sent
+ * while the other one fills, and only one write is ever kept in flight.
+ */
+static uint8_t outbuf[2][BUF_SIZE];
+static uint8_t outbuf_index = 0;
 static uint16_t bufptr = 0;
+/* Set when a write to the MPSSE fails, until ftdi_buffer_sent() reports it */
+static bool write_failed = false;
+
+/*
+ * Reads are not performed as soon as they're asked for. Instead each destination is registered
+ * here against the command buffer and the data for all of them is fetched with a single read when
+ * ftdi_buffer_sync() is called, so a scan made of several MPSSE commands costs one write and one read.
+ */
+#define READ_QUEUE_SIZE 16U
+
+typedef struct ftdi_read_request {
+	uint8_t *buffer;
+	size_t size;
+} ftdi_read_request_s;
+
+static ftdi_read_request_s read_queue[READ_QUEUE_SIZE];
+static size_t read_queue_count = 0;
+static size_t read_queue_length = 0;
+static uint8_t inbuf[BUF_SIZE];
 
 cable_desc_s active_cable;
 ftdi_port_state_s active_state;
@@ -556,6 +581,11 @@ bool ftdi_bmp_init(bmda_cli_options_s *const cl_opts)
 	ftdi_init[index++] = active_state.dirs[1];
 	ftdi_buffer_write(ftdi_init, index);
 	ftdi_buffer_flush();
+	/* Make sure the flush has gone out before poking the FTDI directly */
+	if (!ftdi_buffer_sent()) {
+		DEBUG_ERROR("Failed to write the FTDI initialisation commands\n");
+		goto error_2;
+	}
 	garbage = ftdi_read_data(ctx, ftdi_init, sizeof(ftdi_init));
 	if (garbage > 0) {
 		DEBUG_WARN("FTDI init garbage at end:");
@@ -662,6 +692,19 @@ bool ftdi_nrst_get_val(void)
 
 #if defined(USE_USB_VERSION_BIT)
 static ftdi_transfer_control_s *tc_write = NULL;
+
+/* Wait for the write in flight, if any, to finish */
+static void ftdi_buffer_write_done(void)
+{
+	if (!tc_write)
+		return;
+	const int result = ftdi_transfer_data_done(tc_write);
+	tc_write = NULL;
+	if (result < 0) {
+		DEBUG_ERROR("FTDI write failed (%d)\n", result);
+		write_failed = true;
+	}
+}
 #endif
 
 void ftdi_buffer_flush(void)
@@ -670,57 +713,115 @@ void ftdi_buffer_flush(void)
 		return;
 	DEBUG_WIRE("%s: %u bytes\n", __func__, bufptr);
 #if defined(USE_USB_VERSION_BIT)
-	if (tc_write)
-		ftdi_transfer_data_done(tc_write);
-	tc_write = ftdi_write_data_submit(bmda_probe_info.ftdi_ctx, outbuf, bufptr);
+	ftdi_buffer_write_done();
+	tc_write = ftdi_write_data_submit(bmda_probe_info.ftdi_ctx, outbuf[outbuf_index], bufptr);
+	if (!tc_write) {
+		DEBUG_ERROR("FTDI write submission failed\n");
+		write_failed = true;
+	}
+	/* Fill the other buffer while this one goes out */
+	outbuf_index ^= 1U;
 #else
-	assert(ftdi_write_data(bmda_probe_info.ftdi_ctx, outbuf, bufptr) == bufptr);
+	const int result = ftdi_write_data(bmda_probe_info.ftdi_ctx, outbuf[outbuf_index], bufptr);
+	if (result != (int)bufptr) {
+		DEBUG_ERROR("FTDI write failed (%d)\n", result);
+		write_failed = true;
+	}
 #endif
 	bufptr = 0;
 }
 
+/*
+ * Wait until everything flushed so far has been written out, returning false if any of it failed to go.
+ * Anything that then reads from the FTDI must check this first, or it'll wait on data that will never come.
+ */
+bool ftdi_buffer_sent(void)
+{
+#if defined(USE_USB_VERSION_BIT)
+	ftdi_buffer_write_done();
+#endif
+	const bool result = !write_failed;
+	write_failed = false;
+	return result;
+}
+
+static bool ftdi_buffer_receive(uint8_t *const data, const size_t size)
+{
+#if defined(USE_USB_VERSION_BIT)
+	ftdi_transfer_control_s *transfer = ftdi_read_data_submit(bmda_probe_info.ftdi_ctx, data, (int)size);
+	if (!transfer || ftdi_transfer_data_done(transfer) < 0)
+		return false;
+#else
+	for (size_t index = 0; index < size;) {
+		const int result = ftdi_read_data(bmda_probe_info.ftdi_ctx, data + index, size - index);
+		if (result < 0)
+			return false;
+		index += (size_t)result;
+	}
+#endif
+	return true;
+}
+
 size_t ftdi_buffer_write(const void *const buffer, const size_t size)
 {
 	if ((bufptr + size) / BUF_SIZE > 0)
 		ftdi_buffer_flush();
 
 	const uint8_t *const data = (const uint8_t *)buffer;
-	DEBUG_WIRE("%s: %zu bytes:", __func__, size);
-	for (size_t i = 0; i < size; i++) {
-		DEBUG_WIRE(" %02x", data[i]);
-		if (i && (i & 0xfU) == 0xfU)
-			DEBUG_WIRE("\n\t");
-	}
-	DEBUG_WIRE("\n");
-	memcpy(outbuf + bufptr, buffer, size);
+	DEBUG_TRACE_DATA(FTDI_WRITE, __func__, data, size, (uint32_t)size);
+	memcpy(outbuf[outbuf_index] + bufptr, buffer, size);
 	bufptr += size;
 	return size;
 }
 
-size_t ftdi_buffer_read(void *const buffer, const size_t size)
+void ftdi_buffer_sync(void)
 {
-	if (bufptr) {
-		const uint8_t cmd = SEND_IMMEDIATE;
-		ftdi_buffer_write(&cmd, 1);
-		ftdi_buffer_flush();
-	}
+	if (!read_queue_count)
+		return;
+	/* Make the MPSSE return the data for everything queued so far rather than waiting on its latency timer */
+	const uint8_t cmd = SEND_IMMEDIATE;
+	ftdi_buffer_write(&cmd, 1);
+	ftdi_buffer_flush();
 
-	uint8_t *const data = (uint8_t *)buffer;
-#if defined(USE_USB_VERSION_BIT)
-	ftdi_transfer_control_s *transfer = ftdi_read_data_submit(bmda_probe_info.ftdi_ctx, data, (int)size);
-	ftdi_transfer_data_done(transfer);
-#else
-	for (size_t index = 0; index < size;)
-		index += ftdi_read_data(bmda_probe_info.ftdi_ctx, data + index, size - index);
-#endif
+	/* If the commands didn't all go out, or the data doesn't come back, the pending reads are dropped */
+	const bool sent = ftdi_buffer_sent();
+	if (!sent || !ftdi_buffer_receive(inbuf, read_queue_length)) {
+		read_queue_count = 0;
+		read_queue_length = 0;
+		if (sent)
+			DEBUG_ERROR("FTDI read failed\n");
+		raise_exception(EXCEPTION_ERROR, sent ? "FTDI read failed" : "FTDI write failed");
+	}
+	DEBUG_TRACE_DATA(FTDI_READ, __func__, inbuf, read_queue_length, (uint32_t)read_queue_length);
 
-	DEBUG_WIRE("%s: %zu bytes:", __func__, size);
-	for (size_t i = 0; i < size; i++) {
-		DEBUG_WIRE(" %02x", data[i]);
-		if ((i & 0xfU) == 0xfU)
-			DEBUG_WIRE("\n\t");
+	/* Scatter the data back out to everything that asked for it */
+	size_t offset = 0;
+	for (size_t idx = 0; idx < read_queue_count; ++idx) {
+		memcpy(read_queue[idx].buffer, inbuf + offset, read_queue[idx].size);
+		offset += read_queue[idx].size;
 	}
-	DEBUG_WIRE("\n");
+	read_queue_count = 0;
+	read_queue_length = 0;
+}
+
+size_t ftdi_buffer_read_queue(void *const buffer, const size_t size)
+{
+	if (!size)
+		return 0;
+	/* If this read won't fit with the ones already pending, complete those first */
+	if (read_queue_count == READ_QUEUE_SIZE || read_queue_length + size > BUF_SIZE)
+		ftdi_buffer_sync();
+	read_queue[read_queue_count].buffer = (uint8_t *)buffer;
+	read_queue[read_queue_count].size = size;
+	++read_queue_count;
+	read_queue_length += size;
+	return size;
+}
+
+size_t ftdi_buffer_read(void *const buffer, const size_t size)
+{
+	ftdi_buffer_read_queue(buffer, size);
+	ftdi_buffer_sync();
 	return size;
 }
 
@@ -786,24 +887,29 @@ void ftdi_jtag_tdi_tdo_seq(uint8_t *data_out, const bool final_tms, const uint8_
 		ftdi_buffer_write_val(data);
 	}
 
-	/* If we're expecting data back, start reading */
+	/* If we're expecting data back, queue up the reads for each part and fetch them all in one go */
 	if (data_out) {
-		/* Read the whole bytes */
+		/* The whole bytes */
 		if (bytes)
-			ftdi_buffer_read(data_out, bytes);
-		/* Read the residual bits */
+			ftdi_buffer_read_queue(data_out, bytes);
+		/* The residual bits */
+		uint8_t residual = 0;
+		if (bits - (final_tms ? 1U : 0U))
+			ftdi_buffer_read_queue_val(residual);
+		/* The bit assocated with the TMS transaction */
+		uint8_t value = 0;
+		if (final_tms)
+			ftdi_buffer_read_queue_val(value);
+		ftdi_buffer_sync();
+
 		if (bits) {
-			ftdi_buffer_read_val(data_out[bytes]);
 			/* Because of a quirk in how the FTDI device works, the bits will be MSb aligned, so shift them down */
 			const size_t shift = bits - (final_tms ? 1U : 0U);
-			data_out[bytes] >>= 8U - shift;
+			data_out[bytes] = shift ? (uint8_t)(residual >> (8U - shift)) : 0U;
 		}
-		/* And read the data assocated with the TMS transaction and adjust the final byte */
-		if (final_tms) {
-			uint8_t value = 0;
-			ftdi_buffer_read_val(value);
+		/* Adjust the final byte to include the TMS transaction's bit */
+		if (final_tms)
 			data_out[final_byte] |= (value & 0x80U) >> (7U - final_bit);
-		}
 	}
 }
 
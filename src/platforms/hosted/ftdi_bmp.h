@@ -132,14 +132,19 @@ extern ftdi_port_state_s active_state;
 #define ftdi_buffer_read_arr(array)  ftdi_buffer_read(array, sizeof(array))
 #define ftdi_buffer_read_val(value)  ftdi_buffer_read(&(value), sizeof(value))
 
+#define ftdi_buffer_read_queue_val(value) ftdi_buffer_read_queue(&(value), sizeof(value))
+
 bool ftdi_bmp_init(bmda_cli_options_s *cl_opts);
 bool ftdi_lookup_adapter_from_vid_pid(bmda_cli_options_s *cl_opts, const probe_info_s *probe);
 bool ftdi_lookup_adaptor_descriptor(bmda_cli_options_s *cl_opts, const probe_info_s *probe);
 bool ftdi_swd_init(void);
 bool ftdi_jtag_init(void);
 void ftdi_buffer_flush(void);
+bool ftdi_buffer_sent(void);
 size_t ftdi_buffer_write(const void *buffer, size_t size);
 size_t ftdi_buffer_read(void *buffer, size_t size);
+size_t ftdi_buffer_read_queue(void *buffer, size_t size);
+void ftdi_buffer_sync(void);
 const char *ftdi_target_voltage(void);
 void ftdi_jtag_tdi_tdo_seq(uint8_t *data_out, bool final_tms, const uint8_t *data_in, size_t clock_cycles);
 bool ftdi_swd_possible(void);
@@ -53,9 +53,14 @@ static bool ftdi_jtag_next(bool tms, bool tdi);
  * Each command block is allowed to handle at most 7 clock cycles - why not 8 is undocumented.
  */
 
-void ftdi_jtag_drain_potential_garbage(void)
+bool ftdi_jtag_drain_potential_garbage(void)
 {
 	uint8_t data[16];
+	/* Make sure everything queued up so far has gone out before poking the FTDI directly */
+	if (!ftdi_buffer_sent()) {
+		DEBUG_ERROR("FTDI JTAG init failed to write to the adaptor\n");
+		return false;
+	}
 	int garbage = ftdi_read_data(bmda_probe_info.ftdi_ctx, data, sizeof(data));
 	if (garbage > 0) {
 		DEBUG_WARN("FTDI JTAG init got garbage:");
@@ -63,6 +68,7 @@ void ftdi_jtag_drain_potential_garbage(void)
 			DEBUG_WARN(" %02x", data[i]);
 		DEBUG_WARN("\n");
 	}
+	return true;
 }
 
 bool ftdi_jtag_init(void)
@@ -85,7 +91,8 @@ bool ftdi_jtag_init(void)
 	active_state.dirs[0] &= ~MPSSE_DI;
 	active_state.data[1] |= active_cable.jtag.set_data_high;
 	active_state.data[1] &= ~active_cable.jtag.clr_data_high;
-	ftdi_jtag_drain_potential_garbage();
+	if (!ftdi_jtag_drain_potential_garbage())
+		return false;
 
 	const uint8_t cmd[6] = {
 		SET_BITS_LOW,
@@ -99,11 +106,12 @@ bool ftdi_jtag_init(void)
 	ftdi_buffer_flush();
 	/* Write out start condition and pull garbage from read buffer.
 	 * FT2232D otherwise misbehaves on runs following the first run.*/
-	ftdi_jtag_drain_potential_garbage();
+	if (!ftdi_jtag_drain_potential_garbage())
+		return false;
 
-	/* Ensure we're in JTAG mode */
-	for (size_t i = 0; i <= 50U; ++i)
-		ftdi_jtag_next(true, false); /* 50 + 1 idle cycles for SWD reset */
+	/* Ensure we're in JTAG mode - 50 + 1 cycles with TMS high for SWD reset, without reading back each bit */
+	ftdi_jtag_tms_seq(UINT32_MAX, 32U);
+	ftdi_jtag_tms_seq(UINT32_MAX, 19U);
 	ftdi_jtag_tms_seq(0xe73cU, 16U); /* SWD to JTAG sequence */
 	return true;
 }
@@ -239,7 +239,10 @@ static bool ftdi_swd_seq_in_parity_mpsse(uint32_t *const result, const size_t cl
 	const uint32_t data = read_le4(data_out, 0);
 	uint8_t parity = __builtin_parity(data & ((UINT64_C(1) << clock_cycles) - 1U));
 	parity ^= data_out[4] & 1U;
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 " %s\n", __func__, clock_cycles, data, parity ? "ERR" : "OK");
+	if (parity)
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_ERR, __func__, (uint32_t)clock_cycles, data);
+	else
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_OK, __func__, (uint32_t)clock_cycles, data);
 	*result = data;
 	return parity;
 }
@@ -266,7 +269,10 @@ static bool ftdi_swd_seq_in_parity_raw(uint32_t *const result, const size_t cloc
 			data |= 1U << clock_cycle;
 		}
 	}
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 " %s\n", __func__, clock_cycles, data, parity ? "ERR" : "OK");
+	if (parity)
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_ERR, __func__, (uint32_t)clock_cycles, data);
+	else
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_OK, __func__, (uint32_t)clock_cycles, data);
 	*result = data;
 	return parity;
 }
@@ -291,7 +297,7 @@ static uint32_t ftdi_swd_seq_in_mpsse(const size_t clock_cycles)
 	uint32_t result = 0U;
 	for (size_t i = 0U; i < bytes; i++)
 		result |= data_out[i] << (8U * i);
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, result);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, result);
 	return result;
 }
 
@@ -313,7 +319,7 @@ static uint32_t ftdi_swd_seq_in_raw(const size_t clock_cycles)
 		if (data[clock_cycle] & active_cable.bb_swdio_in_pin)
 			result |= (1U << clock_cycle);
 	}
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, result);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, result);
 	return result;
 }
 
@@ -329,7 +335,7 @@ static uint32_t ftdi_swd_seq_in(size_t clock_cycles)
 
 static void ftdi_swd_seq_out_mpsse(const uint32_t tms_states, const size_t clock_cycles)
 {
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, tms_states);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, tms_states);
 	uint8_t data_in[4] = {0};
 	write_le4(data_in, 0, tms_states);
 	ftdi_jtag_tdi_tdo_seq(NULL, false, data_in, clock_cycles);
@@ -337,7 +343,7 @@ static void ftdi_swd_seq_out_mpsse(const uint32_t tms_states, const size_t clock
 
 static void ftdi_swd_seq_out_raw(uint32_t tms_states, const size_t clock_cycles)
 {
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, tms_states);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, tms_states);
 	uint8_t cmd[15U] = {0};
 	size_t offset = 0U;
 	for (size_t cycle = 0U; cycle < clock_cycles; cycle += 7U, offset += 3U) {
@@ -372,7 +378,7 @@ static void ftdi_swd_seq_out(const uint32_t tms_states, const size_t clock_cycle
 
 static void ftdi_swd_seq_out_parity_mpsse(const uint32_t tms_states, const uint8_t parity, const size_t clock_cycles)
 {
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, tms_states);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, tms_states);
 	uint8_t data_in[6] = {0};
 	write_le4(data_in, 0, tms_states);
 	/* Figure out which byte we should write the parity to */
@@ -390,7 +396,7 @@ static void ftdi_swd_seq_out_parity_mpsse(const uint32_t tms_states, const uint8
 
 static void ftdi_swd_seq_out_parity_raw(const uint32_t tms_states, const uint8_t parity, const size_t clock_cycles)
 {
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, tms_states);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, tms_states);
 	uint8_t cmd[18U] = {0};
 	size_t offset = 0;
 	for (size_t cycle = 0U; cycle < clock_cycles; cycle += 7U, offset += 3U) {
@@ -48,6 +48,7 @@ typedef struct jlink {
 	uint32_t hw_version;           /* Hardware version */
 	uint32_t capabilities;         /* Bitfield of supported capabilities */
 	uint32_t available_interfaces; /* Bitfield of available interfaces */
+	uint32_t max_mem_block;        /* Free buffer space reported by the probe, 0 if unknown */
 
 	struct jlink_interface_frequency {
 		uint32_t base;            /* Base frequency of the interface */
@@ -62,12 +63,18 @@ jlink_s jlink;
 
 bool jlink_simple_query(const uint8_t command, void *const rx_buffer, const size_t rx_len)
 {
+	/* Any queued JTAG scans must reach the probe before a command that could observe their effects */
+	if (!jlink_jtag_flush())
+		return false;
 	return bmda_usb_transfer(
 			   bmda_probe_info.usb_link, &command, sizeof(command), rx_buffer, rx_len, JLINK_USB_TIMEOUT) >= 0;
 }
 
 bool jlink_simple_request_8(const uint8_t command, const uint8_t operation, void *const rx_buffer, const size_t rx_len)
 {
+	/* Any queued JTAG scans must reach the probe before a command that could observe their effects */
+	if (!jlink_jtag_flush())
+		return false;
 	const uint8_t request[2U] = {command, operation};
 	return bmda_usb_transfer(
 			   bmda_probe_info.usb_link, request, sizeof(request), rx_buffer, rx_len, JLINK_USB_TIMEOUT) >= 0;
@@ -76,6 +83,9 @@ bool jlink_simple_request_8(const uint8_t command, const uint8_t operation, void
 bool jlink_simple_request_16(
 	const uint8_t command, const uint16_t operation, void *const rx_buffer, const size_t rx_len)
 {
+	/* Any queued JTAG scans must reach the probe before a command that could observe their effects */
+	if (!jlink_jtag_flush())
+		return false;
 	uint8_t request[3U] = {command};
 	write_le2(request, 1U, operation);
 	return bmda_usb_transfer(
@@ -85,6 +95,9 @@ bool jlink_simple_request_16(
 bool jlink_simple_request_32(
 	const uint8_t command, const uint32_t operation, void *const rx_buffer, const size_t rx_len)
 {
+	/* Any queued JTAG scans must reach the probe before a command that could observe their effects */
+	if (!jlink_jtag_flush())
+		return false;
 	uint8_t request[5U] = {command};
 	write_le4(request, 1U, operation);
 	return bmda_usb_transfer(
@@ -119,14 +132,14 @@ bool jlink_transfer(const uint16_t clock_cycles, const uint8_t *const tms, const
 		return true;
 	/*
 	 * The max number of bits to transfer is one shy of 64kib, meaning byte_count tops out at 8kiB.
-	 * However, we impose an "artificial" limit that it's not allowed to exceed 512B (4096b)
-	 * as we shouldn't be generating anything larger anyway.
+	 * The probe has to hold both the request and the TDO response in its buffer though,
+	 * so the usable limit is whatever jlink_transfer_max_bytes() says it has room for.
 	 */
 	const size_t byte_count = (clock_cycles + 7U) >> 3U;
-	if (byte_count > 512U)
+	if (byte_count > jlink_transfer_max_bytes())
 		return false;
 	/* Allocate a stack buffer for the transfer */
-	uint8_t buffer[1028U] = {0};
+	uint8_t buffer[sizeof(jlink_io_transact_s) + (JLINK_IO_TRANSACTION_MAX_BYTES * 2U)] = {0};
 	/* The first 4 bytes define the parameters of the transaction, so map the transfer structure there */
 	jlink_io_transact_s *header = (jlink_io_transact_s *)buffer;
 	header->command = JLINK_CMD_IO_TRANSACTION;
@@ -150,21 +163,27 @@ bool jlink_transfer(const uint16_t clock_cycles, const uint8_t *const tms, const
 	return buffer[byte_count] == 0U;
 }
 
+size_t jlink_transfer_max_bytes(void)
+{
+	/* Without a report from the probe, stick to a size every J-Link we know of can handle */
+	if (jlink.max_mem_block < sizeof(jlink_io_transact_s) + (JLINK_IO_TRANSACTION_DEFAULT_BYTES * 3U))
+		return JLINK_IO_TRANSACTION_DEFAULT_BYTES;
+	/* Each byte of cycles needs a TMS and a TDI byte in and a TDO byte out */
+	const size_t byte_count = (jlink.max_mem_block - sizeof(jlink_io_transact_s)) / 3U;
+	return MIN(byte_count, JLINK_IO_TRANSACTION_MAX_BYTES);
+}
+
 bool jlink_transfer_fixed_tms(
 	const uint16_t clock_cycles, const bool final_tms, const uint8_t *const tdi, uint8_t *const tdo)
 {
 	if (!clock_cycles)
 		return true;
-	/*
-	 * The max number of bits to transfer is one shy of 64kib, meaning byte_count tops out at 8kiB.
-	 * However, we impose an "artificial" limit that it's not allowed to exceed 512B (4096b)
-	 * as we shouldn't be generating anything larger anyway.
-	 */
+	/* See jlink_transfer() for where this limit comes from */
 	const size_t byte_count = (clock_cycles + 7U) >> 3U;
-	if (byte_count > 512U)
+	if (byte_count > jlink_transfer_max_bytes())
 		return false;
 	/* Set up the buffer for TMS */
-	uint8_t tms[512U] = {0};
+	uint8_t tms[JLINK_IO_TRANSACTION_MAX_BYTES] = {0};
 	/* Figure out the position of the final bit in the sequence */
 	const size_t cycles = clock_cycles - 1U;
 	const size_t final_byte = cycles >> 3U;
@@ -329,6 +348,22 @@ static bool jlink_get_capabilities(void)
 	return true;
 }
 
+static bool jlink_get_max_mem_block(void)
+{
+	if (!(jlink.capabilities & JLINK_CAPABILITY_MAX_MEM_BLOCK))
+		return true;
+
+	uint8_t buffer[4U];
+	if (!jlink_simple_query(JLINK_CMD_INFO_GET_MAX_MEM_BLOCK, buffer, sizeof(buffer)))
+		return false;
+
+	jlink.max_mem_block = read_le4(buffer, 0);
+	DEBUG_INFO("Max memory block: %" PRIu32 " bytes, IO transactions of up to %zu bytes\n", jlink.max_mem_block,
+		jlink_transfer_max_bytes());
+
+	return true;
+}
+
 static inline bool jlink_interface_available(const uint8_t interface)
 {
 	return jlink.available_interfaces & (1U << interface);
@@ -605,7 +640,7 @@ bool jlink_init(void)
 		libusb_close(bmda_probe_info.usb_link->device_handle);
 		return false;
 	}
-	if (!jlink_get_capabilities() || !jlink_get_version() || !jlink_get_interfaces()) {
+	if (!jlink_get_capabilities() || !jlink_get_version() || !jlink_get_max_mem_block() || !jlink_get_interfaces()) {
 		DEBUG_ERROR("Failed to read J-Link information\n");
 		libusb_release_interface(bmda_probe_info.usb_link->device_handle, bmda_probe_info.usb_link->interface);
 		libusb_close(bmda_probe_info.usb_link->device_handle);
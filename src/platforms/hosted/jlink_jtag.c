@@ -34,6 +34,7 @@
 #include "jlink.h"
 #include "jlink_protocol.h"
 #include "cli.h"
+#include "buffer_utils.h"
 
 static void jlink_jtag_reset(void);
 static void jlink_jtag_tms_seq(uint32_t tms_states, size_t clock_cycles);
@@ -43,9 +44,63 @@ static bool jlink_jtag_next(bool tms, bool tdi);
 
 static const uint8_t jlink_switch_to_jtag_seq[9U] = {0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0xffU, 0x3cU, 0xe7U};
 
+/*
+ * Scan queue - scans that don't capture TDO are accumulated here rather than sent immediately,
+ * so that a whole IR/DR access goes out as a single JLINK_CMD_IO_TRANSACTION when the scan that
+ * needs TDO back (or anything else that talks to the probe) forces a flush.
+ */
+typedef struct jlink_jtag_queue {
+	uint8_t tms[JLINK_IO_TRANSACTION_MAX_BYTES];
+	uint8_t tdi[JLINK_IO_TRANSACTION_MAX_BYTES];
+	uint8_t tdo[JLINK_IO_TRANSACTION_MAX_BYTES];
+	size_t clock_cycles;
+} jlink_jtag_queue_s;
+
+static jlink_jtag_queue_s jlink_jtag_queue;
+
+static bool jlink_jtag_queue_fits(const size_t clock_cycles)
+{
+	return jlink_jtag_queue.clock_cycles + clock_cycles <= jlink_transfer_max_bytes() * 8U;
+}
+
+bool jlink_jtag_flush(void)
+{
+	const size_t clock_cycles = jlink_jtag_queue.clock_cycles;
+	if (!clock_cycles)
+		return true;
+	jlink_jtag_queue.clock_cycles = 0U;
+	DEBUG_PROBE("jlink_jtag_flush %zu clock cycles\n", clock_cycles);
+	return jlink_transfer(clock_cycles, jlink_jtag_queue.tms, jlink_jtag_queue.tdi, jlink_jtag_queue.tdo);
+}
+
+/*
+ * Append a scan to the queue, flushing what's already there first if it won't fit.
+ * Returns the cycle offset of the new scan within the queue, which is where its TDO will land.
+ * tms may be NULL, in which case TMS is held low for all but the last cycle which is set to final_tms.
+ */
+static size_t jlink_jtag_queue_scan(
+	const uint8_t *const tms, const bool final_tms, const uint8_t *const tdi, const size_t clock_cycles)
+{
+	if (!jlink_jtag_queue_fits(clock_cycles) && !jlink_jtag_flush())
+		raise_exception(EXCEPTION_ERROR, "jlink_jtag_flush failed");
+	const size_t offset = jlink_jtag_queue.clock_cycles;
+	if (tms)
+		copy_bits(jlink_jtag_queue.tms, offset, tms, 0U, clock_cycles);
+	else {
+		for (size_t bit = offset; bit < offset + clock_cycles; ++bit)
+			jlink_jtag_queue.tms[bit >> 3U] &= ~(1U << (bit & 7U));
+		const size_t final_bit = offset + clock_cycles - 1U;
+		jlink_jtag_queue.tms[final_bit >> 3U] |= (final_tms ? 1U : 0U) << (final_bit & 7U);
+	}
+	copy_bits(jlink_jtag_queue.tdi, offset, tdi, 0U, clock_cycles);
+	jlink_jtag_queue.clock_cycles += clock_cycles;
+	return offset;
+}
+
 bool jlink_jtag_init(void)
 {
 	DEBUG_PROBE("-> jlink_jtag_init\n");
+	jlink_jtag_queue.clock_cycles = 0U;
 
 	/* Try to switch the adaptor into JTAG mode */
 	if (!jlink_select_interface(JLINK_INTERFACE_JTAG)) {
@@ -77,43 +132,64 @@ static void jlink_jtag_reset(void)
 static void jlink_jtag_tms_seq(const uint32_t tms_states, const size_t clock_cycles)
 {
 	/* Ensure the transaction's not too long */
-	if (clock_cycles > 32U)
+	if (clock_cycles > 32U || !clock_cycles)
 		return;
 	DEBUG_PROBE("jtagtap_tms_seq 0x%08" PRIx32 ", clock cycles: %zu\n", tms_states, clock_cycles);
 	/* Set up a buffer for tms_states to make sure the values are in the proper order */
 	uint8_t tms[4] = {0};
 	for (size_t cycle = 0; cycle < clock_cycles; cycle += 8U)
 		tms[cycle >> 3U] = (tms_states >> cycle) & 0xffU;
-	/* Attempt the transaction, check for errors and raise an exception if there is one */
-	if (!jlink_transfer(clock_cycles, tms, tms, NULL))
-		raise_exception(EXCEPTION_ERROR, "tagtap_tms_seq failed");
+	/* Nothing comes back from a TMS sequence, so it can wait in the queue */
+	jlink_jtag_queue_scan(tms, false, tms, clock_cycles);
 }
 
 static void jlink_jtag_tdi_tdo_seq(
 	uint8_t *const data_out, const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
 {
-	const bool result = jlink_transfer_fixed_tms(clock_cycles, final_tms, data_in, data_out);
-	DEBUG_PROBE("jtagtap_tdi_tdo_seq %zu, %02x -> %02x\n", clock_cycles, data_in[0], data_out ? data_out[0] : 0U);
-	if (!result)
+	if (!data_out) {
+		jlink_jtag_tdi_seq(final_tms, data_in, clock_cycles);
+		return;
+	}
+	if (!clock_cycles)
+		return;
+	/* Scans too big to ever fit the queue go straight to the probe, after everything ahead of them */
+	if (clock_cycles > jlink_transfer_max_bytes() * 8U) {
+		const bool result = jlink_jtag_flush() && jlink_transfer_fixed_tms(clock_cycles, final_tms, data_in, data_out);
+		DEBUG_PROBE("jtagtap_tdi_tdo_seq %zu, %02x -> %02x\n", clock_cycles, data_in[0], data_out[0]);
+		if (!result)
+			raise_exception(EXCEPTION_ERROR, "jtagtap_tdi_tdo_seq failed");
+		return;
+	}
+	/* The caller needs TDO on return, so queue the scan and send it along with everything ahead of it */
+	const size_t offset = jlink_jtag_queue_scan(NULL, final_tms, data_in, clock_cycles);
+	if (!jlink_jtag_flush())
 		raise_exception(EXCEPTION_ERROR, "jtagtap_tdi_tdo_seq failed");
+	copy_bits(data_out, 0U, jlink_jtag_queue.tdo, offset, clock_cycles);
+	DEBUG_PROBE("jtagtap_tdi_tdo_seq %zu, %02x -> %02x\n", clock_cycles, data_in[0], data_out[0]);
 }
 
 static void jlink_jtag_tdi_seq(const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
 {
-	const bool result = jlink_transfer_fixed_tms(clock_cycles, final_tms, data_in, NULL);
+	if (!clock_cycles)
+		return;
 	DEBUG_PROBE("jtagtap_tdi_seq %zu, %02x\n", clock_cycles, data_in[0]);
-	if (!result)
-		raise_exception(EXCEPTION_ERROR, "jtagtap_tdi_seq failed");
+	if (clock_cycles > jlink_transfer_max_bytes() * 8U) {
+		if (!jlink_jtag_flush() || !jlink_transfer_fixed_tms(clock_cycles, final_tms, data_in, NULL))
+			raise_exception(EXCEPTION_ERROR, "jtagtap_tdi_seq failed");
+		return;
+	}
+	jlink_jtag_queue_scan(NULL, final_tms, data_in, clock_cycles);
 }
 
-static bool jlink_jtag_next(bool tms, bool tdi)
+static bool jlink_jtag_next(const bool tms, const bool tdi)
 {
 	const uint8_t tms_byte = tms ? 1 : 0;
 	const uint8_t tdi_byte = tdi ? 1 : 0;
+	const size_t offset = jlink_jtag_queue_scan(&tms_byte, tms, &tdi_byte, 1U);
+	if (!jlink_jtag_flush())
+		raise_exception(EXCEPTION_ERROR, "jtagtap_next failed");
 	uint8_t tdo = 0;
-	const bool result = jlink_transfer(1U, &tms_byte, &tdi_byte, &tdo);
+	copy_bits(&tdo, 0U, jlink_jtag_queue.tdo, offset, 1U);
 	DEBUG_PROBE("jtagtap_next tms=%u tdi=%u tdo=%u\n", tms_byte, tdi_byte, tdo);
-	if (!result)
-		raise_exception(EXCEPTION_ERROR, "jtagtap_next failed");
 	return tdo;
 }
@@ -339,6 +339,13 @@
 /* J-Link USB protocol constants */
 #define JLINK_USB_TIMEOUT 5000U /* 5 seconds */
 
+/*
+ * JLINK_CMD_IO_TRANSACTION sizing - the cycle count is 16-bit, so the TMS and TDI vectors top out at 8kiB each,
+ * the default is used for probes that can't tell us how much buffer space they have
+ */
+#define JLINK_IO_TRANSACTION_MAX_BYTES     8191U
+#define JLINK_IO_TRANSACTION_DEFAULT_BYTES 512U
+
 /* 
  * J-Link USB Product-Id assignment
  *
@@ -516,6 +523,8 @@ bool jlink_simple_request_32(uint8_t command, uint32_t operation, void *rx_buffe
 bool jlink_transfer(uint16_t clock_cycles, const uint8_t *tms, const uint8_t *tdi, uint8_t *tdo);
 bool jlink_transfer_fixed_tms(uint16_t clock_cycles, bool final_tms, const uint8_t *tdi, uint8_t *tdo);
 bool jlink_transfer_swd(uint16_t clock_cycles, jlink_swd_dir_e direction, const uint8_t *data_in, uint8_t *data_out);
+size_t jlink_transfer_max_bytes(void);
+bool jlink_jtag_flush(void);
 bool jlink_select_interface(const uint8_t interface);
 
 #endif /*PLATFORMS_HOSTED_JLINK_PROTOCOL_H*/
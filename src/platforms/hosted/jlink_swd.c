@@ -109,7 +109,7 @@ bool jlink_swd_init(adiv5_debug_port_s *dp)
 
 static void jlink_swd_seq_out(const uint32_t tms_states, const size_t clock_cycles)
 {
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, tms_states);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, tms_states);
 	/* Encode the sequence data appropriately */
 	uint8_t data[4];
 	write_le4(data, 0, tms_states);
@@ -122,7 +122,7 @@ static void jlink_swd_seq_out(const uint32_t tms_states, const size_t clock_cycl
 
 static void jlink_swd_seq_out_parity(const uint32_t tms_states, const size_t clock_cycles)
 {
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, tms_states);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, tms_states);
 	/* Encode the sequence data appropriately */
 	uint8_t data[5] = {0};
 	write_le4(data, 0, tms_states);
@@ -148,7 +148,7 @@ static uint32_t jlink_swd_seq_in(const size_t clock_cycles)
 	}
 	/* Everything went well, so now convert the result and return it */
 	const uint32_t result = read_le4(data_out, 0);
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, result);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, result);
 	return result;
 }
 
@@ -170,7 +170,10 @@ static bool jlink_swd_seq_in_parity(uint32_t *const result, const size_t clock_c
 	uint8_t parity = __builtin_parity(data) & 1U;
 	parity ^= (data_out[byte] >> bit) & 1U;
 	/* Retrn the result of the calculation */
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 " %s\n", __func__, clock_cycles, data, parity ? "ERR" : "OK");
+	if (parity)
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_ERR, __func__, (uint32_t)clock_cycles, data);
+	else
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_OK, __func__, (uint32_t)clock_cycles, data);
 	*result = data;
 	return !parity;
 }
@@ -384,10 +387,10 @@ static uint32_t jlink_adiv5_raw_access(
 	/* Dispatch based on whether we should read or write */
 	if (rnw) {
 		const uint32_t result_value = jlink_adiv5_raw_read(dp);
-		DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, result_value);
+		DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, result_value);
 		return result_value;
 	}
 	const uint32_t result_value = jlink_adiv5_raw_write(request_value);
-	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, request_value);
+	DEBUG_TRACE_FN(PROBE_REG_WRITE, __func__, addr, request_value);
 	return result_value;
 }
@@ -46,6 +46,8 @@
 
 #include "bmp_remote.h"
 #include "bmp_hosted.h"
+#include "transaction_log.h"
+#include "traceswo.h"
 #if HOSTED_BMP_ONLY == 0
 #include "stlinkv2.h"
 #include "ftdi_bmp.h"
@@ -67,6 +69,7 @@ void gdb_ident(char *p, int count)
 
 static void exit_function(void)
 {
+	traceswo_deinit();
 #if HOSTED_BMP_ONLY == 0
 	if (bmda_probe_info.type == PROBE_TYPE_STLINK_V2)
 		stlink_deinit();
@@ -88,6 +91,8 @@ static void exit_function(void)
 #ifdef ENABLE_RTT
 	rtt_if_exit();
 #endif
+	transaction_log_close();
+	bmda_trace_flush();
 #if HOSTED_BMP_ONLY == 0
 	if (bmda_probe_info.libusb_ctx)
 		libusb_exit(bmda_probe_info.libusb_ctx);
@@ -108,11 +113,19 @@ void platform_init(int argc, char **argv)
 	SetConsoleOutputCP(CP_UTF8);
 #endif
 	cl_init(&cl_opts, argc, argv);
+	traceswo_set_output(cl_opts.opt_swo_output);
+	traceswo_set_clock(cl_opts.opt_trace_clock);
 	atexit(exit_function);
 	signal(SIGTERM, sigterm_handler);
 	signal(SIGINT, sigterm_handler);
 
-	if (cl_opts.opt_device)
+	if (cl_opts.opt_analyse_log)
+		exit(transaction_log_analyse(cl_opts.opt_analyse_log) ? 0 : 1);
+
+	if (cl_opts.opt_replay_log) {
+		if (!transaction_log_replay_open(cl_opts.opt_replay_log, &bmda_probe_info))
+			exit(1);
+	} else if (cl_opts.opt_device)
 		bmda_probe_info.type = PROBE_TYPE_BMP;
 	else if (find_debuggers(&cl_opts, &bmda_probe_info))
 		exit(1);
@@ -150,10 +163,17 @@ void platform_init(int argc, char **argv)
 		break;
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		break;
+
 	default:
 		exit(1);
 	}
 
+	if (cl_opts.opt_record_log && !cl_opts.opt_replay_log &&
+		!transaction_log_record_open(cl_opts.opt_record_log, &bmda_probe_info))
+		exit(1);
+
 	if (cl_opts.opt_mode != BMP_MODE_DEBUG)
 		exit(cl_execute(&cl_opts));
 	else {
@@ -182,16 +202,16 @@ bool bmda_swd_scan(const uint32_t targetid)
 		return stlink_swd_scan();
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		return transaction_log_replay_swd_scan(targetid);
+
 	default:
 		return false;
 	}
 }
 
-bool bmda_swd_dp_init(adiv5_debug_port_s *dp)
+static bool bmda_probe_swd_dp_init(adiv5_debug_port_s *dp)
 {
-#if HOSTED_BMP_ONLY == 1
-	(void)dp;
-#endif
 	switch (bmda_probe_info.type) {
 	case PROBE_TYPE_BMP:
 		return remote_swd_init();
@@ -210,11 +230,24 @@ bool bmda_swd_dp_init(adiv5_debug_port_s *dp)
 		return ftdi_swd_init();
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		return transaction_log_replay_swd_init(dp);
+
 	default:
 		return false;
 	}
 }
 
+bool bmda_swd_dp_init(adiv5_debug_port_s *dp)
+{
+	if (!bmda_probe_swd_dp_init(dp))
+		return false;
+	/* If we're recording, hook the probe's SWD and DP routines now they're set up */
+	transaction_log_record_swd();
+	transaction_log_record_dp(dp);
+	return true;
+}
+
 void bmda_add_jtag_dev(const uint32_t dev_index, const jtag_dev_s *const jtag_dev)
 {
 	if (bmda_probe_info.type == PROBE_TYPE_BMP)
@@ -239,12 +272,15 @@ bool bmda_jtag_scan(void)
 		return stlink_jtag_scan();
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		return jtag_scan();
+
 	default:
 		return false;
 	}
 }
 
-bool bmda_jtag_init(void)
+static bool bmda_probe_jtag_init(void)
 {
 	switch (bmda_probe_info.type) {
 	case PROBE_TYPE_BMP:
@@ -264,11 +300,22 @@ bool bmda_jtag_init(void)
 		return dap_jtag_init();
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		return transaction_log_replay_jtag_init();
+
 	default:
 		return false;
 	}
 }
 
+bool bmda_jtag_init(void)
+{
+	if (!bmda_probe_jtag_init())
+		return false;
+	transaction_log_record_jtag();
+	return true;
+}
+
 void bmda_adiv5_dp_init(adiv5_debug_port_s *const dp)
 {
 	switch (bmda_probe_info.type) {
@@ -290,27 +337,42 @@ void bmda_adiv5_dp_init(adiv5_debug_port_s *const dp)
 		break;
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		transaction_log_replay_dp_init(dp);
+		break;
+
 	default:
 		break;
 	}
+	transaction_log_record_dp(dp);
 }
 
 void bmda_jtag_dp_init(adiv5_debug_port_s *dp)
 {
-#if HOSTED_BMP_ONLY == 0
 	switch (bmda_probe_info.type) {
+#if HOSTED_BMP_ONLY == 0
 	case PROBE_TYPE_STLINK_V2:
 		stlink_jtag_dp_init(dp);
 		break;
 	case PROBE_TYPE_CMSIS_DAP:
 		dap_jtag_dp_init(dp);
 		break;
+#endif
+	case PROBE_TYPE_REPLAY:
+		transaction_log_replay_dp_init(dp);
+		break;
 	default:
 		break;
 	}
-#else
-	(void)dp;
-#endif
+	transaction_log_record_dp(dp);
+}
+
+probe_type_e bmda_probe_type(void)
+{
+	/* When replaying a log, behave as the probe the log was recorded with would have */
+	if (bmda_probe_info.type == PROBE_TYPE_REPLAY)
+		return transaction_log_replay_probe_type();
+	return bmda_probe_info.type;
 }
 
 char *bmda_adaptor_ident(void)
@@ -334,6 +396,9 @@ char *bmda_adaptor_ident(void)
 	case PROBE_TYPE_JLINK:
 		return "J-Link";
 
+	case PROBE_TYPE_REPLAY:
+		return "Replay";
+
 	default:
 		return NULL;
 	}
@@ -441,6 +506,9 @@ void platform_max_frequency_set(uint32_t freq)
 		break;
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		break;
+
 	default:
 		DEBUG_WARN("Setting max SWD/JTAG frequency not yet implemented\n");
 		break;
@@ -476,6 +544,9 @@ uint32_t platform_max_frequency_get(void)
 		return jlink_max_frequency_get();
 #endif
 
+	case PROBE_TYPE_REPLAY:
+		return FREQ_FIXED;
+
 	default:
 		DEBUG_WARN("Reading max SWJ frequency not yet implemented\n");
 		return 0;
@@ -558,10 +629,39 @@ void platform_buffer_flush(void)
 	}
 }
 
+/* How often the target is checked for having halted while it runs */
+#define PLATFORM_HALT_POLL_INTERVAL_MS 8U
+
+/* Earliest wake-up requested by a poll loop consumer since the last pace, if any */
+static platform_timeout_s poll_deadline;
+static bool poll_deadline_valid = false;
+
+void platform_poll_schedule(const platform_timeout_s *const deadline)
+{
+	if (!poll_deadline_valid || deadline->time < poll_deadline.time) {
+		poll_deadline = *deadline;
+		poll_deadline_valid = true;
+	}
+}
+
 void platform_pace_poll(void)
 {
-	if (!cl_opts.fast_poll)
-		platform_delay(8);
+	/* The target is idle, so now is a good time to format out anything traced since the last poll */
+	bmda_trace_flush();
+	if (cl_opts.fast_poll) {
+		poll_deadline_valid = false;
+		return;
+	}
+
+	/*
+	 * Halt polling is just another consumer of the schedule, asking to run every 8ms. If something
+	 * else (RTT, for example) asked to run sooner than that, only sleep until that's due instead.
+	 */
+	platform_timeout_s halt_poll;
+	platform_timeout_set(&halt_poll, PLATFORM_HALT_POLL_INTERVAL_MS);
+	platform_poll_schedule(&halt_poll);
+	poll_deadline_valid = false;
+	platform_delay_us((uint32_t)platform_timeout_remaining_us(&poll_deadline));
 }
 
 void platform_target_clk_output_enable(const bool enable)
@@ -666,7 +766,7 @@ static void decode_ap_access(const uint8_t ap, const uint8_t addr)
 		DEBUG_PROTO("Reserved(%02x): ", addr);
 }
 
-static void decode_access(const uint16_t addr, const uint8_t rnw, const uint8_t apsel, const uint32_t value)
+void bmda_decode_adiv5_access(const uint16_t addr, const uint8_t rnw, const uint8_t apsel, const uint32_t value)
 {
 	if (rnw)
 		DEBUG_PROTO("Read ");
@@ -681,81 +781,70 @@ static void decode_access(const uint16_t addr, const uint8_t rnw, const uint8_t
 
 void adiv5_dp_write(adiv5_debug_port_s *dp, uint16_t addr, uint32_t value)
 {
-	decode_access(addr, ADIV5_LOW_WRITE, 0U, value);
-	DEBUG_PROTO("0x%08" PRIx32 "\n", value);
+	DEBUG_TRACE(ADIV5_ACCESS, addr, ADIV5_LOW_WRITE, 0U, value);
 	dp->low_access(dp, ADIV5_LOW_WRITE, addr, value);
 }
 
 uint32_t adiv5_dp_read(adiv5_debug_port_s *dp, uint16_t addr)
 {
 	uint32_t ret = dp->dp_read(dp, addr);
-	decode_access(addr, ADIV5_LOW_READ, 0U, 0U);
-	DEBUG_PROTO("0x%08" PRIx32 "\n", ret);
+	DEBUG_TRACE(ADIV5_ACCESS, addr, ADIV5_LOW_READ, 0U, ret);
 	return ret;
 }
 
 uint32_t adiv5_dp_error(adiv5_debug_port_s *dp)
 {
 	uint32_t ret = dp->error(dp, false);
-	DEBUG_PROTO("DP Error 0x%08" PRIx32 "\n", ret);
+	DEBUG_TRACE(ADIV5_DP_ERROR, ret);
 	return ret;
 }
 
 uint32_t adiv5_dp_low_access(adiv5_debug_port_s *dp, uint8_t rnw, uint16_t addr, uint32_t value)
 {
 	uint32_t ret = dp->low_access(dp, rnw, addr, value);
-	decode_access(addr, rnw, 0U, value);
-	DEBUG_PROTO("0x%08" PRIx32 "\n", rnw ? ret : value);
+	DEBUG_TRACE(ADIV5_ACCESS, addr, rnw, 0U, rnw ? ret : value);
 	return ret;
 }
 
 uint32_t adiv5_ap_read(adiv5_access_port_s *ap, uint16_t addr)
 {
 	uint32_t ret = ap->dp->ap_read(ap, addr);
-	decode_access(addr, ADIV5_LOW_READ, ap->apsel, 0U);
-	DEBUG_PROTO("0x%08" PRIx32 "\n", ret);
+	DEBUG_TRACE(ADIV5_ACCESS, addr, ADIV5_LOW_READ, ap->apsel, ret);
 	return ret;
 }
 
 void adiv5_ap_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value)
 {
-	decode_access(addr, ADIV5_LOW_WRITE, ap->apsel, value);
-	DEBUG_PROTO("0x%08" PRIx32 "\n", value);
+	DEBUG_TRACE(ADIV5_ACCESS, addr, ADIV5_LOW_WRITE, ap->apsel, value);
 	ap->dp->ap_write(ap, addr, value);
 }
 
 void adiv5_mem_read(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len)
 {
 	ap->dp->mem_read(ap, dest, src, len);
-	DEBUG_PROTO("ap_memread @ %" PRIx32 " len %zu:", src, len);
-	const uint8_t *const data = (const uint8_t *)dest;
-	for (size_t offset = 0; offset < len; ++offset) {
-		if (offset == 16U)
-			break;
-		DEBUG_PROTO(" %02x", data[offset]);
-	}
-	if (len > 16U)
-		DEBUG_PROTO(" ...");
-	DEBUG_PROTO("\n");
+	DEBUG_TRACE_DATA(ADIV5_MEM_READ, NULL, dest, len, src, (uint32_t)len);
 }
 
 void adiv5_mem_write_sized(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align)
 {
-	DEBUG_PROTO("ap_mem_write_sized @ %" PRIx32 " len %zu, align %d:", dest, len, 1 << align);
-	const uint8_t *const data = (const uint8_t *)src;
-	for (size_t offset = 0; offset < len; ++offset) {
-		if (offset == 16U)
-			break;
-		DEBUG_PROTO(" %02x", data[offset]);
-	}
-	if (len > 16U)
-		DEBUG_PROTO(" ...");
-	DEBUG_PROTO("\n");
+	DEBUG_TRACE_DATA(ADIV5_MEM_WRITE, NULL, src, len, dest, (uint32_t)len, 1U << align);
 	ap->dp->mem_write(ap, dest, src, len, align);
 }
 
+void adiv5_mem_read_fifo(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align)
+{
+	ap->dp->mem_read_fifo(ap, dest, src, len, align);
+	DEBUG_TRACE_DATA(ADIV5_FIFO_READ, NULL, dest, len, src, (uint32_t)len, 1U << align);
+}
+
+void adiv5_mem_write_fifo(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align)
+{
+	DEBUG_TRACE_DATA(ADIV5_FIFO_WRITE, NULL, src, len, dest, (uint32_t)len, 1U << align);
+	ap->dp->mem_write_fifo(ap, dest, src, len, align);
+}
+
 void adiv5_dp_abort(adiv5_debug_port_s *dp, uint32_t abort)
 {
-	DEBUG_PROTO("Abort: %08" PRIx32 "\n", abort);
+	DEBUG_TRACE(ADIV5_DP_ABORT, abort);
 	dp->abort(dp, abort);
 }
@@ -48,6 +48,8 @@ void platform_buffer_flush(void);
 	do {                 \
 	} while (0)
 #define PLATFORM_HAS_POWER_SWITCH
+#define PLATFORM_HAS_TRACESWO
+#define TRACESWO_PROTOCOL 2
 
 #define PRODUCT_ID_ANY 0xffffU
 
@@ -83,7 +85,8 @@ typedef enum probe_type {
 	PROBE_TYPE_STLINK_V2,
 	PROBE_TYPE_FTDI,
 	PROBE_TYPE_CMSIS_DAP,
-	PROBE_TYPE_JLINK
+	PROBE_TYPE_JLINK,
+	PROBE_TYPE_REPLAY
 } probe_type_e;
 
 void gdb_ident(char *p, int count);
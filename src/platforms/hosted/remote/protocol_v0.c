@@ -122,5 +122,7 @@ static bool remote_v0_plus_adiv5_init(adiv5_debug_port_s *const dp)
 	dp->ap_write = remote_v0_adiv5_ap_write;
 	dp->mem_read = remote_v0_adiv5_mem_read_bytes;
 	dp->mem_write = remote_v0_adiv5_mem_write_bytes;
+	dp->mem_read_fifo = adiv5_ap_mem_read_fifo;
+	dp->mem_write_fifo = adiv5_ap_mem_write_fifo;
 	return true;
 }
@@ -48,7 +48,7 @@ uint32_t remote_v0_swd_seq_in(size_t clock_cycles)
 		exit(-1);
 	}
 	const uint32_t result = remote_hex_string_to_num(-1, buffer + 1);
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, result);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, result);
 	return result;
 }
 
@@ -66,8 +66,10 @@ bool remote_v0_swd_seq_in_parity(uint32_t *result, size_t clock_cycles)
 	}
 
 	*result = remote_hex_string_to_num(-1, buffer + 1);
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 " %s\n", __func__, clock_cycles, *result,
-		buffer[0] != REMOTE_RESP_OK ? "ERR" : "OK");
+	if (buffer[0] != REMOTE_RESP_OK)
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_ERR, __func__, (uint32_t)clock_cycles, *result);
+	else
+		DEBUG_TRACE_FN(SWD_SEQ_PARITY_OK, __func__, (uint32_t)clock_cycles, *result);
 	return buffer[0] != REMOTE_RESP_OK;
 }
 
@@ -75,7 +77,7 @@ void remote_v0_swd_seq_out(uint32_t value, size_t clock_cycles)
 {
 	char buffer[REMOTE_MAX_MSG_SIZE];
 
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, value);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, value);
 	int length = sprintf(buffer, REMOTE_SWD_OUT_STR, clock_cycles, value);
 	platform_buffer_write(buffer, length);
 
@@ -90,7 +92,7 @@ void remote_v0_swd_seq_out_parity(uint32_t value, size_t clock_cycles)
 {
 	char buffer[REMOTE_MAX_MSG_SIZE];
 
-	DEBUG_PROBE("%s %zu clock_cycles: %08" PRIx32 "\n", __func__, clock_cycles, value);
+	DEBUG_TRACE_FN(SWD_SEQ, __func__, (uint32_t)clock_cycles, value);
 	int length = sprintf(buffer, REMOTE_SWD_OUT_PAR_STR, clock_cycles, value);
 	platform_buffer_write(buffer, length);
 
@@ -96,7 +96,7 @@ uint32_t remote_v1_adiv5_dp_read(adiv5_debug_port_s *const dp, const uint16_t ad
 	/* If the response indicates all's OK, decode the data read and return it */
 	uint32_t value = 0U;
 	unhexify(&value, buffer + 1, 4);
-	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, value);
 	return value;
 }
 
@@ -113,7 +113,7 @@ uint32_t remote_v1_adiv5_ap_read(adiv5_access_port_s *const ap, const uint16_t a
 	/* If the response indicates all's OK, decode the data read and return it */
 	uint32_t value = 0U;
 	unhexify(&value, buffer + 1, 4);
-	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, value);
 	return value;
 }
 
@@ -128,7 +128,7 @@ void remote_v1_adiv5_ap_write(adiv5_access_port_s *const ap, const uint16_t addr
 	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
 	if (!remote_adiv5_check_error(__func__, buffer, length))
 		return;
-	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_WRITE, __func__, addr, value);
 }
 
 void remote_v1_adiv5_mem_read_bytes(
@@ -61,5 +61,7 @@ bool remote_v3_adiv5_init(adiv5_debug_port_s *const dp)
 	dp->ap_write = remote_v3_adiv5_ap_write;
 	dp->mem_read = remote_v3_adiv5_mem_read_bytes;
 	dp->mem_write = remote_v3_adiv5_mem_write_bytes;
+	dp->mem_read_fifo = adiv5_ap_mem_read_fifo;
+	dp->mem_write_fifo = adiv5_ap_mem_write_fifo;
 	return true;
 }
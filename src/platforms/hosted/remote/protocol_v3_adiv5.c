@@ -106,7 +106,7 @@ uint32_t remote_v3_adiv5_dp_read(adiv5_debug_port_s *const dp, const uint16_t ad
 	/* If the response indicates all's OK, decode the data read and return it */
 	uint32_t value = 0U;
 	unhexify(&value, buffer + 1, 4);
-	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, value);
 	return value;
 }
 
@@ -123,7 +123,7 @@ uint32_t remote_v3_adiv5_ap_read(adiv5_access_port_s *const ap, const uint16_t a
 	/* If the response indicates all's OK, decode the data read and return it */
 	uint32_t value = 0U;
 	unhexify(&value, buffer + 1, 4);
-	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, value);
 	return value;
 }
 
@@ -138,7 +138,16 @@ void remote_v3_adiv5_ap_write(adiv5_access_port_s *const ap, const uint16_t addr
 	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
 	if (!remote_adiv5_check_error(__func__, ap->dp, buffer, length))
 		return;
-	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_WRITE, __func__, addr, value);
+}
+
+static void remote_v3_adiv5_mem_read_request(adiv5_access_port_s *const ap, const uint32_t src, const size_t amount)
+{
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	/* Create the request and send it to the remote */
+	const ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_ADIv5_MEM_READ_STR, ap->dp->dev_index,
+		ap->apsel, ap->csw, src, amount);
+	platform_buffer_write(buffer, length);
 }
 
 void remote_v3_adiv5_mem_read_bytes(
@@ -155,19 +164,27 @@ void remote_v3_adiv5_mem_read_bytes(
 	 * there are 2 leader bytes around responses and the data is hex-encoded taking 2 bytes a byte
 	 */
 	const size_t blocksize = (REMOTE_MAX_MSG_SIZE - 2U) / 2U;
-	/* For each transfer block size, ask the firmware to read that block of bytes */
+	/*
+	 * For each transfer block size, ask the firmware to read that block of bytes. The request for the next
+	 * block is always sent before waiting on the response for the current one, so the firmware can get on
+	 * with it while the current response makes its way back to us and is decoded.
+	 */
+	remote_v3_adiv5_mem_read_request(ap, src, MIN(read_length, blocksize));
 	for (size_t offset = 0; offset < read_length; offset += blocksize) {
 		/* Pick the amount left to read or the block size, whichever is smaller */
 		const size_t amount = MIN(read_length - offset, blocksize);
-		/* Create the request and send it to the remote */
-		ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_ADIv5_MEM_READ_STR, ap->dp->dev_index, ap->apsel,
-			ap->csw, src + offset, amount);
-		platform_buffer_write(buffer, length);
+		const size_t next_offset = offset + blocksize;
+		const bool next_requested = next_offset < read_length;
+		if (next_requested)
+			remote_v3_adiv5_mem_read_request(ap, src + next_offset, MIN(read_length - next_offset, blocksize));
 
 		/* Read back the answer and check for errors */
-		length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+		const ssize_t length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
 		if (!remote_adiv5_check_error(__func__, ap->dp, buffer, length)) {
 			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)src + offset);
+			/* Consume the response to the request already in flight so we stay in step with the firmware */
+			if (next_requested)
+				platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
 			return;
 		}
 		/* If the response indicates all's OK, decode the data read */
@@ -207,7 +207,7 @@ void serial_close(void)
 
 bool platform_buffer_write(const void *const data, const size_t length)
 {
-	DEBUG_WIRE("%s\n", (const char *)data);
+	DEBUG_TRACE_DATA(REMOTE_TX, NULL, data, length, 0U);
 	const ssize_t written = write(fd, data, length);
 	if (written < 0) {
 		const int error = errno;
@@ -270,7 +270,7 @@ int platform_buffer_read(void *const data, size_t length)
 		char *const buffer = (char *)data;
 		if (buffer[offset] == REMOTE_EOM) {
 			buffer[offset] = 0;
-			DEBUG_WIRE("       %s\n", buffer);
+			DEBUG_TRACE_DATA(REMOTE_RX, NULL, buffer, offset, 0U);
 			return offset;
 		}
 		++offset;
@@ -230,7 +230,7 @@ void serial_close(void)
 bool platform_buffer_write(const void *const data, const size_t length)
 {
 	const char *const buffer = (const char *)data;
-	DEBUG_WIRE("%s\n", buffer);
+	DEBUG_TRACE_DATA(REMOTE_TX, NULL, buffer, length, 0U);
 	DWORD written = 0;
 	for (size_t offset = 0; offset < length; offset += written) {
 		if (!WriteFile(port_handle, buffer + offset, length - offset, &written, NULL)) {
@@ -269,10 +269,9 @@ int platform_buffer_read(void *const data, const size_t length)
 			exit(-3);
 		}
 		if (read > 0) {
-			DEBUG_WIRE("%c", buffer[offset]);
 			if (buffer[offset] == REMOTE_EOM) {
 				buffer[offset] = 0;
-				DEBUG_WIRE("\n");
+				DEBUG_TRACE_DATA(REMOTE_RX, NULL, buffer, offset, 0U);
 				return offset;
 			}
 			++offset;
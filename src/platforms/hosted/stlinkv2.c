@@ -35,6 +35,8 @@
 #include "exception.h"
 #include "cortexm.h"
 #include "buffer_utils.h"
+#include "traceswo.h"
+#include "gdb_packet.h"
 
 #include <assert.h>
 #include <unistd.h>
@@ -85,6 +87,7 @@ typedef struct stlink {
 static stlink_s stlink;
 
 static uint32_t stlink_v2_divisor;
+static bool stlink_trace_active = false;
 static unsigned int stlink_v3_freq[2];
 
 static int stlink_usb_get_rw_status(bool verbose);
@@ -639,9 +642,9 @@ uint32_t stlink_raw_access(adiv5_debug_port_s *dp, uint8_t rnw, uint16_t addr, u
 	}
 
 	if (rnw)
-		DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, result_value);
+		DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, result_value);
 	else
-		DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, request_value);
+		DEBUG_TRACE_FN(PROBE_REG_WRITE, __func__, addr, request_value);
 	return result_value;
 }
 
@@ -800,7 +803,7 @@ static void stlink_reg_write(adiv5_access_port_s *const ap, const uint8_t reg_nu
 
 static void stlink_ap_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value)
 {
-	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_WRITE, __func__, addr, value);
 	stlink_write_dp_register(ap->apsel, addr, value);
 }
 
@@ -808,7 +811,7 @@ static uint32_t stlink_ap_read(adiv5_access_port_s *ap, uint16_t addr)
 {
 	uint32_t value = 0;
 	stlink_read_dp_register(ap->dp, ap->apsel, addr, &value);
-	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	DEBUG_TRACE_FN(PROBE_REG_READ, __func__, addr, value);
 	return value;
 }
 
@@ -821,6 +824,8 @@ void stlink_adiv5_dp_init(adiv5_debug_port_s *dp)
 	dp->ap_read = stlink_ap_read;
 	dp->mem_read = stlink_mem_read;
 	dp->mem_write = stlink_mem_write;
+	dp->mem_read_fifo = adiv5_ap_mem_read_fifo;
+	dp->mem_write_fifo = adiv5_ap_mem_write_fifo;
 }
 
 static void stlink_v2_set_frequency(const uint32_t freq)
@@ -913,3 +918,45 @@ uint32_t stlink_max_frequency_get(void)
 		return STLINK_V2_CPU_CLOCK_FREQ / (STLINK_V2_JTAG_MUL_FACTOR * stlink_v2_divisor);
 	return STLINK_V2_CPU_CLOCK_FREQ / (STLINK_V2_SWD_MUL_FACTOR * (stlink_v2_divisor + 1U));
 }
+
+bool stlink_swo_init(const uint32_t baudrate)
+{
+	stlink_swo_deinit();
+	/* The adaptor samples SWO with a UART, so can only do NRZ and only up to a hardware-specific rate */
+	const uint32_t max_baudrate = stlink.ver_hw == 30U ? STLINK_V3_TRACE_MAX_HZ : STLINK_TRACE_MAX_HZ;
+	const uint32_t actual_baudrate = MIN(baudrate, max_baudrate);
+	if (actual_baudrate != baudrate)
+		gdb_outf("ST-Link can capture SWO at up to %" PRIu32 " baud, using that instead\n", max_baudrate);
+	traceswo_target_setup(actual_baudrate, false);
+
+	stlink_trace_start_s request = {
+		.command = STLINK_DEBUG_COMMAND,
+		.operation = STLINK_DEBUG_APIV2_START_TRACE_RX,
+	};
+	write_le2(request.buffer_size, 0U, STLINK_TRACE_SIZE);
+	write_le4(request.baudrate, 0U, actual_baudrate);
+	uint8_t data[2];
+	bmda_usb_transfer(bmda_probe_info.usb_link, &request, sizeof(request), data, sizeof(data), BMDA_USB_NO_TIMEOUT);
+	if (stlink_usb_error_check(data, true) != STLINK_ERROR_OK)
+		return false;
+
+	const uint8_t endpoint = stlink.ver_hw == 20U ? STLINK_V2_TRACE_EP : STLINK_TRACE_EP;
+	if (!traceswo_usb_start(bmda_probe_info.usb_link->device_handle, endpoint, STLINK_TRACE_SIZE)) {
+		stlink_simple_query(STLINK_DEBUG_COMMAND, STLINK_DEBUG_APIV2_STOP_TRACE_RX, data, sizeof(data));
+		return false;
+	}
+	stlink_trace_active = true;
+	DEBUG_INFO("ST-Link SWO capture started at %" PRIu32 " baud\n", actual_baudrate);
+	return true;
+}
+
+void stlink_swo_deinit(void)
+{
+	if (!stlink_trace_active)
+		return;
+	traceswo_usb_stop();
+	uint8_t data[2];
+	stlink_simple_query(STLINK_DEBUG_COMMAND, STLINK_DEBUG_APIV2_STOP_TRACE_RX, data, sizeof(data));
+	stlink_usb_error_check(data, true);
+	stlink_trace_active = false;
+}
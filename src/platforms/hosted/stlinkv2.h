@@ -45,5 +45,7 @@ void stlink_jtag_dp_init(adiv5_debug_port_s *dp);
 void stlink_exit_function(bmda_probe_s *info);
 void stlink_max_frequency_set(uint32_t freq);
 uint32_t stlink_max_frequency_get(void);
+bool stlink_swo_init(uint32_t baudrate);
+void stlink_swo_deinit(void);
 
 #endif /* PLATFORMS_HOSTED_STLINKV2_H */
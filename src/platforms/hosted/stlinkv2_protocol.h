@@ -145,8 +145,13 @@
 #define STLINK_DEBUG_APIV2_DRIVE_NRST_HIGH  0x01U
 #define STLINK_DEBUG_APIV2_DRIVE_NRST_PULSE 0x02U
 
-#define STLINK_TRACE_SIZE   4096U
-#define STLINK_TRACE_MAX_HZ 2000000U
+#define STLINK_TRACE_SIZE      4096U
+#define STLINK_TRACE_MAX_HZ    2000000U
+#define STLINK_V3_TRACE_MAX_HZ 24000000U
+
+/* The trace endpoint is EP3 on the original ST-Link/V2, and EP2 from V2-1 on */
+#define STLINK_V2_TRACE_EP 3U
+#define STLINK_TRACE_EP    2U
 
 #define STLINK_V3_FREQ_ENTRY_COUNT 10U
 
@@ -224,6 +229,14 @@ typedef struct stlink_v3_set_freq {
 	uint8_t reserved2[8];
 } stlink_v3_set_freq_s;
 
+typedef struct stlink_trace_start {
+	uint8_t command;
+	uint8_t operation;
+	uint8_t buffer_size[2];
+	uint8_t baudrate[4];
+	uint8_t reserved[8];
+} stlink_trace_start_s;
+
 int stlink_simple_query(uint8_t command, uint8_t operation, void *rx_buffer, size_t rx_len);
 int stlink_simple_request(uint8_t command, uint8_t operation, uint8_t param, void *rx_buffer, size_t rx_len);
 int stlink_send_recv_retry(const void *req_buffer, size_t req_len, void *rx_buffer, size_t rx_len);
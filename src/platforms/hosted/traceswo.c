@@ -0,0 +1,452 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements the host side of SWO trace capture: it routes a traceswo request to the probe's
+ * capture backend, sets the target's ITM and TPIU up to match, decodes the ITM stream the backend feeds
+ * back, and writes the result to stdout, a file, or a TCP socket. It also provides the asynchronous USB
+ * endpoint capture shared by the backends of probes with a dedicated trace endpoint.
+ */
+
+#include "general.h"
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+#define WIN32_LEAN_AND_MEAN
+#include <ws2tcpip.h>
+#include <winsock2.h>
+
+typedef SOCKET socket_t;
+#else
+#include <sys/socket.h>
+#include <netdb.h>
+#include <unistd.h>
+
+typedef int32_t socket_t;
+#define INVALID_SOCKET (-1)
+
+static inline int closesocket(const int s)
+{
+	return close(s);
+}
+#endif
+
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "gdb_packet.h"
+#include "gdb_main.h"
+#include "target_internal.h"
+#include "cortexm.h"
+#include "bmp_hosted.h"
+#include "traceswo.h"
+#if HOSTED_BMP_ONLY == 0
+#include "cmsis_dap.h"
+#include "stlinkv2.h"
+#endif
+
+typedef struct addrinfo addrinfo_s;
+
+#define TRACESWO_DECODE_BUFFER_SIZE 4096U
+
+#define ITM_BASE             CORTEXM_PPB_BASE
+#define ITM_TER              (ITM_BASE + 0xe00U)
+#define ITM_TPR              (ITM_BASE + 0xe40U)
+#define ITM_TCR              (ITM_BASE + 0xe80U)
+#define ITM_LAR              (ITM_BASE + 0xfb0U)
+#define ITM_TCR_ITMENA       (1U << 0U)
+#define ITM_TCR_SYNCENA      (1U << 2U)
+#define ITM_TCR_BUSID(x)     ((x) << 16U)
+#define CORESIGHT_LAR_KEY    0xc5acce55U
+#define TPIU_BASE            (CORTEXM_PPB_BASE + 0x40000U)
+#define TPIU_ACPR            (TPIU_BASE + 0x010U)
+#define TPIU_SPPR            (TPIU_BASE + 0x0f0U)
+#define TPIU_FFCR            (TPIU_BASE + 0x304U)
+#define TPIU_SPPR_MANCHESTER 1U
+#define TPIU_SPPR_NRZ        2U
+#define TPIU_FFCR_TRIGIN     (1U << 8U)
+
+#define TRACESWO_USB_TRANSFERS 4U
+/* How long the event loop waits before checking if it's been asked to stop */
+#define TRACESWO_USB_EVENT_TIMEOUT_US 100000U
+
+static const char *traceswo_destination = NULL;
+static uint32_t traceswo_clock = 0U;
+static FILE *traceswo_file = NULL;
+static socket_t traceswo_socket = INVALID_SOCKET;
+static bool traceswo_active = false;
+
+/* ITM decoder state, only touched from the context the backend delivers data in */
+static uint32_t swo_decode = 0; /* bitmask of channels to print */
+static uint8_t swo_payload_remaining = 0;
+static bool swo_print = false;
+static bool swo_continuation = false;
+static uint8_t swo_buffer[TRACESWO_DECODE_BUFFER_SIZE];
+
+void traceswo_set_output(const char *const destination)
+{
+	traceswo_destination = destination;
+}
+
+void traceswo_set_clock(const uint32_t frequency)
+{
+	traceswo_clock = frequency;
+}
+
+static bool traceswo_output_is_stdout(void)
+{
+	return !traceswo_destination || strcmp(traceswo_destination, "-") == 0;
+}
+
+static socket_t traceswo_connect(const char *const destination)
+{
+	/* The destination is of the form HOST:PORT, with the port being after the last ':' to allow for IPv6 */
+	const char *const separator = strrchr(destination, ':');
+	if (!separator || separator == destination || !separator[1])
+		return INVALID_SOCKET;
+	const size_t host_length = (size_t)(separator - destination);
+	char host[256];
+	if (host_length >= sizeof(host))
+		return INVALID_SOCKET;
+	memcpy(host, destination, host_length);
+	host[host_length] = '\0';
+
+	addrinfo_s hints = {0};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	addrinfo_s *results = NULL;
+	if (getaddrinfo(host, separator + 1, &hints, &results) || !results)
+		return INVALID_SOCKET;
+
+	socket_t result = INVALID_SOCKET;
+	for (const addrinfo_s *address = results; address && result == INVALID_SOCKET; address = address->ai_next) {
+		result = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (result == INVALID_SOCKET)
+			continue;
+		if (connect(result, address->ai_addr, address->ai_addrlen) != 0) {
+			closesocket(result);
+			result = INVALID_SOCKET;
+		}
+	}
+	freeaddrinfo(results);
+	return result;
+}
+
+static bool traceswo_output_open(void)
+{
+	if (traceswo_output_is_stdout())
+		return true;
+	if (strncmp(traceswo_destination, "tcp:", 4U) == 0) {
+		traceswo_socket = traceswo_connect(traceswo_destination + 4U);
+		if (traceswo_socket == INVALID_SOCKET) {
+			DEBUG_ERROR("Could not connect to SWO output %s\n", traceswo_destination);
+			return false;
+		}
+		return true;
+	}
+	traceswo_file = fopen(traceswo_destination, "wb");
+	if (!traceswo_file) {
+		DEBUG_ERROR("Could not open SWO output file %s\n", traceswo_destination);
+		return false;
+	}
+	return true;
+}
+
+static void traceswo_output_close(void)
+{
+	if (traceswo_socket != INVALID_SOCKET) {
+		closesocket(traceswo_socket);
+		traceswo_socket = INVALID_SOCKET;
+	}
+	if (traceswo_file) {
+		fclose(traceswo_file);
+		traceswo_file = NULL;
+	}
+}
+
+static void traceswo_write(const uint8_t *const data, const size_t length)
+{
+	if (!length)
+		return;
+	if (traceswo_socket != INVALID_SOCKET) {
+		for (size_t offset = 0; offset < length;) {
+			const int sent = send(traceswo_socket, (const char *)data + offset, (int)(length - offset), 0);
+			if (sent <= 0) {
+				DEBUG_WARN("SWO output connection lost, discarding further trace data\n");
+				closesocket(traceswo_socket);
+				traceswo_socket = INVALID_SOCKET;
+				return;
+			}
+			offset += (size_t)sent;
+		}
+		return;
+	}
+	FILE *const file = traceswo_file ? traceswo_file : stdout;
+	fwrite(data, 1U, length, file);
+	fflush(file);
+}
+
+/*
+ * Decode a chunk of ITM stream, keeping only the payloads of software (stimulus port) source packets
+ * for the selected channels. Sync, overflow, timestamp, extension and hardware source packets are dropped.
+ */
+static size_t traceswo_decode(const uint8_t *const data, const size_t length, uint8_t *const result)
+{
+	size_t result_length = 0U;
+	for (size_t i = 0; i < length; ++i) {
+		const uint8_t byte = data[i];
+		if (swo_payload_remaining) {
+			if (swo_print)
+				result[result_length++] = byte;
+			--swo_payload_remaining;
+		} else if (swo_continuation) {
+			/* Timestamp and extension packets continue for as long as bit 7 is set */
+			swo_continuation = byte & 0x80U;
+		} else if (byte & 0x03U) {
+			/* Source packet, the bottom 2 bits encode a payload size of 1, 2 or 4 bytes */
+			swo_payload_remaining = 1U << ((byte & 0x03U) - 1U);
+			swo_print = !(byte & 0x04U) && (swo_decode & (1U << (byte >> 3U)));
+		} else if (byte != 0x80U)
+			/* Protocol packet - the sync packet terminator is the only one with bit 7 set and no payload */
+			swo_continuation = byte & 0x80U;
+	}
+	return result_length;
+}
+
+void traceswo_data(const uint8_t *const data, const size_t length)
+{
+	/* With decoding off, the raw stream is passed straight through */
+	if (!swo_decode) {
+		traceswo_write(data, length);
+		return;
+	}
+	for (size_t offset = 0; offset < length; offset += TRACESWO_DECODE_BUFFER_SIZE) {
+		const size_t amount = MIN(length - offset, TRACESWO_DECODE_BUFFER_SIZE);
+		traceswo_write(swo_buffer, traceswo_decode(data + offset, amount, swo_buffer));
+	}
+}
+
+/*
+ * Set the attached Cortex-M's ITM up to emit stimulus port writes and its TPIU to output them over SWO at
+ * the rate the probe is capturing at. This needs the TPIU reference clock, so is only done when that's known.
+ */
+void traceswo_target_setup(const uint32_t baudrate, const bool manchester)
+{
+	target_s *const target = cur_target;
+	if (!traceswo_clock || !target || target->attach != cortexm_attach) {
+		DEBUG_INFO("Not configuring target ITM and TPIU, the firmware must set SWO up for %" PRIu32 " baud\n",
+			baudrate);
+		return;
+	}
+	const uint32_t prescaler = (traceswo_clock + (baudrate / 2U)) / baudrate;
+	if (!prescaler) {
+		gdb_outf("Trace clock %" PRIu32 "Hz is too low for %" PRIu32 " baud\n", traceswo_clock, baudrate);
+		return;
+	}
+	target_mem_write32(target, CORTEXM_DEMCR, target_mem_read32(target, CORTEXM_DEMCR) | CORTEXM_DEMCR_TRCENA);
+	target_mem_write32(target, TPIU_SPPR, manchester ? TPIU_SPPR_MANCHESTER : TPIU_SPPR_NRZ);
+	target_mem_write32(target, TPIU_ACPR, prescaler - 1U);
+	/* Bypass the formatter so the ITM stream comes out as-is */
+	target_mem_write32(target, TPIU_FFCR, TPIU_FFCR_TRIGIN);
+	target_mem_write32(target, ITM_LAR, CORESIGHT_LAR_KEY);
+	target_mem_write32(target, ITM_TCR, ITM_TCR_ITMENA | ITM_TCR_SYNCENA | ITM_TCR_BUSID(1U));
+	target_mem_write32(target, ITM_TPR, 0U);
+	target_mem_write32(target, ITM_TER, swo_decode ? swo_decode : 0xffffffffU);
+	if (target_check_error(target))
+		gdb_out("Failed to configure the target's ITM and TPIU for trace\n");
+	else if (traceswo_clock / prescaler != baudrate)
+		gdb_outf("Target SWO rate is %" PRIu32 " baud, which may not be accurate enough to capture reliably\n",
+			traceswo_clock / prescaler);
+}
+
+#if HOSTED_BMP_ONLY == 0
+static libusb_context *traceswo_usb_context = NULL;
+static pthread_t traceswo_usb_thread;
+static atomic_bool traceswo_usb_running = false;
+static struct libusb_transfer *traceswo_usb_transfers[TRACESWO_USB_TRANSFERS];
+/*
+ * Completion callbacks run on whichever thread is handling libusb events, either the trace thread or the
+ * main thread during its synchronous transfers, so the count of transfers in flight is atomic.
+ */
+static atomic_size_t traceswo_usb_active = 0U;
+
+static void LIBUSB_CALL traceswo_usb_transfer_complete(struct libusb_transfer *const transfer)
+{
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+		traceswo_data(transfer->buffer, (size_t)transfer->actual_length);
+		/* Put the transfer straight back in flight so the endpoint is never left unserviced */
+		if (atomic_load(&traceswo_usb_running) && libusb_submit_transfer(transfer) == LIBUSB_SUCCESS)
+			return;
+	} else if (transfer->status != LIBUSB_TRANSFER_CANCELLED)
+		DEBUG_WARN("SWO trace transfer failed (%d)\n", transfer->status);
+	atomic_fetch_sub(&traceswo_usb_active, 1U);
+}
+
+static void *traceswo_usb_events(void *const arg)
+{
+	(void)arg;
+	bool cancelled = false;
+	while (atomic_load(&traceswo_usb_active)) {
+		if (!cancelled && !atomic_load(&traceswo_usb_running)) {
+			for (size_t i = 0; i < TRACESWO_USB_TRANSFERS; ++i) {
+				if (traceswo_usb_transfers[i])
+					libusb_cancel_transfer(traceswo_usb_transfers[i]);
+			}
+			cancelled = true;
+		}
+		struct timeval timeout = {.tv_sec = 0, .tv_usec = TRACESWO_USB_EVENT_TIMEOUT_US};
+		libusb_handle_events_timeout_completed(traceswo_usb_context, &timeout, NULL);
+	}
+	return NULL;
+}
+
+static void traceswo_usb_free_transfers(void)
+{
+	for (size_t i = 0; i < TRACESWO_USB_TRANSFERS; ++i) {
+		if (!traceswo_usb_transfers[i])
+			continue;
+		free(traceswo_usb_transfers[i]->buffer);
+		libusb_free_transfer(traceswo_usb_transfers[i]);
+		traceswo_usb_transfers[i] = NULL;
+	}
+}
+
+static bool traceswo_usb_submit_transfers(
+	libusb_device_handle *const handle, const uint8_t endpoint, const size_t transfer_size)
+{
+	for (size_t i = 0; i < TRACESWO_USB_TRANSFERS; ++i) {
+		struct libusb_transfer *const transfer = libusb_alloc_transfer(0);
+		uint8_t *const buffer = malloc(transfer_size);
+		if (!transfer || !buffer) {
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			free(buffer);
+			libusb_free_transfer(transfer);
+			return false;
+		}
+		libusb_fill_bulk_transfer(transfer, handle, endpoint | LIBUSB_ENDPOINT_IN, buffer, (int)transfer_size,
+			traceswo_usb_transfer_complete, NULL, 0U);
+		traceswo_usb_transfers[i] = transfer;
+		const int result = libusb_submit_transfer(transfer);
+		if (result != LIBUSB_SUCCESS) {
+			DEBUG_ERROR("SWO trace transfer submission failed: %s\n", libusb_strerror(result));
+			return false;
+		}
+		atomic_fetch_add(&traceswo_usb_active, 1U);
+	}
+	return true;
+}
+
+bool traceswo_usb_start(libusb_device_handle *const handle, const uint8_t endpoint, const size_t transfer_size)
+{
+	traceswo_usb_context = bmda_probe_info.libusb_ctx;
+	atomic_store(&traceswo_usb_running, true);
+	if (traceswo_usb_submit_transfers(handle, endpoint, transfer_size) &&
+		pthread_create(&traceswo_usb_thread, NULL, traceswo_usb_events, NULL) == 0)
+		return true;
+	/* Let the event loop reap anything that did get submitted before cleaning up */
+	DEBUG_ERROR("Failed to start SWO trace capture\n");
+	atomic_store(&traceswo_usb_running, false);
+	traceswo_usb_events(NULL);
+	traceswo_usb_free_transfers();
+	return false;
+}
+
+void traceswo_usb_stop(void)
+{
+	if (!atomic_load(&traceswo_usb_running))
+		return;
+	atomic_store(&traceswo_usb_running, false);
+	pthread_join(traceswo_usb_thread, NULL);
+	traceswo_usb_free_transfers();
+}
+#endif
+
+static bool traceswo_backend_init(const uint32_t baudrate)
+{
+	switch (bmda_probe_info.type) {
+#if HOSTED_BMP_ONLY == 0
+	case PROBE_TYPE_CMSIS_DAP:
+		return dap_swo_init(baudrate);
+	case PROBE_TYPE_STLINK_V2:
+		return stlink_swo_init(baudrate);
+#endif
+	default:
+		(void)baudrate;
+		gdb_out("SWO trace capture is not supported by this probe\n");
+		return false;
+	}
+}
+
+static void traceswo_backend_deinit(void)
+{
+	switch (bmda_probe_info.type) {
+#if HOSTED_BMP_ONLY == 0
+	case PROBE_TYPE_CMSIS_DAP:
+		dap_swo_deinit();
+		break;
+	case PROBE_TYPE_STLINK_V2:
+		stlink_swo_deinit();
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+void traceswo_init(const uint32_t baudrate, const uint32_t swo_chan_bitmask)
+{
+	/* Restarting trace with new settings needs the old capture shut down first */
+	traceswo_deinit();
+
+	swo_decode = swo_chan_bitmask;
+	swo_payload_remaining = 0U;
+	swo_print = false;
+	swo_continuation = false;
+
+	if (!traceswo_output_open())
+		return;
+	if (!traceswo_backend_init(baudrate)) {
+		traceswo_output_close();
+		return;
+	}
+	traceswo_active = true;
+	gdb_outf("Trace enabled, writing to %s\n", traceswo_output_is_stdout() ? "stdout" : traceswo_destination);
+}
+
+void traceswo_deinit(void)
+{
+	if (!traceswo_active)
+		return;
+	traceswo_backend_deinit();
+	traceswo_output_close();
+	traceswo_active = false;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PLATFORMS_HOSTED_TRACESWO_H
+#define PLATFORMS_HOSTED_TRACESWO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#if HOSTED_BMP_ONLY == 0
+#include <libusb.h>
+#endif
+
+/* Default line rate, used as default for a request without baudrate */
+#define SWO_DEFAULT_BAUD 2250000U
+
+/* Set where captured trace goes: NULL or "-" for stdout, "tcp:HOST:PORT" for a socket, else a file path */
+void traceswo_set_output(const char *destination);
+/* Set the target's TPIU reference clock, which enables ITM/TPIU setup when trace is started */
+void traceswo_set_clock(uint32_t frequency);
+void traceswo_init(uint32_t baudrate, uint32_t swo_chan_bitmask);
+void traceswo_deinit(void);
+
+/* Called from a probe's capture thread with each chunk of raw SWO data received */
+void traceswo_data(const uint8_t *data, size_t length);
+
+/* Called by a probe's backend once it knows the line rate it'll capture at, to set the target up to match */
+void traceswo_target_setup(uint32_t baudrate, bool manchester);
+
+#if HOSTED_BMP_ONLY == 0
+/* Stream trace from a dedicated USB endpoint into traceswo_data() using a ring of asynchronous bulk transfers */
+bool traceswo_usb_start(libusb_device_handle *handle, uint8_t endpoint, size_t transfer_size);
+void traceswo_usb_stop(void);
+#endif
+
+#endif /* PLATFORMS_HOSTED_TRACESWO_H */
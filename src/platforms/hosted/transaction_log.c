@@ -0,0 +1,1212 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements recording, replay and analysis of the transactions BMDA performs with a probe.
+ *
+ * Recording works by interposing on the swd_proc and jtag_proc tables and on each DP's function table,
+ * so everything the rest of BMDA asks of the probe is captured regardless of which probe backend is in use.
+ * Calls nest (a DP memory read may be built from AP accesses, which are built from SWD sequences), so each
+ * transaction records how deeply it is nested, and transactions are written to the log as they complete.
+ *
+ * The log consists of a header followed by fixed size transaction records, each optionally followed by
+ * a payload. All values are little endian.
+ *
+ * Header:
+ *   8 bytes  "BMDATLOG"
+ *   2 bytes  format version
+ *   1 byte   probe type the log was recorded with
+ *   1 byte   reserved
+ *   1 byte   product string length, followed by the string
+ *   1 byte   version string length, followed by the string
+ *
+ * Transaction record:
+ *   1 byte   operation
+ *   1 byte   nesting depth (0 for calls made directly by BMDA)
+ *   1 byte   flags
+ *   1 byte   AP number
+ *   4 bytes  duration in microseconds
+ *   8 bytes  start time in microseconds since the log was opened
+ *   4 bytes  address (register address, memory address or number of clock cycles)
+ *   4 bytes  value (value written, TMS states or number of bytes for memory operations)
+ *   4 bytes  result (value read, or the exception type if the operation raised one)
+ *   4 bytes  payload length (data read, or the exception message if the operation raised one)
+ *
+ * Replay serves the outermost (depth 0) transactions back in order, checking that each request
+ * matches what was recorded, and runs on a virtual clock driven by the recorded timestamps so that
+ * timeouts behave just as they did when the log was made.
+ */
+
+#include "general.h"
+#include <errno.h>
+#include "exception.h"
+#include "buffer_utils.h"
+#include "jtagtap.h"
+#include "swd.h"
+#include "target.h"
+#include "target_internal.h"
+#include "adiv5.h"
+#include "bmp_hosted.h"
+#include "transaction_log.h"
+
+#define TRANSACTION_LOG_MAGIC        "BMDATLOG"
+#define TRANSACTION_LOG_MAGIC_LENGTH 8U
+#define TRANSACTION_LOG_VERSION      1U
+#define TRANSACTION_RECORD_SIZE      32U
+
+#define TRANSACTION_FLAG_EXCEPTION (1U << 0U)
+#define TRANSACTION_FLAG_RNW       (1U << 1U)
+#define TRANSACTION_FLAG_FINAL_TMS (1U << 2U)
+#define TRANSACTION_FLAG_DATA_OUT  (1U << 3U)
+
+/* Number of registers the ST-Link register block read returns */
+#define TRANSACTION_CORE_REGS_SIZE (21U * 4U)
+
+typedef enum transaction_op {
+	TRANSACTION_OP_SWD_SEQ_IN,
+	TRANSACTION_OP_SWD_SEQ_IN_PARITY,
+	TRANSACTION_OP_SWD_SEQ_OUT,
+	TRANSACTION_OP_SWD_SEQ_OUT_PARITY,
+	TRANSACTION_OP_JTAG_RESET,
+	TRANSACTION_OP_JTAG_NEXT,
+	TRANSACTION_OP_JTAG_TMS_SEQ,
+	TRANSACTION_OP_JTAG_TDI_TDO_SEQ,
+	TRANSACTION_OP_JTAG_TDI_SEQ,
+	TRANSACTION_OP_JTAG_CYCLE,
+	TRANSACTION_OP_DP_LOW_WRITE,
+	TRANSACTION_OP_DP_READ,
+	TRANSACTION_OP_DP_ERROR,
+	TRANSACTION_OP_DP_LOW_ACCESS,
+	TRANSACTION_OP_DP_ABORT,
+	TRANSACTION_OP_AP_READ,
+	TRANSACTION_OP_AP_WRITE,
+	TRANSACTION_OP_MEM_READ,
+	TRANSACTION_OP_MEM_WRITE,
+	TRANSACTION_OP_AP_REGS_READ,
+	TRANSACTION_OP_AP_REG_READ,
+	TRANSACTION_OP_AP_REG_WRITE,
+	TRANSACTION_OP_MEM_READ_FIFO,
+	TRANSACTION_OP_MEM_WRITE_FIFO,
+	TRANSACTION_OP_COUNT,
+} transaction_op_e;
+
+static const char *const transaction_op_names[TRANSACTION_OP_COUNT] = {
+	"swd_seq_in",
+	"swd_seq_in_parity",
+	"swd_seq_out",
+	"swd_seq_out_parity",
+	"jtag_reset",
+	"jtag_next",
+	"jtag_tms_seq",
+	"jtag_tdi_tdo_seq",
+	"jtag_tdi_seq",
+	"jtag_cycle",
+	"dp_low_write",
+	"dp_read",
+	"dp_error",
+	"dp_low_access",
+	"dp_abort",
+	"ap_read",
+	"ap_write",
+	"mem_read",
+	"mem_write",
+	"ap_regs_read",
+	"ap_reg_read",
+	"ap_reg_write",
+	"mem_read_fifo",
+	"mem_write_fifo",
+};
+
+typedef struct transaction {
+	uint8_t op;
+	uint8_t depth;
+	uint8_t flags;
+	uint8_t apsel;
+	uint32_t duration;
+	uint64_t start;
+	uint32_t addr;
+	uint32_t value;
+	uint32_t result;
+	uint32_t length;
+	const uint8_t *payload;
+} transaction_s;
+
+typedef struct transaction_log {
+	uint8_t *data;
+	transaction_s *transactions;
+	size_t count;
+	probe_type_e probe_type;
+	char product[256];
+	char version[256];
+} transaction_log_s;
+
+typedef struct record_dp {
+	adiv5_debug_port_s *dp;
+	/* Copy of the DP's function table as the probe backend set it up */
+	adiv5_debug_port_s original;
+} record_dp_s;
+
+static FILE *record_file = NULL;
+static uint64_t record_epoch;
+static uint8_t record_depth = 0;
+static swd_proc_s record_swd_proc;
+static jtag_proc_s record_jtag_proc;
+static bool (*record_dp_low_write_original)(uint16_t addr, uint32_t data);
+static record_dp_s *record_dps = NULL;
+static size_t record_dp_count = 0;
+
+static transaction_log_s replay_log;
+static bool replay_active = false;
+static size_t replay_index = 0;
+static uint64_t replay_now = 0;
+static char replay_exception_msg[256];
+
+/* If the probe backend (re)installed a function, take a copy of it and put the recording hook in its place */
+#define RECORD_WRAP(current, original, hook)            \
+	do {                                                \
+		if ((current) != NULL && (current) != (hook)) { \
+			(original) = (current);                     \
+			(current) = (hook);                         \
+		}                                               \
+	} while (0)
+
+static const char *transaction_op_name(const uint8_t op)
+{
+	if (op < TRANSACTION_OP_COUNT)
+		return transaction_op_names[op];
+	return "unknown";
+}
+
+static void transaction_encode(uint8_t *const buffer, const transaction_s *const transaction)
+{
+	buffer[0] = transaction->op;
+	buffer[1] = transaction->depth;
+	buffer[2] = transaction->flags;
+	buffer[3] = transaction->apsel;
+	write_le4(buffer, 4U, transaction->duration);
+	write_le4(buffer, 8U, (uint32_t)transaction->start);
+	write_le4(buffer, 12U, (uint32_t)(transaction->start >> 32U));
+	write_le4(buffer, 16U, transaction->addr);
+	write_le4(buffer, 20U, transaction->value);
+	write_le4(buffer, 24U, transaction->result);
+	write_le4(buffer, 28U, transaction->length);
+}
+
+static void transaction_decode(const uint8_t *const buffer, transaction_s *const transaction)
+{
+	transaction->op = buffer[0];
+	transaction->depth = buffer[1];
+	transaction->flags = buffer[2];
+	transaction->apsel = buffer[3];
+	transaction->duration = read_le4(buffer, 4U);
+	transaction->start = read_le4(buffer, 8U) | ((uint64_t)read_le4(buffer, 12U) << 32U);
+	transaction->addr = read_le4(buffer, 16U);
+	transaction->value = read_le4(buffer, 20U);
+	transaction->result = read_le4(buffer, 24U);
+	transaction->length = read_le4(buffer, 28U);
+	transaction->payload = buffer + TRANSACTION_RECORD_SIZE;
+}
+
+static void record_write_string(const char *const str)
+{
+	const uint8_t length = (uint8_t)MIN(strlen(str), UINT8_MAX);
+	fputc(length, record_file);
+	fwrite(str, 1, length, record_file);
+}
+
+bool transaction_log_record_open(const char *const path, const bmda_probe_s *const probe)
+{
+	record_file = fopen(path, "wb");
+	if (!record_file) {
+		DEBUG_ERROR("Failed to open transaction log %s for writing: %s\n", path, strerror(errno));
+		return false;
+	}
+	/* Transactions are small and frequent, so give the log a generous buffer to keep the overhead down */
+	setvbuf(record_file, NULL, _IOFBF, 1024U * 1024U);
+
+	uint8_t header[TRANSACTION_LOG_MAGIC_LENGTH + 4U];
+	memcpy(header, TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_LENGTH);
+	write_le2(header, TRANSACTION_LOG_MAGIC_LENGTH, TRANSACTION_LOG_VERSION);
+	header[TRANSACTION_LOG_MAGIC_LENGTH + 2U] = (uint8_t)probe->type;
+	header[TRANSACTION_LOG_MAGIC_LENGTH + 3U] = 0U;
+	fwrite(header, 1, sizeof(header), record_file);
+	record_write_string(probe->product);
+	record_write_string(probe->version);
+
+	record_epoch = platform_time_us();
+	DEBUG_INFO("Recording probe transactions to %s\n", path);
+	return true;
+}
+
+void transaction_log_close(void)
+{
+	if (record_file) {
+		fclose(record_file);
+		record_file = NULL;
+	}
+	free(record_dps);
+	record_dps = NULL;
+	record_dp_count = 0;
+	free(replay_log.transactions);
+	free(replay_log.data);
+	replay_log.transactions = NULL;
+	replay_log.data = NULL;
+	replay_active = false;
+}
+
+static uint64_t record_begin(void)
+{
+	++record_depth;
+	return platform_time_us();
+}
+
+static void record_end(transaction_s *const transaction, const uint64_t begin)
+{
+	const uint64_t end = platform_time_us();
+	--record_depth;
+	if (!record_file)
+		return;
+	transaction->depth = record_depth;
+	transaction->start = begin - record_epoch;
+	transaction->duration = (uint32_t)MIN(end - begin, UINT32_MAX);
+	if (!transaction->payload)
+		transaction->length = 0;
+
+	uint8_t buffer[TRANSACTION_RECORD_SIZE];
+	transaction_encode(buffer, transaction);
+	fwrite(buffer, 1, sizeof(buffer), record_file);
+	if (transaction->length)
+		fwrite(transaction->payload, 1, transaction->length, record_file);
+}
+
+/* Finish recording a transaction that might have raised an exception, and if it did, pass that on */
+static void record_end_checked(transaction_s *const transaction, const uint64_t begin, volatile exception_s *const error)
+{
+	if (error->type) {
+		transaction->flags |= TRANSACTION_FLAG_EXCEPTION;
+		transaction->result = error->type;
+		transaction->payload = (const uint8_t *)(error->msg ? error->msg : "");
+		transaction->length = strlen((const char *)transaction->payload);
+	}
+	record_end(transaction, begin);
+	if (error->type)
+		raise_exception(error->type, error->msg);
+}
+
+static const adiv5_debug_port_s *record_dp_original(const adiv5_debug_port_s *const dp)
+{
+	for (size_t idx = 0; idx < record_dp_count; ++idx) {
+		if (record_dps[idx].dp == dp)
+			return &record_dps[idx].original;
+	}
+	/* Can't happen - a DP only gets recording hooks after it's been registered */
+	DEBUG_ERROR("Transaction recording called for an unknown DP\n");
+	abort();
+}
+
+static uint32_t record_swd_seq_in(const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile uint32_t result = 0;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = record_swd_proc.seq_in(clock_cycles);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_SWD_SEQ_IN, .addr = clock_cycles, .result = result};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static bool record_swd_seq_in_parity(uint32_t *const ret, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile bool parity_error = false;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		parity_error = record_swd_proc.seq_in_parity(ret, clock_cycles);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_SWD_SEQ_IN_PARITY,
+		.addr = clock_cycles,
+		.value = parity_error,
+		.result = *ret,
+	};
+	record_end_checked(&transaction, begin, &error);
+	return parity_error;
+}
+
+static void record_swd_seq_out(const uint32_t tms_states, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_swd_proc.seq_out(tms_states, clock_cycles);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_SWD_SEQ_OUT, .addr = clock_cycles, .value = tms_states};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_swd_seq_out_parity(const uint32_t tms_states, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_swd_proc.seq_out_parity(tms_states, clock_cycles);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_SWD_SEQ_OUT_PARITY, .addr = clock_cycles, .value = tms_states};
+	record_end_checked(&transaction, begin, &error);
+}
+
+void transaction_log_record_swd(void)
+{
+	if (!record_file)
+		return;
+	RECORD_WRAP(swd_proc.seq_in, record_swd_proc.seq_in, record_swd_seq_in);
+	RECORD_WRAP(swd_proc.seq_in_parity, record_swd_proc.seq_in_parity, record_swd_seq_in_parity);
+	RECORD_WRAP(swd_proc.seq_out, record_swd_proc.seq_out, record_swd_seq_out);
+	RECORD_WRAP(swd_proc.seq_out_parity, record_swd_proc.seq_out_parity, record_swd_seq_out_parity);
+}
+
+static void record_jtag_reset(void)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_jtag_proc.jtagtap_reset();
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_JTAG_RESET};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static bool record_jtag_next(const bool tms, const bool tdi)
+{
+	const uint64_t begin = record_begin();
+	volatile bool tdo = false;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		tdo = record_jtag_proc.jtagtap_next(tms, tdi);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_JTAG_NEXT,
+		.value = (tms ? 1U : 0U) | (tdi ? 2U : 0U),
+		.result = tdo,
+	};
+	record_end_checked(&transaction, begin, &error);
+	return tdo;
+}
+
+static void record_jtag_tms_seq(const uint32_t tms_states, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_jtag_proc.jtagtap_tms_seq(tms_states, clock_cycles);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_JTAG_TMS_SEQ, .addr = clock_cycles, .value = tms_states};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_jtag_tdi_tdo_seq(
+	uint8_t *const data_out, const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_jtag_proc.jtagtap_tdi_tdo_seq(data_out, final_tms, data_in, clock_cycles);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_JTAG_TDI_TDO_SEQ,
+		.flags = (final_tms ? TRANSACTION_FLAG_FINAL_TMS : 0U) | (data_out ? TRANSACTION_FLAG_DATA_OUT : 0U),
+		.addr = clock_cycles,
+		.length = (clock_cycles + 7U) >> 3U,
+		.payload = data_out,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_jtag_tdi_seq(const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_jtag_proc.jtagtap_tdi_seq(final_tms, data_in, clock_cycles);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_JTAG_TDI_SEQ,
+		.flags = final_tms ? TRANSACTION_FLAG_FINAL_TMS : 0U,
+		.addr = clock_cycles,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_jtag_cycle(const bool tms, const bool tdi, const size_t clock_cycles)
+{
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		record_jtag_proc.jtagtap_cycle(tms, tdi, clock_cycles);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_JTAG_CYCLE,
+		.addr = clock_cycles,
+		.value = (tms ? 1U : 0U) | (tdi ? 2U : 0U),
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+void transaction_log_record_jtag(void)
+{
+	if (!record_file)
+		return;
+	RECORD_WRAP(jtag_proc.jtagtap_reset, record_jtag_proc.jtagtap_reset, record_jtag_reset);
+	RECORD_WRAP(jtag_proc.jtagtap_next, record_jtag_proc.jtagtap_next, record_jtag_next);
+	RECORD_WRAP(jtag_proc.jtagtap_tms_seq, record_jtag_proc.jtagtap_tms_seq, record_jtag_tms_seq);
+	RECORD_WRAP(jtag_proc.jtagtap_tdi_tdo_seq, record_jtag_proc.jtagtap_tdi_tdo_seq, record_jtag_tdi_tdo_seq);
+	RECORD_WRAP(jtag_proc.jtagtap_tdi_seq, record_jtag_proc.jtagtap_tdi_seq, record_jtag_tdi_seq);
+	RECORD_WRAP(jtag_proc.jtagtap_cycle, record_jtag_proc.jtagtap_cycle, record_jtag_cycle);
+}
+
+static bool record_dp_low_write(const uint16_t addr, const uint32_t data)
+{
+	const uint64_t begin = record_begin();
+	volatile bool result = false;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = record_dp_low_write_original(addr, data);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_DP_LOW_WRITE, .addr = addr, .value = data, .result = result};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static uint32_t record_dp_read(adiv5_debug_port_s *const dp, const uint16_t addr)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(dp);
+	const uint64_t begin = record_begin();
+	volatile uint32_t result = 0;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = original->dp_read(dp, addr);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_DP_READ, .addr = addr, .result = result};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static uint32_t record_dp_error(adiv5_debug_port_s *const dp, const bool protocol_recovery)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(dp);
+	const uint64_t begin = record_begin();
+	volatile uint32_t result = 0;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = original->error(dp, protocol_recovery);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_DP_ERROR, .value = protocol_recovery, .result = result};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static uint32_t record_dp_low_access(
+	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t value)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(dp);
+	const uint64_t begin = record_begin();
+	volatile uint32_t result = 0;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = original->low_access(dp, rnw, addr, value);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_DP_LOW_ACCESS,
+		.flags = rnw ? TRANSACTION_FLAG_RNW : 0U,
+		.addr = addr,
+		.value = value,
+		.result = result,
+	};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static void record_dp_abort(adiv5_debug_port_s *const dp, const uint32_t abort)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->abort(dp, abort);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_DP_ABORT, .value = abort};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static uint32_t record_ap_read(adiv5_access_port_s *const ap, const uint16_t addr)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile uint32_t result = 0;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = original->ap_read(ap, addr);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_AP_READ, .apsel = ap->apsel, .addr = addr, .result = result};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static void record_ap_write(adiv5_access_port_s *const ap, const uint16_t addr, const uint32_t value)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->ap_write(ap, addr, value);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_AP_WRITE, .apsel = ap->apsel, .addr = addr, .value = value};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_mem_read(adiv5_access_port_s *const ap, void *const dest, const uint32_t src, const size_t len)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->mem_read(ap, dest, src, len);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_MEM_READ,
+		.apsel = ap->apsel,
+		.addr = src,
+		.value = len,
+		.length = len,
+		.payload = dest,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_mem_write(
+	adiv5_access_port_s *const ap, const uint32_t dest, const void *const src, const size_t len, const align_e align)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->mem_write(ap, dest, src, len, align);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_MEM_WRITE,
+		.apsel = ap->apsel,
+		.addr = dest,
+		.value = len,
+		.result = align,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_mem_read_fifo(
+	adiv5_access_port_s *const ap, void *const dest, const uint32_t src, const size_t len, const align_e align)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->mem_read_fifo(ap, dest, src, len, align);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_MEM_READ_FIFO,
+		.apsel = ap->apsel,
+		.addr = src,
+		.value = len,
+		.result = align,
+		.length = len,
+		.payload = dest,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_mem_write_fifo(
+	adiv5_access_port_s *const ap, const uint32_t dest, const void *const src, const size_t len, const align_e align)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->mem_write_fifo(ap, dest, src, len, align);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_MEM_WRITE_FIFO,
+		.apsel = ap->apsel,
+		.addr = dest,
+		.value = len,
+		.result = align,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static void record_ap_regs_read(adiv5_access_port_s *const ap, void *const data)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->ap_regs_read(ap, data);
+	}
+	transaction_s transaction = {
+		.op = TRANSACTION_OP_AP_REGS_READ,
+		.apsel = ap->apsel,
+		.length = TRANSACTION_CORE_REGS_SIZE,
+		.payload = data,
+	};
+	record_end_checked(&transaction, begin, &error);
+}
+
+static uint32_t record_ap_reg_read(adiv5_access_port_s *const ap, const uint8_t reg_num)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile uint32_t result = 0;
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		result = original->ap_reg_read(ap, reg_num);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_AP_REG_READ, .apsel = ap->apsel, .addr = reg_num, .result = result};
+	record_end_checked(&transaction, begin, &error);
+	return result;
+}
+
+static void record_ap_reg_write(adiv5_access_port_s *const ap, const uint8_t num, const uint32_t value)
+{
+	const adiv5_debug_port_s *const original = record_dp_original(ap->dp);
+	const uint64_t begin = record_begin();
+	volatile exception_s error;
+	TRY_CATCH (error, EXCEPTION_ALL) {
+		original->ap_reg_write(ap, num, value);
+	}
+	transaction_s transaction = {.op = TRANSACTION_OP_AP_REG_WRITE, .apsel = ap->apsel, .addr = num, .value = value};
+	record_end_checked(&transaction, begin, &error);
+}
+
+void transaction_log_record_dp(adiv5_debug_port_s *const dp)
+{
+	if (!record_file)
+		return;
+
+	/* Find this DP's copy of its function table, making a new one if this is a DP we've not seen yet */
+	adiv5_debug_port_s *original = NULL;
+	for (size_t idx = 0; idx < record_dp_count; ++idx) {
+		if (record_dps[idx].dp == dp)
+			original = &record_dps[idx].original;
+	}
+	if (!original) {
+		record_dp_s *const dps = realloc(record_dps, sizeof(*record_dps) * (record_dp_count + 1U));
+		if (!dps) { /* realloc failed: heap exhaustion */
+			DEBUG_ERROR("realloc: failed in %s\n", __func__);
+			return;
+		}
+		record_dps = dps;
+		record_dps[record_dp_count].dp = dp;
+		original = &record_dps[record_dp_count++].original;
+		memset(original, 0, sizeof(*original));
+	}
+
+	RECORD_WRAP(dp->dp_low_write, record_dp_low_write_original, record_dp_low_write);
+	RECORD_WRAP(dp->dp_read, original->dp_read, record_dp_read);
+	RECORD_WRAP(dp->error, original->error, record_dp_error);
+	RECORD_WRAP(dp->low_access, original->low_access, record_dp_low_access);
+	RECORD_WRAP(dp->abort, original->abort, record_dp_abort);
+	RECORD_WRAP(dp->ap_read, original->ap_read, record_ap_read);
+	RECORD_WRAP(dp->ap_write, original->ap_write, record_ap_write);
+	RECORD_WRAP(dp->mem_read, original->mem_read, record_mem_read);
+	RECORD_WRAP(dp->mem_write, original->mem_write, record_mem_write);
+	RECORD_WRAP(dp->mem_read_fifo, original->mem_read_fifo, record_mem_read_fifo);
+	RECORD_WRAP(dp->mem_write_fifo, original->mem_write_fifo, record_mem_write_fifo);
+	RECORD_WRAP(dp->ap_regs_read, original->ap_regs_read, record_ap_regs_read);
+	RECORD_WRAP(dp->ap_reg_read, original->ap_reg_read, record_ap_reg_read);
+	RECORD_WRAP(dp->ap_reg_write, original->ap_reg_write, record_ap_reg_write);
+}
+
+static size_t log_read_string(const uint8_t *const data, const size_t size, size_t offset, char *const str)
+{
+	if (offset >= size)
+		return 0;
+	const size_t length = data[offset++];
+	if (offset + length > size)
+		return 0;
+	memcpy(str, data + offset, length);
+	str[length] = '\0';
+	return offset + length;
+}
+
+/* Load a transaction log into memory and index it */
+static bool log_load(const char *const path, transaction_log_s *const log)
+{
+	memset(log, 0, sizeof(*log));
+	FILE *const file = fopen(path, "rb");
+	if (!file) {
+		DEBUG_ERROR("Failed to open transaction log %s: %s\n", path, strerror(errno));
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	const long file_size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (file_size < (long)(TRANSACTION_LOG_MAGIC_LENGTH + 6U)) {
+		DEBUG_ERROR("%s is not a transaction log\n", path);
+		fclose(file);
+		return false;
+	}
+	const size_t size = (size_t)file_size;
+	log->data = malloc(size);
+	if (!log->data) { /* malloc failed: heap exhaustion */
+		DEBUG_ERROR("malloc: failed in %s\n", __func__);
+		fclose(file);
+		return false;
+	}
+	const size_t amount = fread(log->data, 1, size, file);
+	fclose(file);
+	if (amount != size) {
+		DEBUG_ERROR("Failed to read transaction log %s\n", path);
+		return false;
+	}
+
+	const uint8_t *const data = log->data;
+	if (memcmp(data, TRANSACTION_LOG_MAGIC, TRANSACTION_LOG_MAGIC_LENGTH) != 0 ||
+		read_le2(data, TRANSACTION_LOG_MAGIC_LENGTH) != TRANSACTION_LOG_VERSION) {
+		DEBUG_ERROR("%s is not a transaction log, or is from an incompatible version of BMDA\n", path);
+		return false;
+	}
+	log->probe_type = (probe_type_e)data[TRANSACTION_LOG_MAGIC_LENGTH + 2U];
+	size_t offset = log_read_string(data, size, TRANSACTION_LOG_MAGIC_LENGTH + 4U, log->product);
+	if (offset)
+		offset = log_read_string(data, size, offset, log->version);
+	if (!offset) {
+		DEBUG_ERROR("Transaction log %s has a truncated header\n", path);
+		return false;
+	}
+
+	/* Walk the records once to count them, then again to index them */
+	for (size_t pass = 0; pass < 2U; ++pass) {
+		size_t count = 0;
+		for (size_t position = offset; position < size; ++count) {
+			if (position + TRANSACTION_RECORD_SIZE > size ||
+				position + TRANSACTION_RECORD_SIZE + read_le4(data, position + 28U) > size) {
+				DEBUG_WARN("Transaction log %s is truncated, ignoring the incomplete record at the end\n", path);
+				break;
+			}
+			if (log->transactions)
+				transaction_decode(data + position, &log->transactions[count]);
+			position += TRANSACTION_RECORD_SIZE + read_le4(data, position + 28U);
+		}
+		if (pass == 0U) {
+			log->count = count;
+			log->transactions = calloc(count ? count : 1U, sizeof(*log->transactions));
+			if (!log->transactions) { /* calloc failed: heap exhaustion */
+				DEBUG_ERROR("calloc: failed in %s\n", __func__);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static void log_free(transaction_log_s *const log)
+{
+	free(log->transactions);
+	free(log->data);
+	log->transactions = NULL;
+	log->data = NULL;
+}
+
+bool transaction_log_replay_open(const char *const path, bmda_probe_s *const probe)
+{
+	if (!log_load(path, &replay_log)) {
+		log_free(&replay_log);
+		return false;
+	}
+	replay_active = true;
+	replay_index = 0;
+	replay_now = 0;
+
+	probe->type = PROBE_TYPE_REPLAY;
+	strncpy(probe->manufacturer, "Transaction log replay", sizeof(probe->manufacturer) - 1U);
+	strncpy(probe->product, replay_log.product, sizeof(probe->product) - 1U);
+	strncpy(probe->version, replay_log.version, sizeof(probe->version) - 1U);
+	DEBUG_INFO("Replaying %zu transactions recorded with %s %s\n", replay_log.count, replay_log.product,
+		replay_log.version);
+	return true;
+}
+
+bool transaction_log_replaying(void)
+{
+	return replay_active;
+}
+
+probe_type_e transaction_log_replay_probe_type(void)
+{
+	return replay_log.probe_type;
+}
+
+uint64_t transaction_log_replay_time_us(void)
+{
+	return replay_now;
+}
+
+void transaction_log_replay_delay_us(const uint32_t us)
+{
+	replay_now += us;
+}
+
+/*
+ * Fetch the next outermost transaction from the log and check it's the one being asked for.
+ * Once a replay has diverged from the log, nothing that comes after can be trusted, so give up.
+ */
+static const transaction_s *replay_next(
+	const transaction_op_e op, const uint8_t apsel, const uint32_t addr, const uint32_t value, const bool check_value)
+{
+	while (replay_index < replay_log.count && replay_log.transactions[replay_index].depth != 0U)
+		++replay_index;
+	if (replay_index == replay_log.count) {
+		DEBUG_ERROR("Replay ran past the end of the transaction log requesting %s\n", transaction_op_name(op));
+		exit(1);
+	}
+
+	const transaction_s *const transaction = &replay_log.transactions[replay_index];
+	if (transaction->op != op || transaction->apsel != apsel || transaction->addr != addr ||
+		(check_value && transaction->value != value)) {
+		DEBUG_ERROR("Replay diverged from the log at transaction %zu: log has %s AP %u %08" PRIx32 " = %08" PRIx32
+					", requested %s AP %u %08" PRIx32 " = %08" PRIx32 "\n",
+			replay_index, transaction_op_name(transaction->op), transaction->apsel, transaction->addr,
+			transaction->value, transaction_op_name(op), apsel, addr, value);
+		exit(1);
+	}
+	++replay_index;
+
+	const uint64_t end = transaction->start + transaction->duration;
+	if (end > replay_now)
+		replay_now = end;
+
+	if (transaction->flags & TRANSACTION_FLAG_EXCEPTION) {
+		const size_t length = MIN(transaction->length, sizeof(replay_exception_msg) - 1U);
+		memcpy(replay_exception_msg, transaction->payload, length);
+		replay_exception_msg[length] = '\0';
+		raise_exception(transaction->result, replay_exception_msg);
+	}
+	return transaction;
+}
+
+static void replay_payload(const transaction_s *const transaction, void *const dest, const size_t length)
+{
+	memcpy(dest, transaction->payload, MIN(length, transaction->length));
+}
+
+static uint32_t replay_swd_seq_in(const size_t clock_cycles)
+{
+	return replay_next(TRANSACTION_OP_SWD_SEQ_IN, 0U, clock_cycles, 0U, false)->result;
+}
+
+static bool replay_swd_seq_in_parity(uint32_t *const ret, const size_t clock_cycles)
+{
+	const transaction_s *const transaction =
+		replay_next(TRANSACTION_OP_SWD_SEQ_IN_PARITY, 0U, clock_cycles, 0U, false);
+	*ret = transaction->result;
+	return transaction->value;
+}
+
+static void replay_swd_seq_out(const uint32_t tms_states, const size_t clock_cycles)
+{
+	replay_next(TRANSACTION_OP_SWD_SEQ_OUT, 0U, clock_cycles, tms_states, true);
+}
+
+static void replay_swd_seq_out_parity(const uint32_t tms_states, const size_t clock_cycles)
+{
+	replay_next(TRANSACTION_OP_SWD_SEQ_OUT_PARITY, 0U, clock_cycles, tms_states, true);
+}
+
+static void replay_jtag_reset(void)
+{
+	replay_next(TRANSACTION_OP_JTAG_RESET, 0U, 0U, 0U, false);
+}
+
+static bool replay_jtag_next(const bool tms, const bool tdi)
+{
+	return replay_next(TRANSACTION_OP_JTAG_NEXT, 0U, 0U, (tms ? 1U : 0U) | (tdi ? 2U : 0U), true)->result;
+}
+
+static void replay_jtag_tms_seq(const uint32_t tms_states, const size_t clock_cycles)
+{
+	replay_next(TRANSACTION_OP_JTAG_TMS_SEQ, 0U, clock_cycles, tms_states, true);
+}
+
+static void replay_jtag_tdi_tdo_seq(
+	uint8_t *const data_out, const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
+{
+	(void)final_tms;
+	(void)data_in;
+	const transaction_s *const transaction =
+		replay_next(TRANSACTION_OP_JTAG_TDI_TDO_SEQ, 0U, clock_cycles, 0U, false);
+	if (data_out)
+		replay_payload(transaction, data_out, (clock_cycles + 7U) >> 3U);
+}
+
+static void replay_jtag_tdi_seq(const bool final_tms, const uint8_t *const data_in, const size_t clock_cycles)
+{
+	(void)final_tms;
+	(void)data_in;
+	replay_next(TRANSACTION_OP_JTAG_TDI_SEQ, 0U, clock_cycles, 0U, false);
+}
+
+static void replay_jtag_cycle(const bool tms, const bool tdi, const size_t clock_cycles)
+{
+	replay_next(TRANSACTION_OP_JTAG_CYCLE, 0U, clock_cycles, (tms ? 1U : 0U) | (tdi ? 2U : 0U), true);
+}
+
+static bool replay_dp_low_write(const uint16_t addr, const uint32_t data)
+{
+	return replay_next(TRANSACTION_OP_DP_LOW_WRITE, 0U, addr, data, true)->result;
+}
+
+static uint32_t replay_dp_read(adiv5_debug_port_s *const dp, const uint16_t addr)
+{
+	(void)dp;
+	return replay_next(TRANSACTION_OP_DP_READ, 0U, addr, 0U, false)->result;
+}
+
+static uint32_t replay_dp_error(adiv5_debug_port_s *const dp, const bool protocol_recovery)
+{
+	(void)dp;
+	return replay_next(TRANSACTION_OP_DP_ERROR, 0U, 0U, protocol_recovery, true)->result;
+}
+
+static uint32_t replay_dp_low_access(
+	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t value)
+{
+	(void)dp;
+	/* The value passed on reads is meaningless, so only hold writes to matching what was recorded */
+	return replay_next(TRANSACTION_OP_DP_LOW_ACCESS, 0U, addr, value, !rnw)->result;
+}
+
+static void replay_dp_abort(adiv5_debug_port_s *const dp, const uint32_t abort)
+{
+	(void)dp;
+	replay_next(TRANSACTION_OP_DP_ABORT, 0U, 0U, abort, true);
+}
+
+static uint32_t replay_ap_read(adiv5_access_port_s *const ap, const uint16_t addr)
+{
+	return replay_next(TRANSACTION_OP_AP_READ, ap->apsel, addr, 0U, false)->result;
+}
+
+static void replay_ap_write(adiv5_access_port_s *const ap, const uint16_t addr, const uint32_t value)
+{
+	replay_next(TRANSACTION_OP_AP_WRITE, ap->apsel, addr, value, true);
+}
+
+static void replay_mem_read(adiv5_access_port_s *const ap, void *const dest, const uint32_t src, const size_t len)
+{
+	const transaction_s *const transaction = replay_next(TRANSACTION_OP_MEM_READ, ap->apsel, src, len, true);
+	replay_payload(transaction, dest, len);
+}
+
+static void replay_mem_write(
+	adiv5_access_port_s *const ap, const uint32_t dest, const void *const src, const size_t len, const align_e align)
+{
+	(void)src;
+	(void)align;
+	replay_next(TRANSACTION_OP_MEM_WRITE, ap->apsel, dest, len, true);
+}
+
+static void replay_mem_read_fifo(
+	adiv5_access_port_s *const ap, void *const dest, const uint32_t src, const size_t len, const align_e align)
+{
+	(void)align;
+	const transaction_s *const transaction = replay_next(TRANSACTION_OP_MEM_READ_FIFO, ap->apsel, src, len, true);
+	replay_payload(transaction, dest, len);
+}
+
+static void replay_mem_write_fifo(
+	adiv5_access_port_s *const ap, const uint32_t dest, const void *const src, const size_t len, const align_e align)
+{
+	(void)src;
+	(void)align;
+	replay_next(TRANSACTION_OP_MEM_WRITE_FIFO, ap->apsel, dest, len, true);
+}
+
+static void replay_ap_regs_read(adiv5_access_port_s *const ap, void *const data)
+{
+	const transaction_s *const transaction = replay_next(TRANSACTION_OP_AP_REGS_READ, ap->apsel, 0U, 0U, false);
+	replay_payload(transaction, data, TRANSACTION_CORE_REGS_SIZE);
+}
+
+static uint32_t replay_ap_reg_read(adiv5_access_port_s *const ap, const uint8_t reg_num)
+{
+	return replay_next(TRANSACTION_OP_AP_REG_READ, ap->apsel, reg_num, 0U, false)->result;
+}
+
+static void replay_ap_reg_write(adiv5_access_port_s *const ap, const uint8_t num, const uint32_t value)
+{
+	replay_next(TRANSACTION_OP_AP_REG_WRITE, ap->apsel, num, value, true);
+}
+
+void transaction_log_replay_dp_init(adiv5_debug_port_s *const dp)
+{
+	dp->dp_low_write = replay_dp_low_write;
+	dp->dp_read = replay_dp_read;
+	dp->error = replay_dp_error;
+	dp->low_access = replay_dp_low_access;
+	dp->abort = replay_dp_abort;
+	dp->ap_read = replay_ap_read;
+	dp->ap_write = replay_ap_write;
+	dp->mem_read = replay_mem_read;
+	dp->mem_write = replay_mem_write;
+	dp->mem_read_fifo = replay_mem_read_fifo;
+	dp->mem_write_fifo = replay_mem_write_fifo;
+	/* Only ST-Link provides the register block accessors, and the target code behaves differently when they exist */
+	if (replay_log.probe_type == PROBE_TYPE_STLINK_V2) {
+		dp->ap_regs_read = replay_ap_regs_read;
+		dp->ap_reg_read = replay_ap_reg_read;
+		dp->ap_reg_write = replay_ap_reg_write;
+	}
+}
+
+bool transaction_log_replay_swd_init(adiv5_debug_port_s *const dp)
+{
+	swd_proc.seq_in = replay_swd_seq_in;
+	swd_proc.seq_in_parity = replay_swd_seq_in_parity;
+	swd_proc.seq_out = replay_swd_seq_out;
+	swd_proc.seq_out_parity = replay_swd_seq_out_parity;
+	transaction_log_replay_dp_init(dp);
+	return true;
+}
+
+bool transaction_log_replay_swd_scan(const uint32_t targetid)
+{
+	if (replay_log.probe_type != PROBE_TYPE_STLINK_V2)
+		return adiv5_swd_scan(targetid);
+
+	/* ST-Link does its own SWD line handling, so mirror what stlink_swd_scan() does past that point */
+	target_list_free();
+	adiv5_debug_port_s *const dp = calloc(1, sizeof(*dp));
+	if (!dp) { /* calloc failed: heap exhaustion */
+		DEBUG_ERROR("calloc: failed in %s\n", __func__);
+		return false;
+	}
+	transaction_log_replay_dp_init(dp);
+	adiv5_dp_init(dp);
+	return target_list != NULL;
+}
+
+bool transaction_log_replay_jtag_init(void)
+{
+	if (replay_log.probe_type == PROBE_TYPE_STLINK_V2) {
+		DEBUG_ERROR("Replay of ST-Link JTAG sessions is not supported\n");
+		return false;
+	}
+	jtag_proc.jtagtap_reset = replay_jtag_reset;
+	jtag_proc.jtagtap_next = replay_jtag_next;
+	jtag_proc.jtagtap_tms_seq = replay_jtag_tms_seq;
+	jtag_proc.jtagtap_tdi_tdo_seq = replay_jtag_tdi_tdo_seq;
+	jtag_proc.jtagtap_tdi_seq = replay_jtag_tdi_seq;
+	jtag_proc.jtagtap_cycle = replay_jtag_cycle;
+	jtag_proc.tap_idle_cycles = 1;
+	return true;
+}
+
+typedef struct transaction_stats {
+	size_t count;
+	size_t outermost;
+	uint64_t total_us;
+	uint32_t min_us;
+	uint32_t max_us;
+	uint64_t bytes;
+} transaction_stats_s;
+
+bool transaction_log_analyse(const char *const path)
+{
+	transaction_log_s log;
+	if (!log_load(path, &log)) {
+		log_free(&log);
+		return false;
+	}
+
+	transaction_stats_s stats[TRANSACTION_OP_COUNT] = {{0}};
+	uint64_t first_start = UINT64_MAX;
+	uint64_t last_end = 0;
+	uint64_t busy_us = 0;
+	size_t exceptions = 0;
+	for (size_t idx = 0; idx < log.count; ++idx) {
+		const transaction_s *const transaction = &log.transactions[idx];
+		if (transaction->op >= TRANSACTION_OP_COUNT)
+			continue;
+		transaction_stats_s *const stat = &stats[transaction->op];
+		if (!stat->count || transaction->duration < stat->min_us)
+			stat->min_us = transaction->duration;
+		if (transaction->duration > stat->max_us)
+			stat->max_us = transaction->duration;
+		++stat->count;
+		stat->total_us += transaction->duration;
+		if (transaction->op == TRANSACTION_OP_MEM_READ || transaction->op == TRANSACTION_OP_MEM_WRITE ||
+			transaction->op == TRANSACTION_OP_MEM_READ_FIFO || transaction->op == TRANSACTION_OP_MEM_WRITE_FIFO)
+			stat->bytes += transaction->value;
+		if (transaction->flags & TRANSACTION_FLAG_EXCEPTION)
+			++exceptions;
+
+		/* Only the outermost transactions count towards time spent talking to the probe, else we'd double count */
+		if (transaction->depth == 0U) {
+			++stat->outermost;
+			busy_us += transaction->duration;
+			if (transaction->start < first_start)
+				first_start = transaction->start;
+			if (transaction->start + transaction->duration > last_end)
+				last_end = transaction->start + transaction->duration;
+		}
+	}
+
+	DEBUG_INFO("Transaction log recorded with %s %s: %zu transactions, %zu raised exceptions\n", log.product,
+		log.version, log.count, exceptions);
+	DEBUG_INFO("%-18s %10s %10s %12s %9s %9s %9s %12s\n", "Operation", "Count", "Outermost", "Total (us)", "Mean (us)",
+		"Min (us)", "Max (us)", "Bytes");
+	for (size_t op = 0; op < TRANSACTION_OP_COUNT; ++op) {
+		const transaction_stats_s *const stat = &stats[op];
+		if (!stat->count)
+			continue;
+		DEBUG_INFO("%-18s %10zu %10zu %12" PRIu64 " %9" PRIu64 " %9" PRIu32 " %9" PRIu32 " %12" PRIu64 "\n",
+			transaction_op_names[op], stat->count, stat->outermost, stat->total_us, stat->total_us / stat->count,
+			stat->min_us, stat->max_us, stat->bytes);
+	}
+	if (last_end > first_start) {
+		const uint64_t span_us = last_end - first_start;
+		DEBUG_INFO("Session span %" PRIu64 "us, of which %" PRIu64 "us (%" PRIu64 "%%) was spent in probe transactions\n",
+			span_us, busy_us, (busy_us * 100U) / span_us);
+	}
+	log_free(&log);
+	return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PLATFORMS_HOSTED_TRANSACTION_LOG_H
+#define PLATFORMS_HOSTED_TRANSACTION_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bmp_hosted.h"
+#include "adiv5.h"
+
+/*
+ * Recording: every call made through the SWD and JTAG proc tables and through a DP's
+ * function table is timestamped and written to the log along with its result.
+ */
+bool transaction_log_record_open(const char *path, const bmda_probe_s *probe);
+void transaction_log_close(void);
+void transaction_log_record_swd(void);
+void transaction_log_record_jtag(void);
+void transaction_log_record_dp(adiv5_debug_port_s *dp);
+
+/* Replay: serve a previously recorded log back as if it were a probe */
+bool transaction_log_replay_open(const char *path, bmda_probe_s *probe);
+bool transaction_log_replaying(void);
+probe_type_e transaction_log_replay_probe_type(void);
+uint64_t transaction_log_replay_time_us(void);
+void transaction_log_replay_delay_us(uint32_t us);
+bool transaction_log_replay_swd_scan(uint32_t targetid);
+bool transaction_log_replay_swd_init(adiv5_debug_port_s *dp);
+bool transaction_log_replay_jtag_init(void);
+void transaction_log_replay_dp_init(adiv5_debug_port_s *dp);
+
+/* Analysis: report per-operation transaction counts and latencies for a log */
+bool transaction_log_analyse(const char *path);
+
+#endif /* PLATFORMS_HOSTED_TRANSACTION_LOG_H */
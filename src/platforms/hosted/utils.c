@@ -24,13 +24,19 @@
 /* This file deduplicates codes used in several pc-hosted platforms
  */
 
+#include "general.h"
 #include <string.h>
 #include <unistd.h>
 #include <sys/time.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
-#include "general.h"
 #include "timing.h"
 #include "bmp_hosted.h"
+#include "transaction_log.h"
 
 #if defined(_WIN32) && !defined(__MINGW32__)
 int vasprintf(char **strp, const char *const fmt, va_list ap)
@@ -49,21 +55,58 @@ int vasprintf(char **strp, const char *const fmt, va_list ap)
 
 void platform_delay(uint32_t ms)
 {
-#if defined(_WIN32) && !defined(__MINGW32__)
-	Sleep(ms);
+	platform_delay_us(ms * 1000U);
+}
+
+void platform_delay_us(const uint32_t us)
+{
+	if (!us)
+		return;
+	/* When replaying a transaction log, time is virtual, so just move the clock on */
+	if (transaction_log_replaying()) {
+		transaction_log_replay_delay_us(us);
+		return;
+	}
+#if defined(_WIN32)
+	/* Sleep() only has millisecond granularity, so round up so we never wake early */
+	Sleep((us + 999U) / 1000U);
 #else
-#if !defined(usleep)
-	int usleep(unsigned int);
+	struct timespec delay = {
+		.tv_sec = us / 1000000U,
+		.tv_nsec = (long)(us % 1000000U) * 1000L,
+	};
+	/* Keep sleeping for the remainder if a signal interrupts us */
+	while (nanosleep(&delay, &delay) == -1)
+		continue;
 #endif
-	usleep(ms * 1000U);
+}
+
+/*
+ * Microseconds on a monotonic clock with an arbitrary epoch, which unlike the
+ * time of day can't jump when the system clock is adjusted under us.
+ */
+uint64_t platform_time_us(void)
+{
+	if (transaction_log_replaying())
+		return transaction_log_replay_time_us();
+#if defined(_WIN32)
+	static LARGE_INTEGER frequency = {0};
+	if (!frequency.QuadPart)
+		QueryPerformanceFrequency(&frequency);
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return ((uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000U) +
+		(((uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000U) / (uint64_t)frequency.QuadPart);
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t)now.tv_sec * 1000000U) + ((uint64_t)now.tv_nsec / 1000U);
 #endif
 }
 
 uint32_t platform_time_ms(void)
 {
-	timeval_s tv;
-	gettimeofday(&tv, NULL);
-	return (tv.tv_sec * 1000U) + (tv.tv_usec / 1000U);
+	return (uint32_t)(platform_time_us() / 1000U);
 }
 
 bool begins_with(const char *const str, const size_t str_length, const char *const value)
@@ -48,6 +48,9 @@ uint32_t rtt_max_poll_errs = 10;
 static uint32_t poll_ms;
 static uint32_t poll_errs;
 static uint32_t last_poll_ms;
+#if PC_HOSTED == 1
+static platform_timeout_s next_poll;
+#endif
 /* flags for data from host to target */
 bool rtt_flag_skip = false;
 bool rtt_flag_block = false;
@@ -346,18 +349,13 @@ void poll_rtt(target_s *const cur_target)
 			/* check if target needs to be halted during memory access */
 			rtt_halt = target_mem_access_needs_halt(cur_target);
 
-		bool resume_target = false;
-		target_addr_t watch;
-		if (rtt_halt && target_halt_poll(cur_target, &watch) == TARGET_HALT_RUNNING) {
-			/* briefly halt target during target memory access */
-			target_halt_request(cur_target);
-
-			target_halt_reason_e reason = TARGET_HALT_RUNNING;
-			while (reason == TARGET_HALT_RUNNING)
-				reason = target_halt_poll(cur_target, &watch);
-
-			resume_target = reason == TARGET_HALT_REQUEST;
-		}
+		/*
+		 * Briefly halt target during target memory access. The access broker shares the halt with any
+		 * other accesses that come in around the same time, and target_mem_access_end() below resumes
+		 * the target as soon as this poll is done with it.
+		 */
+		if (rtt_halt && !target_mem_access_begin(cur_target))
+			return;
 
 		if (!rtt_found)
 			/* find rtt control block in target memory */
@@ -401,9 +399,9 @@ void poll_rtt(target_s *const cur_target)
 			}
 		}
 
-		/* continue target if halted */
-		if (resume_target)
-			target_halt_resume(cur_target, false);
+		/* Done with target memory for this poll, so let the target run again */
+		if (rtt_halt)
+			target_mem_access_end(cur_target);
 
 		/* update last poll time */
 		last_poll_ms = now;
@@ -418,6 +416,9 @@ void poll_rtt(target_s *const cur_target)
 			poll_ms = rtt_max_poll_ms;
 		else if (poll_ms < rtt_min_poll_ms)
 			poll_ms = rtt_min_poll_ms;
+#if PC_HOSTED == 1
+		platform_timeout_set(&next_poll, poll_ms);
+#endif
 
 		if (rtt_err) {
 			gdb_out("rtt: err\r\n");
@@ -428,4 +429,9 @@ void poll_rtt(target_s *const cur_target)
 			}
 		}
 	}
+#if PC_HOSTED == 1
+	/* Have the poll loop wake in time for the next RTT poll rather than on its own fixed cadence */
+	if (rtt_enabled)
+		platform_poll_schedule(&next_poll);
+#endif
 }
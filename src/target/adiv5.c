@@ -45,13 +45,6 @@
  * are consistently named and accessible when needed in the codebase.
  */
 
-/*
- * This value is taken from the ADIv5 spec table C1-2
- * "AP Identification types for an AP designed by Arm"
- * §C1.3 pg146. This defines a AHB3 AP when the class value is 8
- */
-#define ARM_AP_TYPE_AHB3 1U
-
 /* ROM table CIDR values */
 #define CIDR0_OFFSET 0xff0U /* DBGCID0 */
 #define CIDR1_OFFSET 0xff4U /* DBGCID1 */
@@ -429,7 +422,7 @@ static uint32_t cortexm_initial_halt(adiv5_access_port_s *ap)
 		 */
 		if (ap->dp->mindp
 #if PC_HOSTED == 1
-			&& bmda_probe_info.type != PROBE_TYPE_CMSIS_DAP
+			&& bmda_probe_type() != PROBE_TYPE_CMSIS_DAP
 #endif
 		)
 			dhcsr = adiv5_dp_low_access(ap->dp, ADIV5_LOW_READ, ADIV5_DP_RDBUFF, 0);
@@ -803,6 +796,60 @@ uint32_t adiv5_dp_read_dpidr(adiv5_debug_port_s *const dp)
 	return dpidr;
 }
 
+/* Request system and debug power up, and wait for the acknowledgements */
+static bool adiv5_dp_power_up(adiv5_debug_port_s *const dp)
+{
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, 201);
+	adiv5_dp_write(dp, ADIV5_DP_CTRLSTAT, ADIV5_DP_CTRLSTAT_CSYSPWRUPREQ | ADIV5_DP_CTRLSTAT_CDBGPWRUPREQ);
+	uint32_t status =
+		adiv5_dp_read(dp, ADIV5_DP_CTRLSTAT) & (ADIV5_DP_CTRLSTAT_CSYSPWRUPACK | ADIV5_DP_CTRLSTAT_CDBGPWRUPACK);
+	while (status != (ADIV5_DP_CTRLSTAT_CSYSPWRUPACK | ADIV5_DP_CTRLSTAT_CDBGPWRUPACK)) {
+		if (platform_timeout_is_expired(&timeout))
+			return false;
+		platform_delay(10);
+		status =
+			adiv5_dp_read(dp, ADIV5_DP_CTRLSTAT) & (ADIV5_DP_CTRLSTAT_CSYSPWRUPACK | ADIV5_DP_CTRLSTAT_CDBGPWRUPACK);
+	}
+	return true;
+}
+
+/*
+ * Re-establish the link to a DP that stopped responding because the target reset, went into a deep
+ * sleep or was power cycled. This does the protocol recovery dance, checks DPIDR still identifies the
+ * DP we originally found and powers the debug domain back up, all without rescanning the bus.
+ */
+bool adiv5_dp_reconnect(adiv5_debug_port_s *const dp)
+{
+	volatile exception_s e;
+	TRY_CATCH (e, EXCEPTION_ALL) {
+		dp->error(dp, true);
+	}
+	if (e.type)
+		return false;
+
+	/* DPv0 has no DPIDR to check against */
+	if (dp->version) {
+		const uint32_t dpidr = adiv5_dp_read_dpidr(dp);
+		const uint16_t designer = (dpidr & ADIV5_DP_DPIDR_DESIGNER_MASK) >> ADIV5_DP_DPIDR_DESIGNER_OFFSET;
+		const uint16_t designer_code =
+			(designer & ADIV5_DP_DESIGNER_JEP106_CONT_MASK) << 1U | (designer & ADIV5_DP_DESIGNER_JEP106_CODE_MASK);
+		const uint8_t version = (dpidr & ADIV5_DP_DPIDR_VERSION_MASK) >> ADIV5_DP_DPIDR_VERSION_OFFSET;
+		const uint16_t partno = (dpidr & ADIV5_DP_DPIDR_PARTNO_MASK) >> ADIV5_DP_DPIDR_PARTNO_OFFSET;
+		if (!dpidr || designer_code != dp->designer_code || version != dp->version || partno != dp->partno) {
+			DEBUG_WARN("adiv5: DPIDR %08" PRIx32 " does not match the DP found during scan\n", dpidr);
+			return false;
+		}
+	}
+
+	volatile bool powered = false;
+	TRY_CATCH (e, EXCEPTION_ALL) {
+		adiv5_dp_clear_sticky_errors(dp);
+		powered = adiv5_dp_power_up(dp);
+	}
+	return !e.type && powered;
+}
+
 void adiv5_dp_init(adiv5_debug_port_s *const dp)
 {
 	/*
@@ -813,6 +860,8 @@ void adiv5_dp_init(adiv5_debug_port_s *const dp)
 	dp->ap_read = firmware_ap_read;
 	dp->mem_read = advi5_mem_read_bytes;
 	dp->mem_write = adiv5_mem_write_bytes;
+	dp->mem_read_fifo = adiv5_mem_read_fifo_bytes;
+	dp->mem_write_fifo = adiv5_mem_write_fifo_bytes;
 #if PC_HOSTED == 1
 	bmda_adiv5_dp_init(dp);
 #endif
@@ -920,22 +969,10 @@ void adiv5_dp_init(adiv5_debug_port_s *const dp)
 		}
 	}
 
-	platform_timeout_set(&timeout, 201);
-	/* Write request for system and debug power up */
-	adiv5_dp_write(dp, ADIV5_DP_CTRLSTAT, ADIV5_DP_CTRLSTAT_CSYSPWRUPREQ | ADIV5_DP_CTRLSTAT_CDBGPWRUPREQ);
-	/* Wait for acknowledge */
-	status = 0U;
-	while (status != (ADIV5_DP_CTRLSTAT_CSYSPWRUPACK | ADIV5_DP_CTRLSTAT_CDBGPWRUPACK)) {
-		platform_delay(10);
-		status =
-			adiv5_dp_read(dp, ADIV5_DP_CTRLSTAT) & (ADIV5_DP_CTRLSTAT_CSYSPWRUPACK | ADIV5_DP_CTRLSTAT_CDBGPWRUPACK);
-		if (status == (ADIV5_DP_CTRLSTAT_CSYSPWRUPACK | ADIV5_DP_CTRLSTAT_CDBGPWRUPACK))
-			break;
-		if (platform_timeout_is_expired(&timeout)) {
-			DEBUG_WARN("adiv5: power-up failed\n");
-			free(dp); /* No AP that referenced this DP so long*/
-			return;
-		}
+	if (!adiv5_dp_power_up(dp)) {
+		DEBUG_WARN("adiv5: power-up failed\n");
+		free(dp); /* No AP that referenced this DP so long*/
+		return;
 	}
 	/* At this point due to the guaranteed power domain restart, the APs are all up and in their reset state. */
 
@@ -966,7 +1003,8 @@ void adiv5_dp_init(adiv5_debug_port_s *const dp)
 		lpc55_dmap_probe(ap);
 
 		/* Try to prepare the AP if it seems to be a AHB (memory) AP */
-		if (!ap->apsel && ADIV5_AP_IDR_CLASS(ap->idr) == 8U && ADIV5_AP_IDR_TYPE(ap->idr) == ARM_AP_TYPE_AHB3) {
+		if (!ap->apsel && ADIV5_AP_IDR_CLASS(ap->idr) == ADIV5_AP_CLASS_MEM &&
+			ADIV5_AP_IDR_TYPE(ap->idr) == ARM_AP_TYPE_AHB3) {
 			if (!cortexm_prepare(ap))
 				DEBUG_WARN("adiv5: Failed to prepare AP, results may be unpredictable\n");
 		}
@@ -999,27 +1037,32 @@ void adiv5_dp_init(adiv5_debug_port_s *const dp)
 	adiv5_dp_unref(dp);
 }
 
-/* Program the CSW and TAR for sequential access at a given width */
-void ap_mem_access_setup(adiv5_access_port_s *ap, uint32_t addr, align_e align)
+static uint32_t ap_csw_size(const align_e align)
 {
-	uint32_t csw = ap->csw | ADIV5_AP_CSW_ADDRINC_SINGLE;
-
 	switch (align) {
 	case ALIGN_8BIT:
-		csw |= ADIV5_AP_CSW_SIZE_BYTE;
-		break;
+		return ADIV5_AP_CSW_SIZE_BYTE;
 	case ALIGN_16BIT:
-		csw |= ADIV5_AP_CSW_SIZE_HALFWORD;
-		break;
-	case ALIGN_64BIT:
-	case ALIGN_32BIT:
-		csw |= ADIV5_AP_CSW_SIZE_WORD;
-		break;
+		return ADIV5_AP_CSW_SIZE_HALFWORD;
+	default:
+		return ADIV5_AP_CSW_SIZE_WORD;
 	}
-	adiv5_ap_write(ap, ADIV5_AP_CSW, csw);
+}
+
+/* Program the CSW and TAR for sequential access at a given width */
+void ap_mem_access_setup(adiv5_access_port_s *ap, uint32_t addr, align_e align)
+{
+	adiv5_ap_write(ap, ADIV5_AP_CSW, ap->csw | ADIV5_AP_CSW_ADDRINC_SINGLE | ap_csw_size(align));
 	adiv5_dp_low_access(ap->dp, ADIV5_LOW_WRITE, ADIV5_AP_TAR, addr);
 }
 
+/* Program the CSW and TAR for repeated access to the one address at a given width */
+static void ap_fifo_access_setup(adiv5_access_port_s *const ap, const uint32_t addr, const align_e align)
+{
+	adiv5_ap_write(ap, ADIV5_AP_CSW, ap->csw | ADIV5_AP_CSW_ADDRINC_NONE | ap_csw_size(align));
+	adiv5_ap_write(ap, ADIV5_AP_TAR, addr);
+}
+
 /* Unpack data from the source uint32_t value based on data alignment and source address */
 void *adiv5_unpack_data(void *const dest, const uint32_t src, const uint32_t data, const align_e align)
 {
@@ -1136,6 +1179,68 @@ void adiv5_mem_write_bytes(adiv5_access_port_s *ap, uint32_t dest, const void *s
 	adiv5_dp_read(ap->dp, ADIV5_DP_RDBUFF);
 }
 
+/*
+ * Read len bytes from the register at src in units of align. The TAR never moves, so there's no 1KiB
+ * wrap to handle and the reads can be posted back to back, collecting the last one from RDBUFF.
+ */
+void adiv5_mem_read_fifo_bytes(
+	adiv5_access_port_s *const ap, void *dest, const uint32_t src, size_t len, const align_e align)
+{
+	len >>= align;
+	if (!len)
+		return;
+	ap_fifo_access_setup(ap, src, align);
+	adiv5_dp_low_access(ap->dp, ADIV5_LOW_READ, ADIV5_AP_DRW, 0);
+	while (--len) {
+		const uint32_t value = adiv5_dp_low_access(ap->dp, ADIV5_LOW_READ, ADIV5_AP_DRW, 0);
+		dest = adiv5_unpack_data(dest, src, value, align);
+	}
+	const uint32_t value = adiv5_dp_low_access(ap->dp, ADIV5_LOW_READ, ADIV5_DP_RDBUFF, 0);
+	adiv5_unpack_data(dest, src, value, align);
+}
+
+void adiv5_mem_write_fifo_bytes(
+	adiv5_access_port_s *const ap, const uint32_t dest, const void *src, size_t len, const align_e align)
+{
+	len >>= align;
+	if (!len)
+		return;
+	ap_fifo_access_setup(ap, dest, align);
+	while (len--) {
+		uint32_t value = 0;
+		src = adiv5_pack_data(dest, src, &value, align);
+		adiv5_dp_low_access(ap->dp, ADIV5_LOW_WRITE, ADIV5_AP_DRW, value);
+	}
+	/* Make sure the last write is complete by doing a dummy read */
+	adiv5_dp_read(ap->dp, ADIV5_DP_RDBUFF);
+}
+
+/* As above, but for probes that only expose whole AP register accesses rather than raw DP accesses */
+void adiv5_ap_mem_read_fifo(
+	adiv5_access_port_s *const ap, void *dest, const uint32_t src, size_t len, const align_e align)
+{
+	len >>= align;
+	if (!len)
+		return;
+	ap_fifo_access_setup(ap, src, align);
+	while (len--)
+		dest = adiv5_unpack_data(dest, src, adiv5_ap_read(ap, ADIV5_AP_DRW), align);
+}
+
+void adiv5_ap_mem_write_fifo(
+	adiv5_access_port_s *const ap, const uint32_t dest, const void *src, size_t len, const align_e align)
+{
+	len >>= align;
+	if (!len)
+		return;
+	ap_fifo_access_setup(ap, dest, align);
+	while (len--) {
+		uint32_t value = 0;
+		src = adiv5_pack_data(dest, src, &value, align);
+		adiv5_ap_write(ap, ADIV5_AP_DRW, value);
+	}
+}
+
 void firmware_ap_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value)
 {
 	adiv5_dp_recoverable_access(
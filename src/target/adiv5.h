@@ -194,6 +194,15 @@
 #define ADIV5_AP_IDR_TYPE_MASK       0x0000000fU
 #define ADIV5_AP_IDR_TYPE(idr)       ((idr)&ADIV5_AP_IDR_TYPE_MASK)
 
+/*
+ * These values are taken from the ADIv5 spec table C1-2
+ * "AP Identification types for an AP designed by Arm" §C1.3 pg146.
+ * The AP types are only valid when the class is MEM-AP.
+ */
+#define ADIV5_AP_CLASS_MEM 8U
+#define ARM_AP_TYPE_AHB3   1U
+#define ARM_AP_TYPE_AXI    4U
+
 /* ADIv5 Class 0x1 ROM Table Registers */
 #define ADIV5_ROM_MEMTYPE          0xfccU
 #define ADIV5_ROM_MEMTYPE_SYSMEM   (1U << 0U)
@@ -244,6 +253,9 @@ struct adiv5_debug_port {
 
 	void (*mem_read)(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len);
 	void (*mem_write)(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
+	/* As mem_read/mem_write, but with address increment off so every access hits the same (FIFO) register */
+	void (*mem_read_fifo)(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align);
+	void (*mem_write_fifo)(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
 	uint8_t dev_index;
 	uint8_t fault;
 
@@ -325,6 +337,18 @@ static inline void adiv5_mem_write_sized(
 	ap->dp->mem_write(ap, dest, src, len, align);
 }
 
+static inline void adiv5_mem_read_fifo(
+	adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align)
+{
+	ap->dp->mem_read_fifo(ap, dest, src, len, align);
+}
+
+static inline void adiv5_mem_write_fifo(
+	adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align)
+{
+	ap->dp->mem_write_fifo(ap, dest, src, len, align);
+}
+
 static inline void adiv5_dp_write(adiv5_debug_port_s *dp, uint16_t addr, uint32_t value)
 {
 	dp->low_access(dp, ADIV5_LOW_WRITE, addr, value);
@@ -339,6 +363,8 @@ uint32_t adiv5_ap_read(adiv5_access_port_s *ap, uint16_t addr);
 void adiv5_ap_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
 void adiv5_mem_read(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len);
 void adiv5_mem_write_sized(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
+void adiv5_mem_read_fifo(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align);
+void adiv5_mem_write_fifo(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
 void adiv5_dp_write(adiv5_debug_port_s *dp, uint16_t addr, uint32_t value);
 #endif
 
@@ -379,6 +405,10 @@ const void *adiv5_pack_data(uint32_t dest, const void *src, uint32_t *data, alig
 void ap_mem_access_setup(adiv5_access_port_s *ap, uint32_t addr, align_e align);
 void adiv5_mem_write_bytes(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
 void advi5_mem_read_bytes(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len);
+void adiv5_mem_read_fifo_bytes(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align);
+void adiv5_mem_write_fifo_bytes(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
+void adiv5_ap_mem_read_fifo(adiv5_access_port_s *ap, void *dest, uint32_t src, size_t len, align_e align);
+void adiv5_ap_mem_write_fifo(adiv5_access_port_s *ap, uint32_t dest, const void *src, size_t len, align_e align);
 void firmware_ap_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
 uint32_t firmware_ap_read(adiv5_access_port_s *ap, uint16_t addr);
 uint32_t firmware_swdp_low_access(adiv5_debug_port_s *dp, uint8_t RnW, uint16_t addr, uint32_t value);
@@ -396,5 +426,6 @@ void adiv5_jtagdp_abort(adiv5_debug_port_s *dp, uint32_t abort);
 void adiv5_swd_multidrop_scan(adiv5_debug_port_s *dp, uint32_t targetid);
 
 uint32_t adiv5_dp_read_dpidr(adiv5_debug_port_s *dp);
+bool adiv5_dp_reconnect(adiv5_debug_port_s *dp);
 
 #endif /* TARGET_ADIV5_H */
@@ -587,6 +587,8 @@ bool cortexa_probe(adiv5_access_port_s *ap, target_addr_t base_address)
 
 	target->mem_read = cortexa_slow_mem_read;
 	target->mem_write = cortexa_slow_mem_write;
+	/* Memory is accessed through the core via the ITR, so it can only be done in debug state */
+	target->mem_access_needs_halt = true;
 	target->check_error = cortexa_check_error;
 
 	target->driver = "ARM Cortex-A";
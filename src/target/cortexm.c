@@ -72,12 +72,18 @@
 #endif
 
 static bool cortexm_vector_catch(target_s *t, int argc, const char **argv);
+static bool cortexm_mem_fill(target_s *t, target_addr_t dest, uint32_t pattern, size_t len);
+static int cortexm_mem_copy(target_s *t, target_addr_t dest, target_addr_t src, size_t len);
+static size_t cortexm_mem_test(
+	target_s *t, target_addr_t start, size_t len, target_mem_fault_s *faults, size_t max_faults);
+static bool cortexm_cmd_reset_capture(target_s *t, int argc, const char **argv);
 #if PC_HOSTED == 0
 static bool cortexm_redirect_stdout(target_s *t, int argc, const char **argv);
 #endif
 
 const command_s cortexm_cmd_list[] = {
 	{"vector_catch", cortexm_vector_catch, "Catch exception vectors"},
+	{"reset_capture", cortexm_cmd_reset_capture, "Reset and halt on the reset vector, reporting the latency"},
 #if PC_HOSTED == 0
 	{"redirect_stdout", cortexm_redirect_stdout, "Redirect semihosting stdout to USB UART"},
 #endif
@@ -87,6 +93,9 @@ const command_s cortexm_cmd_list[] = {
 /* target options recognised by the Cortex-M target */
 #define TOPT_FLAVOUR_V6M (1U << 0U) /* if not set, target is assumed to be v7m */
 
+/* How long to keep trying to re-establish a lost link to a running target before declaring it lost */
+#define CORTEXM_RECOVERY_TIMEOUT 5000U
+
 static const char *cortexm_regs_description(target_s *t);
 static void cortexm_regs_read(target_s *t, void *data);
 static void cortexm_regs_write(target_s *t, const void *data);
@@ -97,6 +106,7 @@ static ssize_t cortexm_reg_write(target_s *t, uint32_t reg, const void *data, si
 static void cortexm_reset(target_s *t);
 static target_halt_reason_e cortexm_halt_poll(target_s *t, target_addr_t *watch);
 static void cortexm_halt_request(target_s *t);
+static uint32_t cortexm_reset_capture(target_s *t);
 static int cortexm_fault_unwind(target_s *t);
 
 static int cortexm_breakwatch_set(target_s *t, breakwatch_s *bw);
@@ -115,6 +125,10 @@ typedef struct cortexm_priv {
 	uint32_t flash_patch_revision;
 	/* Copy of DEMCR for vector-catch */
 	uint32_t demcr;
+	/* Session recovery state for when the link to a running target goes away */
+	bool link_lost;
+	platform_timeout_s recovery_timeout;
+	uint32_t link_lost_time;
 } cortexm_priv_s;
 
 /* Register number tables */
@@ -466,6 +480,17 @@ static void cortexm_mem_write(target_s *t, target_addr_t dest, const void *src,
 	adiv5_mem_write(cortex_ap(t), dest, src, len);
 }
 
+/* FIFOs live in peripheral space, so unlike the above there's no cache maintenance to do here */
+static void cortexm_mem_read_fifo(target_s *t, void *dest, target_addr_t src, size_t len, align_e align)
+{
+	adiv5_mem_read_fifo(cortex_ap(t), dest, src, len, align);
+}
+
+static void cortexm_mem_write_fifo(target_s *t, target_addr_t dest, const void *src, size_t len, align_e align)
+{
+	adiv5_mem_write_fifo(cortex_ap(t), dest, src, len, align);
+}
+
 const char *cortexm_regs_description(target_s *t)
 {
 	const bool is_cortexmf = t->target_options & CORTEXM_TOPT_FLAVOUR_V7MF;
@@ -517,6 +542,11 @@ bool cortexm_probe(adiv5_access_port_s *ap)
 	t->check_error = cortex_check_error;
 	t->mem_read = cortexm_mem_read;
 	t->mem_write = cortexm_mem_write;
+	t->mem_read_fifo = cortexm_mem_read_fifo;
+	t->mem_write_fifo = cortexm_mem_write_fifo;
+	t->mem_fill = cortexm_mem_fill;
+	t->mem_copy = cortexm_mem_copy;
+	t->mem_test = cortexm_mem_test;
 
 	t->driver = "ARM Cortex-M";
 
@@ -566,24 +596,12 @@ bool cortexm_probe(adiv5_access_port_s *ap)
 	bool conn_reset = false;
 	if (platform_nrst_get_val()) {
 		conn_reset = true;
-
-		/* Request halt when reset is de-asseted */
-		target_mem_write32(t, CORTEXM_DEMCR, priv->demcr);
-		/* Force a halt */
-		cortexm_halt_request(t);
-		/* Release reset */
-		platform_nrst_set_val(false);
-		/* Poll for release from reset */
-		platform_timeout_s timeout;
-		platform_timeout_set(&timeout, 1000);
-		while (target_mem_read32(t, CORTEXM_DHCSR) & CORTEXM_DHCSR_S_RESET_ST) {
-			if (platform_timeout_is_expired(&timeout)) {
-				DEBUG_ERROR("Error releasing from reset\n");
-				/* Go on and try to detect the target anyways */
-				break;
-			}
-			continue;
-		}
+		const uint32_t latency = cortexm_reset_capture(t);
+		if (latency == UINT32_MAX)
+			/* Go on and try to detect the target anyways */
+			DEBUG_ERROR("Could not halt the target coming out of reset\n");
+		else
+			DEBUG_INFO("Halted %" PRIu32 "ms after reset release\n", latency);
 	}
 
 	/* Check cache type */
@@ -987,6 +1005,64 @@ static void cortexm_reset(target_s *t)
 	target_check_error(t);
 }
 
+/*
+ * Reset the core and catch it on the first instruction of its reset handler, for early boot debugging
+ * and for recovering parts whose firmware disables the debug pins or sleeps shortly after boot.
+ * Halting debug and the reset vector catch are programmed while the core is still held in reset so it
+ * halts in hardware on release, whatever the link latency. The halt request is then repeated until the
+ * core reports halted, covering parts that hold their debug logic in reset along with the core.
+ * Watchdog and low-power keep-alive bits (such as the STM32 DBGMCU_CR) are set by the part drivers at
+ * attach and survive a system reset. Returns the reset release to halt time in ms, or UINT32_MAX if the
+ * core could not be caught.
+ */
+static uint32_t cortexm_reset_capture(target_s *const t)
+{
+	cortexm_priv_s *const priv = t->priv;
+	const bool use_nrst = !(t->target_options & CORTEXM_TOPT_INHIBIT_NRST);
+	const uint32_t demcr = priv->demcr | CORTEXM_DEMCR_VC_CORERESET;
+	const uint32_t halt = CORTEXM_DHCSR_DBGKEY | CORTEXM_DHCSR_C_HALT | CORTEXM_DHCSR_C_DEBUGEN;
+
+	if (use_nrst)
+		platform_nrst_set_val(true);
+	volatile exception_s e;
+	TRY_CATCH (e, EXCEPTION_ALL) {
+		target_mem_write32(t, CORTEXM_DHCSR, halt);
+		target_mem_write32(t, CORTEXM_DEMCR, demcr);
+	}
+	/* Writes that didn't land because the debug logic is in reset too are taken care of below */
+	target_check_error(t);
+
+	const uint32_t release_time = platform_time_ms();
+	if (use_nrst)
+		platform_nrst_set_val(false);
+	else
+		target_mem_write32(t, CORTEXM_AIRCR, CORTEXM_AIRCR_VECTKEY | CORTEXM_AIRCR_SYSRESETREQ);
+
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, 1000);
+	while (!platform_timeout_is_expired(&timeout)) {
+		volatile uint32_t dhcsr = 0;
+		TRY_CATCH (e, EXCEPTION_ALL) {
+			dhcsr = target_mem_read32(t, CORTEXM_DHCSR);
+			if (!(dhcsr & CORTEXM_DHCSR_S_HALT)) {
+				target_mem_write32(t, CORTEXM_DEMCR, demcr);
+				target_mem_write32(t, CORTEXM_DHCSR, halt);
+			}
+		}
+		if (e.type || target_check_error(t))
+			continue;
+		if ((dhcsr & (CORTEXM_DHCSR_S_HALT | CORTEXM_DHCSR_S_RESET_ST)) == CORTEXM_DHCSR_S_HALT) {
+			const uint32_t latency = platform_time_ms() - release_time;
+			/* Put the vector catch back as the user configured it and clear the halt reasons */
+			target_mem_write32(t, CORTEXM_DEMCR, priv->demcr);
+			target_mem_write32(t, CORTEXM_DFSR, CORTEXM_DFSR_RESETALL);
+			priv->stepping = false;
+			return latency;
+		}
+	}
+	return UINT32_MAX;
+}
+
 static void cortexm_halt_request(target_s *t)
 {
 	volatile exception_s e;
@@ -997,6 +1073,62 @@ static void cortexm_halt_request(target_s *t)
 		tc_printf(t, "Timeout sending interrupt, is target in WFI?\n");
 }
 
+/*
+ * Put the debug state GDB set up back into a core whose debug domain was reset or powered down
+ * while it was running: halting debug, vector catch and the breakpoint and watchpoint units, which
+ * are reprogrammed from the target's list of set breakwatches.
+ */
+static bool cortexm_restore_debug_state(target_s *const t)
+{
+	cortexm_priv_s *const priv = t->priv;
+	target_mem_write32(t, CORTEXM_DHCSR, CORTEXM_DHCSR_DBGKEY | CORTEXM_DHCSR_C_DEBUGEN);
+	target_mem_write32(t, CORTEXM_DEMCR, priv->demcr);
+
+	priv->base.breakpoints_mask = 0;
+	for (size_t i = 0; i < priv->base.breakpoints_available; i++)
+		target_mem_write32(t, CORTEXM_FPB_COMP(i), 0);
+	priv->base.watchpoints_mask = 0;
+	for (size_t i = 0; i < priv->base.watchpoints_available; i++)
+		target_mem_write32(t, CORTEXM_DWT_FUNC(i), 0);
+	target_mem_write32(t, CORTEXM_FPB_CTRL, CORTEXM_FPB_CTRL_KEY | CORTEXM_FPB_CTRL_ENABLE);
+
+	for (breakwatch_s *bw = t->bw_list; bw; bw = bw->next) {
+		if (cortexm_breakwatch_set(t, bw) != 0)
+			DEBUG_WARN("Could not restore break/watchpoint at 0x%08" PRIx32 "\n", bw->addr);
+	}
+	return !target_check_error(t);
+}
+
+/*
+ * Try to get back a running target whose link went away because it reset, slept or was power cycled.
+ * The DP is recovered in place, the core checked to still be the one we attached to, and the debug
+ * state restored so the GDB session carries on without a rescan. Returns false once recovery has
+ * been failing for longer than CORTEXM_RECOVERY_TIMEOUT.
+ */
+static bool cortexm_recover(target_s *const t)
+{
+	cortexm_priv_s *const priv = t->priv;
+	if (!priv->link_lost) {
+		DEBUG_WARN("Lost the link to the target, trying to recover it\n");
+		priv->link_lost = true;
+		priv->link_lost_time = platform_time_ms();
+		platform_timeout_set(&priv->recovery_timeout, CORTEXM_RECOVERY_TIMEOUT);
+	}
+
+	volatile bool recovered = false;
+	volatile exception_s e;
+	TRY_CATCH (e, EXCEPTION_ALL) {
+		recovered = adiv5_dp_reconnect(cortex_ap(t)->dp) && target_mem_read32(t, CORTEXM_CPUID) == t->cpuid &&
+			cortexm_restore_debug_state(t);
+	}
+	if (!e.type && recovered) {
+		DEBUG_INFO("Recovered the link to the target in %" PRIu32 "ms\n", platform_time_ms() - priv->link_lost_time);
+		priv->link_lost = false;
+		return true;
+	}
+	return !platform_timeout_is_expired(&priv->recovery_timeout);
+}
+
 static target_halt_reason_e cortexm_halt_poll(target_s *t, target_addr_t *watch)
 {
 	cortexm_priv_s *priv = t->priv;
@@ -1007,14 +1139,19 @@ static target_halt_reason_e cortexm_halt_poll(target_s *t, target_addr_t *watch)
 		/* If this times out because the target is in WFI then the target is still running. */
 		dhcsr = target_mem_read32(t, CORTEXM_DHCSR);
 	}
-	switch (e.type) {
-	case EXCEPTION_ERROR:
-		/* Things went seriously wrong and there is no recovery from this... */
-		target_list_free();
-		return TARGET_HALT_ERROR;
-	case EXCEPTION_TIMEOUT:
+	if (e.type == EXCEPTION_TIMEOUT)
 		/* Timeout isn't actually a problem and probably means target is in WFI */
 		return TARGET_HALT_RUNNING;
+
+	/*
+	 * A fault on the link, or halting debug having been switched off under us, means the target reset,
+	 * slept or was power cycled. Try to recover the session before giving up on the target.
+	 */
+	if (e.type == EXCEPTION_ERROR || cortex_ap(t)->dp->fault || !(dhcsr & CORTEXM_DHCSR_C_DEBUGEN)) {
+		if (cortexm_recover(t))
+			return TARGET_HALT_RUNNING;
+		target_list_free();
+		return TARGET_HALT_ERROR;
 	}
 
 	/* Check that the core actually halted */
@@ -1154,7 +1291,8 @@ static int cortexm_fault_unwind(target_s *t)
 	return 0;
 }
 
-bool cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
+/* Run a stub loaded at loadaddr, returning the code it exits with or -1 if it doesn't run to completion */
+int cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
 {
 	uint32_t regs[CORTEXM_GENERAL_REG_COUNT + CORTEX_FLOAT_REG_COUNT] = {0};
 
@@ -1169,7 +1307,7 @@ bool cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1,
 	cortexm_regs_write(t, regs);
 
 	if (target_check_error(t))
-		return false;
+		return -1;
 
 	/* Execute the stub */
 	target_halt_reason_e reason = TARGET_HALT_RUNNING;
@@ -1190,7 +1328,7 @@ bool cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1,
 			for (uint32_t i = 0; i < 20U; ++i)
 				DEBUG_WARN("%2" PRIu32 ": %08" PRIx32 ", %08" PRIx32 "\n", i, arm_regs_start[i], arm_regs[i]);
 #endif
-			return false;
+			return -1;
 		}
 		reason = cortexm_halt_poll(t, NULL);
 	}
@@ -1200,17 +1338,218 @@ bool cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1,
 
 	if (reason != TARGET_HALT_BREAKPOINT) {
 		DEBUG_WARN(" Reason %d\n", reason);
-		return false;
+		return -1;
 	}
 
 	uint32_t pc = cortexm_pc_read(t);
 	uint16_t bkpt_instr = target_mem_read16(t, pc);
 	if (bkpt_instr >> 8U != 0xbeU)
-		return false;
+		return -1;
 
 	return bkpt_instr & 0xffU;
 }
 
+/*
+ * Large fills and copies are done by running a stub on the core rather than by moving every byte over
+ * the debug link. The stub goes at whichever end of a RAM region doesn't overlap the memory being worked
+ * on, and the RAM it displaces and the core registers are put back afterwards so the program being
+ * debugged doesn't see it. The work is split up to keep each run of the stub well inside its timeout.
+ */
+#define CORTEXM_MEMOP_CHUNK_SIZE 0x40000U
+#define CORTEXM_MEMOP_STUB_MAX   256U
+
+static const uint16_t cortexm_memfill_stub[] = {
+#include "flashstub/memfill.stub"
+};
+
+static const uint16_t cortexm_memcopy_stub[] = {
+#include "flashstub/memcopy.stub"
+};
+
+static const uint16_t cortexm_memtest_stub[] = {
+#include "flashstub/memtest.stub"
+};
+
+/* Tests run by the memtest stub, and the exit code it uses to report a fault */
+#define CORTEXM_MEMTEST_MARCH 0U
+#define CORTEXM_MEMTEST_LINES 1U
+#define CORTEXM_MEMTEST_FAULT 1
+
+static bool cortexm_memop_overlaps(const target_addr_t addr, const size_t size, const target_addr_t start, const size_t len)
+{
+	return (uint64_t)addr < (uint64_t)start + len && (uint64_t)start < (uint64_t)addr + size;
+}
+
+static bool cortexm_memop_scratch(target_s *const t, const size_t size, const target_addr_t dest,
+	const target_addr_t src, const size_t len, target_addr_t *const scratch)
+{
+	for (const target_ram_s *ram = t->ram; ram; ram = ram->next) {
+		if (ram->length < size + 4U)
+			continue;
+		const target_addr_t candidates[2] = {ALIGN(ram->start, 4U), (ram->start + ram->length - size) & ~3U};
+		for (size_t idx = 0; idx < 2U; ++idx) {
+			if (!cortexm_memop_overlaps(candidates[idx], size, dest, len) &&
+				!cortexm_memop_overlaps(candidates[idx], size, src, len)) {
+				*scratch = candidates[idx];
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+typedef struct cortexm_memop {
+	target_addr_t scratch;
+	size_t stub_size;
+	uint8_t saved_ram[CORTEXM_MEMOP_STUB_MAX];
+	uint32_t saved_regs[CORTEXM_GENERAL_REG_COUNT + CORTEX_FLOAT_REG_COUNT];
+} cortexm_memop_s;
+
+/* Load a stub to operate on dest and src, saving what it displaces. For fills and tests pass src = dest */
+static bool cortexm_memop_begin(target_s *const t, cortexm_memop_s *const op, const uint16_t *const stub,
+	const size_t stub_size, const target_addr_t dest, const target_addr_t src, const size_t len)
+{
+	if (stub_size > sizeof(op->saved_ram) || !(target_mem_read32(t, CORTEXM_DHCSR) & CORTEXM_DHCSR_S_HALT) ||
+		!cortexm_memop_scratch(t, stub_size, dest, src, len, &op->scratch))
+		return false;
+	op->stub_size = stub_size;
+	target_regs_read(t, op->saved_regs);
+	cortexm_mem_read(t, op->saved_ram, op->scratch, stub_size);
+	if (target_check_error(t))
+		return false;
+	cortexm_mem_write(t, op->scratch, stub, stub_size);
+	return !target_check_error(t);
+}
+
+static bool cortexm_memop_end(target_s *const t, const cortexm_memop_s *const op)
+{
+	cortexm_mem_write(t, op->scratch, op->saved_ram, op->stub_size);
+	target_regs_write(t, op->saved_regs);
+	return !target_check_error(t);
+}
+
+/*
+ * Run the fill or copy stub over the block a chunk at a time. This returns 0 on success, 1 if the stub could not
+ * be set up (so nothing was touched), or -1 if it failed once the stub had started running.
+ */
+static int cortexm_run_memop(target_s *const t, const bool copy, const target_addr_t dest, const uint32_t src,
+	const size_t len, const uint32_t width)
+{
+	cortexm_memop_s op;
+	/* For fills src is the pattern, so only the destination needs keeping clear of */
+	if (copy ? !cortexm_memop_begin(t, &op, cortexm_memcopy_stub, sizeof(cortexm_memcopy_stub), dest, src, len) :
+			   !cortexm_memop_begin(t, &op, cortexm_memfill_stub, sizeof(cortexm_memfill_stub), dest, dest, len))
+		return 1;
+
+	/* Moving a block up over itself has to start at the top so no source is overwritten before it is read */
+	const bool descending = copy && dest > src;
+	volatile bool result = true;
+	volatile exception_s e;
+	TRY_CATCH (e, EXCEPTION_ALL) {
+		for (size_t done = 0; result && done < len;) {
+			const size_t chunk = MIN(len - done, CORTEXM_MEMOP_CHUNK_SIZE);
+			const size_t offset = descending ? len - done - chunk : done;
+			result = cortexm_run_stub(t, op.scratch, dest + offset, copy ? src + offset : src, chunk, width) == 0;
+			done += chunk;
+		}
+	}
+	/* Put back what the stub displaced however the run ended, before passing on any exception */
+	const bool restored = cortexm_memop_end(t, &op);
+	if (e.type)
+		raise_exception(e.type, e.msg);
+	return restored && result ? 0 : -1;
+}
+
+/* The fill stub works in whole words, target_mem_fill() having dealt with any unaligned ends */
+static bool cortexm_mem_fill(target_s *const t, const target_addr_t dest, const uint32_t pattern, const size_t len)
+{
+	return cortexm_run_memop(t, false, dest, pattern, len, 4U) == 0;
+}
+
+static int cortexm_mem_copy(target_s *const t, const target_addr_t dest, const target_addr_t src, const size_t len)
+{
+	const uint32_t width = ((dest | src | len) & 3U) ? 1U : 4U;
+	return cortexm_run_memop(t, true, dest, src, len, width);
+}
+
+/* Run one of the memtest stub's tests over a block, returning 1 with the fault filled in if it finds one */
+static int cortexm_mem_test_block(target_s *const t, const target_addr_t scratch, const target_addr_t start,
+	const size_t len, const uint32_t test, target_mem_fault_s *const fault)
+{
+	const int code = cortexm_run_stub(t, scratch, start, len, test, 0);
+	if (code != CORTEXM_MEMTEST_FAULT)
+		return code == 0 ? 0 : -1;
+	uint32_t regs[CORTEXM_GENERAL_REG_COUNT + CORTEX_FLOAT_REG_COUNT];
+	target_regs_read(t, regs);
+	fault->addr = regs[0];
+	fault->expected = regs[1];
+	fault->actual = regs[2];
+	return 1;
+}
+
+/*
+ * Test the data and address lines across the whole range, then March C- it a chunk at a time, collecting
+ * the first fault in each chunk. A data or address line fault stops the test as everything would fail.
+ */
+static size_t cortexm_mem_test_range(target_s *const t, const target_addr_t start, const size_t len,
+	target_mem_fault_s *const faults, const size_t max_faults)
+{
+	cortexm_memop_s op;
+	if (!cortexm_memop_begin(t, &op, cortexm_memtest_stub, sizeof(cortexm_memtest_stub), start, start, len))
+		return SIZE_MAX;
+	volatile size_t count = 0;
+	volatile int result = -1;
+	volatile exception_s e;
+	TRY_CATCH (e, EXCEPTION_ALL) {
+		target_mem_fault_s fault;
+		result = cortexm_mem_test_block(t, op.scratch, start, len, CORTEXM_MEMTEST_LINES, &fault);
+		if (result == 1)
+			faults[count++] = fault;
+		for (size_t offset = 0; result == 0 && offset < len; offset += CORTEXM_MEMOP_CHUNK_SIZE) {
+			const size_t chunk = MIN(len - offset, CORTEXM_MEMOP_CHUNK_SIZE);
+			result = cortexm_mem_test_block(t, op.scratch, start + offset, chunk, CORTEXM_MEMTEST_MARCH, &fault);
+			if (result == 1) {
+				faults[count++] = fault;
+				if (count < max_faults)
+					result = 0;
+			}
+		}
+	}
+	/* As with fills and copies, the stub's RAM and the registers are put back even if the test was cut short */
+	const bool restored = cortexm_memop_end(t, &op);
+	if (e.type)
+		raise_exception(e.type, e.msg);
+	if (!restored || result < 0)
+		return SIZE_MAX;
+	return count;
+}
+
+static size_t cortexm_mem_test(
+	target_s *const t, const target_addr_t start, const size_t len, target_mem_fault_s *const faults, size_t max_faults)
+{
+	/*
+	 * If there's no RAM outside the range to run from, the range covers where the stub would go at one or
+	 * both ends of a RAM region. Test it in two parts instead, leaving a stub sized part at the top (or if
+	 * the rest still has nowhere to run from, at the bottom) for the stub to run from, then testing that
+	 * part with the stub run from the rest. The part is padded to allow for the stub's alignment.
+	 */
+	const size_t part = ALIGN(sizeof(cortexm_memtest_stub), 4U) + 4U;
+	target_addr_t scratch = 0;
+	if (cortexm_memop_scratch(t, sizeof(cortexm_memtest_stub), start, start, len, &scratch) || len <= part * 2U)
+		return cortexm_mem_test_range(t, start, len, faults, max_faults);
+	target_addr_t rest = start;
+	target_addr_t reserved = start + len - part;
+	if (!cortexm_memop_scratch(t, sizeof(cortexm_memtest_stub), rest, rest, len - part, &scratch)) {
+		rest = start + part;
+		reserved = start;
+	}
+	const size_t first = cortexm_mem_test_range(t, rest, len - part, faults, max_faults);
+	if (first == SIZE_MAX || first == max_faults)
+		return first;
+	const size_t second = cortexm_mem_test_range(t, reserved, part, faults + first, max_faults - first);
+	return second == SIZE_MAX ? SIZE_MAX : first + second;
+}
+
 /*
  * The following routines implement hardware breakpoints and watchpoints.
  * The Flash Patch and Breakpoint (FPB) and Data Watch and Trace (DWT)
@@ -1377,6 +1716,25 @@ static bool cortexm_vector_catch(target_s *t, int argc, const char **argv)
 	return true;
 }
 
+static bool cortexm_cmd_reset_capture(target_s *t, int argc, const char **argv)
+{
+	(void)argc;
+	(void)argv;
+	const uint32_t latency = cortexm_reset_capture(t);
+	if (latency == UINT32_MAX) {
+		tc_printf(t, "Failed to halt the target coming out of reset\n");
+		return false;
+	}
+
+	/* ARMv6-M parts without a VTOR read it as 0, which is where their vector table is anyway */
+	const uint32_t vtor = target_mem_read32(t, CORTEXM_VTOR);
+	const uint32_t reset_handler = target_mem_read32(t, vtor + 4U) & ~1U;
+	const uint32_t pc = cortexm_pc_read(t);
+	tc_printf(t, "Halted %" PRIu32 "ms after reset release at 0x%08" PRIx32 "%s\n", latency, pc,
+		pc == reset_handler ? ", on the reset vector" : "");
+	return true;
+}
+
 #if PC_HOSTED == 0
 static bool cortexm_redirect_stdout(target_s *t, int argc, const char **argv)
 {
@@ -31,6 +31,7 @@ extern unsigned cortexm_wait_timeout;
 #define CORTEXM_SCS_BASE (CORTEXM_PPB_BASE + 0xe000U)
 
 #define CORTEXM_CPUID (CORTEXM_SCS_BASE + 0xd00U)
+#define CORTEXM_VTOR  (CORTEXM_SCS_BASE + 0xd08U)
 #define CORTEXM_AIRCR (CORTEXM_SCS_BASE + 0xd0cU)
 #define CORTEXM_CFSR  (CORTEXM_SCS_BASE + 0xd28U)
 #define CORTEXM_HFSR  (CORTEXM_SCS_BASE + 0xd2cU)
@@ -170,7 +171,7 @@ extern unsigned cortexm_wait_timeout;
 bool cortexm_attach(target_s *t);
 void cortexm_detach(target_s *t);
 void cortexm_halt_resume(target_s *t, bool step);
-bool cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3);
+int cortexm_run_stub(target_s *t, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3);
 int cortexm_mem_write_sized(target_s *t, target_addr_t dest, const void *src, size_t len, align_e align);
 
 #endif /* TARGET_CORTEXM_H */
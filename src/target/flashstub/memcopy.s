@@ -0,0 +1,76 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Copy a block of target memory, safely for overlapping blocks.
+ * r0 = destination, r1 = source, r2 = length in bytes, r3 = access width (1, or 4 when
+ * the destination, source and length are all word aligned)
+ */
+	.syntax unified
+	.cpu cortex-m0
+	.thumb
+	.text
+	.global memcopy_stub
+	.thumb_func
+memcopy_stub:
+	cmp r0, r1
+	bhi 5f
+	/* Destination below the source, copy upwards */
+	movs r4, #0
+	cmp r3, #4
+	beq 3f
+	b 2f
+1:	ldrb r5, [r1, r4]
+	strb r5, [r0, r4]
+	adds r4, #1
+2:	cmp r4, r2
+	blo 1b
+	bkpt #0
+3:	b 4f
+31:	ldr r5, [r1, r4]
+	str r5, [r0, r4]
+	adds r4, #4
+4:	cmp r4, r2
+	blo 31b
+	bkpt #0
+	/* Destination above the source, copy downwards */
+5:	subs r2, r3
+	bmi 6f
+	cmp r3, #4
+	beq 7f
+	ldrb r5, [r1, r2]
+	strb r5, [r0, r2]
+	b 5b
+7:	ldr r5, [r1, r2]
+	str r5, [r0, r2]
+	b 5b
+6:	bkpt #0
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2023 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Destructively test a word aligned block of RAM, exiting with bkpt #0 if it passes. On a fault
+ * it exits with bkpt #1 and r0 = faulting address, r1 = value expected, r2 = value read.
+ * r0 = start, r1 = length in bytes (a multiple of 4), r2 = test to run:
+ *   0 - March C- over the block
+ *   1 - walking ones on the data lines, then a check that each address line is independent
+ */
+	.syntax unified
+	.cpu cortex-m0
+	.thumb
+	.text
+	.global memtest_stub
+	.thumb_func
+memtest_stub:
+	movs r4, #0
+	cmp r2, #0
+	beq march
+
+	/* Walk a one through each data bit at the start of the block */
+	movs r2, #1
+1:	str r2, [r0]
+	ldr r5, [r0]
+	cmp r5, r2
+	bne fault
+	lsls r2, r2, #1
+	bne 1b
+
+	/*
+	 * Fill each power of two offset with a pattern, then write the inverse to each of them in
+	 * turn checking it shows up nowhere else - any address line stuck or shorted shows up as
+	 * a location that changes when it shouldn't.
+	 */
+	ldr r6, =0xaaaaaaaa
+	mvns r7, r6
+	movs r2, r6
+	str r6, [r0]
+	movs r4, #4
+2:	cmp r4, r1
+	bhs 3f
+	str r6, [r0, r4]
+	lsls r4, r4, #1
+	b 2b
+3:	movs r3, #4
+4:	cmp r3, r1
+	bhs 7f
+	str r7, [r0, r3]
+	movs r4, #0
+5:	cmp r4, r3
+	beq 6f
+	ldr r5, [r0, r4]
+	cmp r5, r6
+	bne fault
+6:	cmp r4, #0
+	bne 61f
+	movs r4, #2
+61:	lsls r4, r4, #1
+	cmp r4, r1
+	blo 5b
+	str r6, [r0, r3]
+	lsls r3, r3, #1
+	b 4b
+7:	bkpt #0
+
+	/* March C-: down(w0), up(r0,w1), up(r1,w0), down(r0,w1), down(r1,w0), up(r0) */
+march:
+	movs r6, #0
+	mvns r7, r6
+	mov r4, r1
+8:	subs r4, #4
+	str r6, [r0, r4]
+	bne 8b
+	movs r2, r6
+	movs r3, r7
+	bl up
+	movs r2, r7
+	movs r3, r6
+	bl up
+	movs r2, r6
+	movs r3, r7
+	bl down
+	movs r2, r7
+	movs r3, r6
+	bl down
+	movs r2, r6
+	movs r3, r6
+	bl up
+	bkpt #0
+
+	/* Read back the value in r2 and replace it with r3 across the block, upwards then downwards */
+up:
+	movs r4, #0
+9:	ldr r5, [r0, r4]
+	cmp r5, r2
+	bne fault
+	str r3, [r0, r4]
+	adds r4, #4
+	cmp r4, r1
+	blo 9b
+	bx lr
+down:
+	mov r4, r1
+10:	subs r4, #4
+	ldr r5, [r0, r4]
+	cmp r5, r2
+	bne fault
+	str r3, [r0, r4]
+	cmp r4, #0
+	bne 10b
+	bx lr
+
+fault:
+	adds r0, r0, r4
+	movs r1, r2
+	movs r2, r5
+	bkpt #1
+	.ltorg
@@ -190,6 +190,7 @@
 #define LPC43x0_SPIFI_STAT (LPC43x0_SPIFI_BASE + 0x01cU)
 
 #define LPC43x0_SPIFI_DATA_LENGTH(x)       ((x)&0x00003fffU)
+#define LPC43x0_SPIFI_POLL                 (1U << 14U)
 #define LPC43x0_SPIFI_DATA_SHIFT           15U
 #define LPC43x0_SPIFI_DATA_IN              (0U << 15U)
 #define LPC43x0_SPIFI_DATA_OUT             (1U << 15U)
@@ -206,10 +207,24 @@
 #define LPC43x0_SPIFI_FRAME_MASK           0x00e00000U
 #define LPC43x0_SPIFI_FRAME_SHIFT          21U
 #define LPC43x0_SPIFI_OPCODE_SHIFT         24U
+#define LPC43x0_SPIFI_STATUS_MCINIT        (1U << 0U)
 #define LPC43x0_SPIFI_STATUS_CMD_ACTIVE    (1U << 1U)
 #define LPC43x0_SPIFI_STATUS_RESET         (1U << 4U)
 #define LPC43x0_SPIFI_STATUS_INTRQ         (1U << 5U)
 
+/*
+ * Poll on the status register in hardware until bit 0 (BUSY) reads as 0.
+ * In poll mode, bits 2:0 of the data length select the bit to test and bit 3 the value to wait for.
+ */
+#define LPC43x0_SPIFI_CMD_POLL_NOT_BUSY                                                                            \
+	(LPC43x0_SPIFI_CMD_SERIAL | LPC43x0_SPIFI_FRAME_OPCODE_ONLY | LPC43x0_SPIFI_DATA_IN | LPC43x0_SPIFI_POLL | \
+		(SPI_FLASH_OPCODE(SPI_FLASH_CMD_READ_STATUS) << LPC43x0_SPIFI_OPCODE_SHIFT) | LPC43x0_SPIFI_DATA_LENGTH(0U))
+
+/* Used for memory mode when we don't know what the boot ROM set up: Fast Read, 3 byte address, 1 dummy byte */
+#define LPC43x0_SPIFI_DEFAULT_MEMORY_COMMAND                                                             \
+	(LPC43x0_SPIFI_CMD_SERIAL | LPC43x0_SPIFI_FRAME_OPCODE_3B_ADDR | (1U << LPC43x0_SPIFI_DUMMY_SHIFT) | \
+		(0x0bU << LPC43x0_SPIFI_OPCODE_SHIFT))
+
 #define LPC43x0_SSP0_BASE 0x40083000
 #define LPC43x0_SSP0_DR   (LPC43x0_SSP0_BASE + 0x008)
 #define LPC43x0_SSP0_SR   (LPC43x0_SSP0_BASE + 0x00c)
@@ -259,6 +274,8 @@ typedef struct lpc43x0_priv {
 	lpc43x0_flash_interface_e interface;
 	uint32_t boot_address;
 	uint32_t spifi_memory_command;
+	bool spifi_memory_mode;
+	void (*mem_read)(target_s *target, void *dest, target_addr_t src, size_t len);
 	uint32_t bank3_pin3_config;
 	uint32_t bank3_pin4_config;
 	uint32_t bank3_pin5_config;
@@ -276,10 +293,14 @@ static void lpc43x0_detach(target_s *target);
 static bool lpc43x0_enter_flash_mode(target_s *t);
 static bool lpc43x0_exit_flash_mode(target_s *t);
 static void lpc43x0_spi_abort(target_s *t);
+static void lpc43x0_spifi_memory_mode(target_s *t);
 static void lpc43x0_spi_read(target_s *target, uint16_t command, target_addr_t address, void *buffer, size_t length);
 static void lpc43x0_spi_write(
 	target_s *target, uint16_t command, target_addr_t address, const void *buffer, size_t length);
 static void lpc43x0_spi_run_command(target_s *target, uint16_t command, target_addr_t address);
+static bool lpc43x0_spifi_flash_erase(target_flash_s *flash, target_addr_t addr, size_t length);
+static bool lpc43x0_spifi_flash_write(target_flash_s *flash, target_addr_t dest, const void *src, size_t length);
+static void lpc43x0_spifi_mem_read(target_s *target, void *dest, target_addr_t src, size_t len);
 
 static bool lpc43xx_iap_init(target_flash_s *flash);
 static lpc43xx_partid_s lpc43xx_iap_read_partid(target_s *t);
@@ -413,6 +434,14 @@ static void lpc43x0_add_spi_flash(target_s *const target, const size_t length)
 	target_flash_s *const flash_low = &flash->flash_low.flash;
 	flash_low->start = LPC43x0_SPI_FLASH_LOW_BASE;
 	target_add_flash(target, flash_low);
+
+	/* On SPIFI, swap in the versions of erase and write that have the controller poll the Flash status */
+	if (priv->interface == FLASH_SPIFI) {
+		flash_low->erase = lpc43x0_spifi_flash_erase;
+		flash_low->write = lpc43x0_spifi_flash_write;
+		flash->flash_high->flash.erase = lpc43x0_spifi_flash_erase;
+		flash->flash_high->flash.write = lpc43x0_spifi_flash_write;
+	}
 }
 
 static void lpc43x0_detect(target_s *const t, const lpc43xx_partid_s part_id)
@@ -624,12 +653,11 @@ static bool lpc43x0_attach(target_s *const target)
 		return false;
 
 	if (!target->target_storage) {
-		lpc43x0_priv_s *priv = calloc(1, sizeof(lpc43x0_priv_s));
-		if (!priv) { /* calloc failed: heap exhaustion */
+		target->target_storage = calloc(1, sizeof(lpc43x0_priv_s));
+		if (!target->target_storage) { /* calloc failed: heap exhaustion */
 			DEBUG_ERROR("calloc: failed in %s\n", __func__);
 			return false;
 		}
-		target->target_storage = priv;
 
 		/*
 		 * Before we can go down a specific route here, we first have to figure out how the device was booted:
@@ -662,6 +690,20 @@ static bool lpc43x0_attach(target_s *const target)
 		lpc43x0_determine_flash_interface(target);
 	}
 
+	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)target->target_storage;
+	if (!priv->spifi_memory_command)
+		priv->spifi_memory_command = LPC43x0_SPIFI_DEFAULT_MEMORY_COMMAND;
+
+	if (priv->interface == FLASH_SPIFI) {
+		/* The firmware may have switched the SPIFI mode while we were detached, so re-read it every attach */
+		priv->spifi_memory_mode = target_mem_read32(target, LPC43x0_SPIFI_STAT) & LPC43x0_SPIFI_STATUS_MCINIT;
+		/* Make sure reads of the SPIFI windows always see the controller in memory mode */
+		if (target->mem_read != lpc43x0_spifi_mem_read) {
+			priv->mem_read = target->mem_read;
+			target->mem_read = lpc43x0_spifi_mem_read;
+		}
+	}
+
 	lpc43x0_enter_flash_mode(target);
 	spi_flash_id_s flash_id;
 	lpc43x0_spi_read(target, SPI_FLASH_CMD_READ_JEDEC_ID, 0, &flash_id, sizeof(flash_id));
@@ -681,6 +723,8 @@ static bool lpc43x0_attach(target_s *const target)
 static void lpc43x0_detach(target_s *const target)
 {
 	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)target->target_storage;
+	if (target->mem_read == lpc43x0_spifi_mem_read)
+		target->mem_read = priv->mem_read;
 	if (priv->flash) {
 		free(priv->flash->flash_high);
 		free(priv->flash);
@@ -764,7 +808,7 @@ static bool lpc43x0_exit_flash_mode(target_s *const t)
 	/* First restore any disturbed configuration */
 	switch (priv->interface) {
 	case FLASH_SPIFI:
-		target_mem_write32(t, LPC43x0_SPIFI_MCMD, priv->spifi_memory_command);
+		lpc43x0_spifi_memory_mode(t);
 		break;
 	default:
 		break;
@@ -797,14 +841,51 @@ static lpc43xx_partid_s lpc43x0_spi_read_partid(target_s *const t)
 	return result;
 }
 
+/*
+ * The SPIFI controller is switched between command and memory mode lazily, so that it stays in
+ * whichever mode it's in across a whole Flash session and only changes when the access type does.
+ * Leaving memory mode requires a controller reset.
+ */
+static void lpc43x0_spifi_command_mode(target_s *const t)
+{
+	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)t->target_storage;
+	if (!priv->spifi_memory_mode)
+		return;
+	target_mem_write32(t, LPC43x0_SPIFI_STAT, LPC43x0_SPIFI_STATUS_RESET);
+	while (target_mem_read32(t, LPC43x0_SPIFI_STAT) & LPC43x0_SPIFI_STATUS_RESET)
+		continue;
+	priv->spifi_memory_mode = false;
+}
+
+static void lpc43x0_spifi_memory_mode(target_s *const t)
+{
+	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)t->target_storage;
+	if (priv->spifi_memory_mode)
+		return;
+	target_mem_write32(t, LPC43x0_SPIFI_MCMD, priv->spifi_memory_command);
+	priv->spifi_memory_mode = true;
+}
+
+static void lpc43x0_spifi_mem_read(target_s *const target, void *const dest, const target_addr_t src, const size_t len)
+{
+	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)target->target_storage;
+	/*
+	 * Reads from either SPIFI window are done as bulk AP reads of the memory mapped Flash,
+	 * which needs the controller in memory mode, even if we're in the middle of a Flash session.
+	 */
+	if ((src >= LPC43x0_SPI_FLASH_LOW_BASE && src < LPC43x0_SPI_FLASH_LOW_BASE + LPC43x0_SPI_FLASH_LOW_SIZE) ||
+		(src >= LPC43x0_SPI_FLASH_HIGH_BASE && src < LPC43x0_SPI_FLASH_HIGH_BASE + LPC43x0_SPI_FLASH_HIGH_SIZE))
+		lpc43x0_spifi_memory_mode(target);
+	priv->mem_read(target, dest, src, len);
+}
+
 static void lpc43x0_spi_abort(target_s *const t)
 {
 	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)t->target_storage;
 	if (priv->interface == FLASH_SPIFI) {
 		/* If in SPIFI mode, reset the controller to get to a known state */
-		target_mem_write32(t, LPC43x0_SPIFI_STAT, LPC43x0_SPIFI_STATUS_RESET);
-		while (target_mem_read32(t, LPC43x0_SPIFI_STAT) & LPC43x0_SPIFI_STATUS_RESET)
-			continue;
+		priv->spifi_memory_mode = true;
+		lpc43x0_spifi_command_mode(t);
 	} else if (priv->interface == FLASH_SPI) {
 		/* If in SPI/SSP0 mode, first wait for the controller to finish transmitting all outstanding frames */
 		while (target_mem_read32(t, LPC43x0_SSP0_SR) & SPI43x0_SSP_SR_BSY)
@@ -851,6 +932,7 @@ static void lpc43x0_ssp0_setup_command(target_s *const t, const uint32_t command
 static void lpc43x0_spi_setup_xfer(
 	target_s *const target, const uint16_t command, const target_addr_t address, const size_t length)
 {
+	lpc43x0_spifi_command_mode(target);
 	/* Rebuild the command for the SPIFI controller */
 	uint32_t spifi_command = LPC43x0_SPIFI_CMD_SERIAL |
 		((command & SPI_FLASH_OPCODE_MASK) << LPC43x0_SPIFI_OPCODE_SHIFT) |
@@ -869,15 +951,31 @@ static void lpc43x0_spi_setup_xfer(
 	target_mem_write32(target, LPC43x0_SPIFI_CMD, spifi_command);
 }
 
+/*
+ * The SPIFI data FIFO can be accessed a word at a time, so stream data through it 4 bytes per access
+ * with FIFO accesses, picking up any tail a byte at a time
+ */
+static void lpc43x0_spifi_read_data(target_s *const target, uint8_t *const data, const size_t length)
+{
+	const size_t words = length & ~3U;
+	target_mem_read_fifo(target, data, LPC43x0_SPIFI_DATA, words, ALIGN_32BIT);
+	target_mem_read_fifo(target, data + words, LPC43x0_SPIFI_DATA, length - words, ALIGN_8BIT);
+}
+
+static void lpc43x0_spifi_write_data(target_s *const target, const uint8_t *const data, const size_t length)
+{
+	const size_t words = length & ~3U;
+	target_mem_write_fifo(target, LPC43x0_SPIFI_DATA, data, words, ALIGN_32BIT);
+	target_mem_write_fifo(target, LPC43x0_SPIFI_DATA, data + words, length - words, ALIGN_8BIT);
+}
+
 static void lpc43x0_spi_read(target_s *const target, const uint16_t command, const target_addr_t address,
 	void *const buffer, const size_t length)
 {
 	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)target->target_storage;
 	if (priv->interface == FLASH_SPIFI) {
 		lpc43x0_spi_setup_xfer(target, command, address, length);
-		uint8_t *const data = (uint8_t *)buffer;
-		for (size_t i = 0; i < length; ++i)
-			data[i] = target_mem_read8(target, LPC43x0_SPIFI_DATA);
+		lpc43x0_spifi_read_data(target, (uint8_t *)buffer, length);
 		lpc43x0_spi_wait_complete(target);
 	} else if (priv->interface == FLASH_SPI) {
 		/* Select the Flash */
@@ -899,9 +997,7 @@ static void lpc43x0_spi_write(target_s *const target, const uint16_t command, co
 	lpc43x0_priv_s *const priv = (lpc43x0_priv_s *)target->target_storage;
 	if (priv->interface == FLASH_SPIFI) {
 		lpc43x0_spi_setup_xfer(target, command, address, length);
-		const uint8_t *const data = (const uint8_t *)buffer;
-		for (size_t i = 0; i < length; ++i)
-			target_mem_write8(target, LPC43x0_SPIFI_DATA, data[i]);
+		lpc43x0_spifi_write_data(target, (const uint8_t *)buffer, length);
 		lpc43x0_spi_wait_complete(target);
 	} else if (priv->interface == FLASH_SPI) {
 		/* Select the Flash */
@@ -926,6 +1022,50 @@ static void lpc43x0_spi_run_command(target_s *const target, const uint16_t comma
 		lpc43x0_spi_write(target, command, address, NULL, 0U);
 }
 
+/*
+ * Have the SPIFI controller repeatedly read the Flash status register until the Flash is no longer busy,
+ * so that waiting for an operation to complete costs a single command rather than a status read per poll.
+ */
+static bool lpc43x0_spifi_wait_ready(target_s *const target)
+{
+	target_mem_write32(target, LPC43x0_SPIFI_CMD, LPC43x0_SPIFI_CMD_POLL_NOT_BUSY);
+	lpc43x0_spi_wait_complete(target);
+	/* Pop the status byte that satisfied the poll */
+	const uint8_t status = target_mem_read8(target, LPC43x0_SPIFI_DATA);
+	return !(status & SPI_FLASH_STATUS_BUSY) && !target_check_error(target);
+}
+
+static bool lpc43x0_spifi_flash_erase(target_flash_s *const flash, const target_addr_t addr, const size_t length)
+{
+	(void)length;
+	target_s *const target = flash->t;
+	const spi_flash_s *const spi_flash = (spi_flash_s *)flash;
+	lpc43x0_spi_run_command(target, SPI_FLASH_CMD_WRITE_ENABLE, 0U);
+	lpc43x0_spi_run_command(
+		target, SPI_FLASH_CMD_SECTOR_ERASE | SPI_FLASH_OPCODE(spi_flash->sector_erase_opcode), addr - flash->start);
+	return lpc43x0_spifi_wait_ready(target);
+}
+
+static bool lpc43x0_spifi_flash_write(
+	target_flash_s *const flash, const target_addr_t dest, const void *const src, const size_t length)
+{
+	target_s *const target = flash->t;
+	const spi_flash_s *const spi_flash = (spi_flash_s *)flash;
+	const target_addr_t begin = dest - flash->start;
+	const uint8_t *const buffer = (const uint8_t *)src;
+	for (size_t offset = 0; offset < length; offset += spi_flash->page_size) {
+		const size_t amount = MIN(length - offset, spi_flash->page_size);
+		/* Enable writes, stream the page through the data FIFO and let the controller wait for completion */
+		lpc43x0_spi_run_command(target, SPI_FLASH_CMD_WRITE_ENABLE, 0U);
+		lpc43x0_spi_setup_xfer(target, SPI_FLASH_CMD_PAGE_PROGRAM, begin + offset, amount);
+		lpc43x0_spifi_write_data(target, buffer + offset, amount);
+		lpc43x0_spi_wait_complete(target);
+		if (!lpc43x0_spifi_wait_ready(target))
+			return false;
+	}
+	return true;
+}
+
 /* LPC43xx IAP On-board Flash part routines */
 
 static bool lpc43xx_iap_init(target_flash_s *const target_flash)
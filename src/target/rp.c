@@ -57,6 +57,8 @@
 #define BOOTROM_MAGIC_MASK    0x00ffffffU
 #define BOOTROM_VERSION_SHIFT 24U
 #define RP_XIP_FLASH_BASE     0x10000000U
+#define RP_XIP_NOCACHE_BASE   0x13000000U
+#define RP_XIP_WINDOW_SIZE    0x01000000U
 #define RP_SRAM_BASE          0x20000000U
 #define RP_SRAM_SIZE          0x42000U
 
@@ -97,6 +99,7 @@
 #define RP_SSI_SR                              (RP_SSI_BASE_ADDR + 0x28U)
 #define RP_SSI_ICR                             (RP_SSI_BASE_ADDR + 0x48U)
 #define RP_SSI_DR0                             (RP_SSI_BASE_ADDR + 0x60U)
+#define RP_SSI_FIFO_DEPTH                      16U
 #define RP_SSI_XIP_SPI_CTRL0                   (RP_SSI_BASE_ADDR + 0xf4U)
 #define RP_SSI_CTRL0_FRF_MASK                  0x00600000U
 #define RP_SSI_CTRL0_FRF_SERIAL                (0U << 21U)
@@ -167,6 +170,7 @@ typedef struct rp_priv {
 	uint32_t ctrl0;
 	uint32_t ctrl1;
 	uint32_t xpi_ctrl0;
+	void (*cortexm_mem_read)(target_s *target, void *dest, target_addr_t src, size_t len);
 } rp_priv_s;
 
 static bool rp_cmd_erase_sector(target_s *target, int argc, const char **argv);
@@ -180,6 +184,7 @@ const command_s rp_cmd_list[] = {
 
 static bool rp_read_rom_func_table(target_s *target);
 static bool rp_attach(target_s *target);
+static void rp_mem_read(target_s *target, void *dest, target_addr_t src, size_t len);
 static void rp_spi_config(target_s *target);
 static void rp_spi_restore(target_s *target);
 static bool rp_flash_prepare(target_s *target);
@@ -234,6 +239,8 @@ bool rp_probe(target_s *target)
 		return false;
 	}
 	target->target_storage = (void *)priv_storage;
+	priv_storage->cortexm_mem_read = target->mem_read;
+	target->mem_read = rp_mem_read;
 
 	target->mass_erase = bmp_spi_mass_erase;
 	target->driver = "Raspberry RP2040";
@@ -258,6 +265,25 @@ static bool rp_attach(target_s *target)
 	return true;
 }
 
+/*
+ * Reads from the external Flash are redirected to the XIP no-cache, no-allocate alias. That way they
+ * neither get served stale data from nor evict the running program's lines in the XIP cache, and each
+ * one becomes a plain sequential block of AP reads against the SSI rather than a run of cache misses.
+ */
+static void rp_mem_read(target_s *const target, void *const dest, const target_addr_t src, const size_t len)
+{
+	rp_priv_s *const priv = (rp_priv_s *)target->target_storage;
+	if (src < RP_XIP_FLASH_BASE || src >= RP_XIP_FLASH_BASE + RP_XIP_WINDOW_SIZE) {
+		priv->cortexm_mem_read(target, dest, src, len);
+		return;
+	}
+	const size_t amount = MIN(len, RP_XIP_FLASH_BASE + RP_XIP_WINDOW_SIZE - src);
+	priv->cortexm_mem_read(target, dest, src - RP_XIP_FLASH_BASE + RP_XIP_NOCACHE_BASE, amount);
+	/* If the read runs off the end of the XIP window, do the remainder as normal */
+	if (amount < len)
+		priv->cortexm_mem_read(target, (uint8_t *)dest + amount, src + amount, len - amount);
+}
+
 /*
  * Parse out the ROM function table for routines we need.
  * Entries in the table are in pairs of 16-bit integers:
@@ -342,10 +368,33 @@ static void rp_spi_chip_select(target_s *const target, const uint32_t state)
 	target_mem_write32(target, RP_GPIO_QSPI_CS_CTRL, (value & ~RP_GPIO_QSPI_CS_DRIVE_MASK) | state);
 }
 
-static uint8_t rp_spi_xfer_data(target_s *const target, const uint8_t data)
+/*
+ * Clock a run of bytes out through the SSI, collecting the bytes clocked back in. If tx is NULL then
+ * zeroes are sent, and if rx is NULL the data read back is dropped. Each burst fills the TX FIFO with
+ * one FIFO access to DR0, waits for the frames to land in the RX FIFO, then drains it the same way.
+ */
+static void rp_spi_xfer_data(target_s *const target, const uint8_t *const tx, uint8_t *const rx, const size_t length)
 {
-	target_mem_write32(target, RP_SSI_DR0, data);
-	return target_mem_read32(target, RP_SSI_DR0) & 0xffU;
+	uint32_t fifo[RP_SSI_FIFO_DEPTH];
+	for (size_t offset = 0; offset < length;) {
+		const size_t amount = MIN(length - offset, RP_SSI_FIFO_DEPTH);
+		for (size_t i = 0; i < amount; ++i)
+			fifo[i] = tx ? tx[offset + i] : 0U;
+		target_mem_write_fifo(target, RP_SSI_DR0, fifo, amount * sizeof(uint32_t), ALIGN_32BIT);
+
+		platform_timeout_s timeout;
+		platform_timeout_set(&timeout, 100);
+		while (target_mem_read32(target, RP_SSI_RXFLR) < amount) {
+			if (target_check_error(target) || platform_timeout_is_expired(&timeout))
+				return;
+		}
+		target_mem_read_fifo(target, fifo, RP_SSI_DR0, amount * sizeof(uint32_t), ALIGN_32BIT);
+		if (rx) {
+			for (size_t i = 0; i < amount; ++i)
+				rx[offset + i] = fifo[i] & 0xffU;
+		}
+		offset += amount;
+	}
 }
 
 static void rp_spi_setup_xfer(
@@ -355,21 +404,19 @@ static void rp_spi_setup_xfer(
 	target_mem_write32(target, RP_SSI_CTRL1, length);
 	rp_spi_chip_select(target, RP_GPIO_QSPI_CS_DRIVE_LOW);
 
-	/* Set up the instruction */
-	const uint8_t opcode = command & SPI_FLASH_OPCODE_MASK;
-	rp_spi_xfer_data(target, opcode);
-
+	/* Build the instruction, address and dummy bytes so they can go out as a single burst */
+	uint8_t header[RP_SSI_FIFO_DEPTH] = {0};
+	size_t header_length = 0;
+	header[header_length++] = command & SPI_FLASH_OPCODE_MASK;
 	if ((command & SPI_FLASH_OPCODE_MODE_MASK) == SPI_FLASH_OPCODE_3B_ADDR) {
-		/* For each byte sent here, we have to manually clean up from the controller with a read */
-		rp_spi_xfer_data(target, (address >> 16U) & 0xffU);
-		rp_spi_xfer_data(target, (address >> 8U) & 0xffU);
-		rp_spi_xfer_data(target, address & 0xffU);
+		header[header_length++] = (address >> 16U) & 0xffU;
+		header[header_length++] = (address >> 8U) & 0xffU;
+		header[header_length++] = address & 0xffU;
 	}
-
-	const size_t inter_length = (command & SPI_FLASH_DUMMY_MASK) >> SPI_FLASH_DUMMY_SHIFT;
-	for (size_t i = 0; i < inter_length; ++i)
-		/* For each byte sent here, we have to manually clean up from the controller with a read */
-		rp_spi_xfer_data(target, 0);
+	/* The dummy bytes are already zero from the initialiser */
+	header_length += (command & SPI_FLASH_DUMMY_MASK) >> SPI_FLASH_DUMMY_SHIFT;
+	/* For each byte sent here, we have to manually clean up from the controller with a read */
+	rp_spi_xfer_data(target, header, NULL, header_length);
 }
 
 static void rp_spi_read(target_s *const target, const uint16_t command, const target_addr_t address, void *const buffer,
@@ -377,11 +424,8 @@ static void rp_spi_read(target_s *const target, const uint16_t command, const ta
 {
 	/* Setup the transaction */
 	rp_spi_setup_xfer(target, command, address, length);
-	/* Now read back the data that elicited */
-	uint8_t *const data = (uint8_t *const)buffer;
-	for (size_t i = 0; i < length; ++i)
-		/* Do a write to read */
-		data[i] = rp_spi_xfer_data(target, 0);
+	/* Now read back the data that elicited, doing a write to read */
+	rp_spi_xfer_data(target, NULL, (uint8_t *)buffer, length);
 	/* Deselect the Flash */
 	rp_spi_chip_select(target, RP_GPIO_QSPI_CS_DRIVE_HIGH);
 }
@@ -392,10 +436,7 @@ static void rp_spi_write(target_s *const target, const uint16_t command, const t
 	/* Setup the transaction */
 	rp_spi_setup_xfer(target, command, address, length);
 	/* Now write out back the data requested */
-	uint8_t *const data = (uint8_t *const)buffer;
-	for (size_t i = 0; i < length; ++i)
-		/* Do a write to read */
-		rp_spi_xfer_data(target, data[i]);
+	rp_spi_xfer_data(target, (const uint8_t *)buffer, NULL, length);
 	/* Deselect the Flash */
 	rp_spi_chip_select(target, RP_GPIO_QSPI_CS_DRIVE_HIGH);
 }
@@ -494,27 +535,36 @@ static void rp_flash_put_get(
 	// Make sure there is never more data in flight than the depth of the RX
 	// FIFO. Otherwise, when we are interrupted for long periods, hardware
 	// will overflow the RX FIFO.
-	static const size_t max_in_flight = 16U - 2U; // account for data internal to SSI
+	static const size_t max_in_flight = RP_SSI_FIFO_DEPTH - 2U; // account for data internal to SSI
 	size_t tx_count = 0;
 	size_t rx_count = 0;
+	uint32_t fifo[RP_SSI_FIFO_DEPTH];
 	while (tx_count < count || rx_count < count || rx_skip) {
 		// NB order of reads, for pessimism rather than optimism
 		const uint32_t tx_level = target_mem_read32(target, RP_SSI_TXFLR);
-		const uint32_t rx_level = target_mem_read32(target, RP_SSI_RXFLR);
+		const uint32_t rx_level = MIN(target_mem_read32(target, RP_SSI_RXFLR), RP_SSI_FIFO_DEPTH);
 		bool idle = true; // Expect this to be folded into control flow, not register
-		if (tx_count < count && tx_level + rx_level < max_in_flight) {
-			target_mem_write32(target, RP_SSI_DR0, (uint32_t)(tx ? tx[tx_count] : 0));
-			++tx_count;
+		// Top the TX FIFO up as far as is safe in one burst of FIFO accesses
+		const size_t in_flight = tx_level + rx_level;
+		const size_t tx_burst = in_flight < max_in_flight ? MIN(count - tx_count, max_in_flight - in_flight) : 0U;
+		if (tx_burst) {
+			for (size_t i = 0; i < tx_burst; ++i)
+				fifo[i] = tx ? tx[tx_count + i] : 0U;
+			target_mem_write_fifo(target, RP_SSI_DR0, fifo, tx_burst * sizeof(uint32_t), ALIGN_32BIT);
+			tx_count += tx_burst;
 			idle = false;
 		}
+		// Then drain everything that was waiting in the RX FIFO the same way
 		if (rx_level) {
-			const uint8_t data = target_mem_read32(target, RP_SSI_DR0);
-			if (rx_skip)
-				--rx_skip;
-			else {
-				if (rx)
-					rx[rx_count] = data;
-				++rx_count;
+			target_mem_read_fifo(target, fifo, RP_SSI_DR0, rx_level * sizeof(uint32_t), ALIGN_32BIT);
+			for (size_t i = 0; i < rx_level; ++i) {
+				if (rx_skip)
+					--rx_skip;
+				else {
+					if (rx && rx_count < count)
+						rx[rx_count] = fifo[i] & 0xffU;
+					++rx_count;
+				}
 			}
 			idle = false;
 		}
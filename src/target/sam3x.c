@@ -32,6 +32,7 @@
 static bool sam_flash_erase(target_flash_s *f, target_addr_t addr, size_t len);
 static bool sam3_flash_erase(target_flash_s *f, target_addr_t addr, size_t len);
 static bool sam_flash_write(target_flash_s *f, target_addr_t dest, const void *src, size_t len);
+static bool sam_flash_done(target_flash_s *f);
 
 static bool sam_gpnvm_get(target_s *t, uint32_t base, uint32_t *gpnvm);
 
@@ -174,6 +175,7 @@ typedef struct sam_flash {
 	target_flash_s f;
 	uint32_t eefc_base;
 	uint8_t write_cmd;
+	bool busy; /* A command has been issued to the EEFC that we have not yet waited on */
 } sam_flash_s;
 
 typedef struct samx7x_descr {
@@ -205,6 +207,7 @@ static void sam3_add_flash(target_s *t, uint32_t eefc_base, uint32_t addr, size_
 	f->blocksize = SAM_SMALL_PAGE_SIZE;
 	f->erase = sam3_flash_erase;
 	f->write = sam_flash_write;
+	f->done = sam_flash_done;
 	f->writesize = SAM_SMALL_PAGE_SIZE;
 	sf->eefc_base = eefc_base;
 	sf->write_cmd = EEFC_FCR_FCMD_EWP;
@@ -225,6 +228,7 @@ static void sam_add_flash(target_s *t, uint32_t eefc_base, uint32_t addr, size_t
 	f->blocksize = SAM_LARGE_PAGE_SIZE * 8U;
 	f->erase = sam_flash_erase;
 	f->write = sam_flash_write;
+	f->done = sam_flash_done;
 	f->writesize = SAM_LARGE_PAGE_SIZE;
 	sf->eefc_base = eefc_base;
 	sf->write_cmd = EEFC_FCR_FCMD_WP;
@@ -481,15 +485,15 @@ bool sam3x_probe(target_s *t)
 	return false;
 }
 
-static bool sam_flash_cmd(target_s *t, uint32_t base, uint8_t cmd, uint16_t arg)
+static void sam_flash_cmd_start(target_s *t, uint32_t base, uint8_t cmd, uint16_t arg)
 {
 	DEBUG_INFO("%s: base = 0x%08" PRIx32 " cmd = 0x%02X, arg = 0x%04X\n", __func__, base, cmd, arg);
-
-	if (base == 0)
-		return false;
-
 	target_mem_write32(t, EEFC_FCR(base), EEFC_FCR_FKEY | cmd | ((uint32_t)arg << 8U));
+}
 
+static bool sam_flash_wait(target_s *t, uint32_t base)
+{
+	/* The error flags are cleared by reading FSR, so only the final read's value is meaningful */
 	uint32_t status = 0;
 	while (!(status & EEFC_FSR_FRDY)) {
 		status = target_mem_read32(t, EEFC_FSR(base));
@@ -499,6 +503,37 @@ static bool sam_flash_cmd(target_s *t, uint32_t base, uint8_t cmd, uint16_t arg)
 	return !(status & EEFC_FSR_ERROR);
 }
 
+static bool sam_flash_cmd(target_s *t, uint32_t base, uint8_t cmd, uint16_t arg)
+{
+	if (base == 0)
+		return false;
+
+	sam_flash_cmd_start(t, base, cmd, arg);
+	return sam_flash_wait(t, base);
+}
+
+/*
+ * Flash commands are issued without waiting for them to complete so that the host can get on with
+ * preparing the next operation while the EEFC is busy. The EEFC itself can't overlap anything with a
+ * running command, so this waits out and reports the result of any outstanding one first.
+ */
+static bool sam_flash_ready(sam_flash_s *const sf)
+{
+	if (!sf->busy)
+		return true;
+	sf->busy = false;
+	return sam_flash_wait(sf->f.t, sf->eefc_base);
+}
+
+static bool sam_flash_issue(sam_flash_s *const sf, const uint8_t cmd, const uint16_t arg)
+{
+	if (sf->eefc_base == 0)
+		return false;
+	sam_flash_cmd_start(sf->f.t, sf->eefc_base, cmd, arg);
+	sf->busy = true;
+	return true;
+}
+
 static sam_driver_e sam_driver(target_s *t)
 {
 	if (strcmp(t->driver, "Atmel SAM3X") == 0)
@@ -514,8 +549,7 @@ static sam_driver_e sam_driver(target_s *t)
 
 static bool sam_flash_erase(target_flash_s *f, target_addr_t addr, size_t len)
 {
-	target_s *t = f->t;
-	const uint32_t base = ((sam_flash_s *)f)->eefc_base;
+	sam_flash_s *const sf = (sam_flash_s *)f;
 
 	/* The SAM4S is the only supported device with a page erase command.
 	 * Erasing is done in 8-page chunks. arg[15:2] contains the page
@@ -524,12 +558,11 @@ static bool sam_flash_erase(target_flash_s *f, target_addr_t addr, size_t len)
 	uint32_t chunk = (addr - f->start) / SAM_LARGE_PAGE_SIZE;
 
 	for (size_t offset = 0; offset < len; offset += f->blocksize) {
-		int16_t arg = chunk | 0x1U;
-		if (!sam_flash_cmd(t, base, EEFC_FCR_FCMD_EPA, arg))
+		if (!sam_flash_ready(sf) || !sam_flash_issue(sf, EEFC_FCR_FCMD_EPA, chunk | 0x1U))
 			return false;
 		chunk += 8U;
 	}
-	return true;
+	return !target_check_error(f->t);
 }
 
 static bool sam3_flash_erase(target_flash_s *f, target_addr_t addr, size_t len)
@@ -548,11 +581,20 @@ static bool sam_flash_write(target_flash_s *f, target_addr_t dest, const void *s
 {
 	target_s *const t = f->t;
 	sam_flash_s *const sf = (sam_flash_s *)f;
-	const uint32_t base = sf->eefc_base;
 	const uint32_t chunk = (dest - f->start) / f->writesize;
 
+	/* The page latch can't be loaded until the previous command completes, so wait that out here */
+	if (!sam_flash_ready(sf))
+		return false;
 	target_mem_write(t, dest, src, len);
-	return sam_flash_cmd(t, base, sf->write_cmd, chunk);
+	if (!sam_flash_issue(sf, sf->write_cmd, chunk))
+		return false;
+	return !target_check_error(t);
+}
+
+static bool sam_flash_done(target_flash_s *f)
+{
+	return sam_flash_ready((sam_flash_s *)f);
 }
 
 static bool sam_gpnvm_get(target_s *t, uint32_t base, uint32_t *gpnvm)
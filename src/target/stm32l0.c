@@ -44,6 +44,13 @@
 		detecting them.  If we don't then we always must wait for the NVM
 		module to complete the last operation before we can start another.
 
+	o Sessions.  PECR is unlocked and configured once per Flash operation
+		by the prepare hooks and re-locked by stm32lx_nvm_done().  Program
+		Flash is written a half-page (16 words on the L0, 32 on the L1) at a
+		time using FPRG, and EEPROM words are streamed back to back, relying
+		on the NVM stalling the bus while the previous word programs.  Errors
+		are checked once, at the end of the session.
+
 	o There are minor inconsistencies between the stm32l0 and the
 		stm32l1 in when handling NVM operations.
 
@@ -124,12 +131,16 @@
 #define STM32L0_DBGMCU_IDCODE_PHYS UINT32_C(0x40015800)
 #define STM32L1_DBGMCU_IDCODE_PHYS UINT32_C(0xe0042000)
 
+static bool stm32lx_nvm_prog_prepare(target_flash_s *flash);
 static bool stm32lx_nvm_prog_erase(target_flash_s *flash, target_addr_t addr, size_t length);
 static bool stm32lx_nvm_prog_write(target_flash_s *flash, target_addr_t dest, const void *src, size_t length);
 
+static bool stm32lx_nvm_data_prepare(target_flash_s *flash);
 static bool stm32lx_nvm_data_erase(target_flash_s *flash, target_addr_t addr, size_t length);
 static bool stm32lx_nvm_data_write(target_flash_s *flash, target_addr_t dest, const void *src, size_t length);
 
+static bool stm32lx_nvm_done(target_flash_s *flash);
+
 static bool stm32lx_protected_attach(target_s *target);
 static bool stm32lx_protected_mass_erase(target_s *target);
 static bool stm32lx_mass_erase(target_s *target);
@@ -194,8 +205,11 @@ static void stm32l_add_flash(target_s *const target, const uint32_t addr, const
 	flash->start = addr;
 	flash->length = length;
 	flash->blocksize = erasesize;
+	flash->prepare = stm32lx_nvm_prog_prepare;
 	flash->erase = stm32lx_nvm_prog_erase;
 	flash->write = stm32lx_nvm_prog_write;
+	flash->done = stm32lx_nvm_done;
+	/* Program Flash is written a half-page at a time */
 	flash->writesize = erasesize >> 1U;
 	target_add_flash(target, flash);
 }
@@ -211,8 +225,10 @@ static void stm32l_add_eeprom(target_s *const target, const uint32_t addr, const
 	flash->start = addr;
 	flash->length = length;
 	flash->blocksize = 4;
+	flash->prepare = stm32lx_nvm_data_prepare;
 	flash->erase = stm32lx_nvm_data_erase;
 	flash->write = stm32lx_nvm_data_write;
+	flash->done = stm32lx_nvm_done;
 	target_add_flash(target, flash);
 }
 
@@ -307,7 +323,8 @@ static bool stm32lx_nvm_opt_unlock(target_s *const target, const uint32_t nvm)
 	return !(target_mem_read32(target, STM32Lx_NVM_PECR(nvm)) & STM32Lx_NVM_PECR_OPTLOCK);
 }
 
-static bool stm32lx_nvm_busy_wait(target_s *const target, const uint32_t nvm, platform_timeout_s *const timeout)
+/* Wait for the NVM to go idle, returning false only if communications with the target failed */
+static bool stm32lx_nvm_wait_idle(target_s *const target, const uint32_t nvm, platform_timeout_s *const timeout)
 {
 	while (target_mem_read32(target, STM32Lx_NVM_SR(nvm)) & STM32Lx_NVM_SR_BSY) {
 		if (target_check_error(target))
@@ -315,139 +332,135 @@ static bool stm32lx_nvm_busy_wait(target_s *const target, const uint32_t nvm, pl
 		if (timeout)
 			target_print_progress(timeout);
 	}
+	return !target_check_error(target);
+}
+
+static bool stm32lx_nvm_busy_wait(target_s *const target, const uint32_t nvm, platform_timeout_s *const timeout)
+{
+	if (!stm32lx_nvm_wait_idle(target, nvm, timeout))
+		return false;
 	const uint32_t status = target_mem_read32(target, STM32Lx_NVM_SR(nvm));
 	return !target_check_error(target) && !(status & STM32Lx_NVM_SR_ERR_M);
 }
 
+/*
+ * Unlock the NVM and put PECR into the requested mode for the rest of the Flash session.
+ * The NVM must be idle before PECR can be changed on the STM32L1, and clearing the
+ * errors in SR only works once the previous operation has completed, so wait for that first.
+ */
+static bool stm32lx_nvm_session_begin(target_s *const target, const uint32_t nvm, const uint32_t mode)
+{
+	if (!stm32lx_nvm_prog_data_unlock(target, nvm) || !stm32lx_nvm_wait_idle(target, nvm, NULL))
+		return false;
+
+	target_mem_write32(target, STM32Lx_NVM_SR(nvm), STM32Lx_NVM_SR_ERR_M);
+	target_mem_write32(target, STM32Lx_NVM_PECR(nvm), mode);
+	return (target_mem_read32(target, STM32Lx_NVM_PECR(nvm)) & mode) == mode && !target_check_error(target);
+}
+
+/* Prepare program Flash for either page erasing or half-page programming */
+static bool stm32lx_nvm_prog_prepare(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	uint32_t mode = STM32Lx_NVM_PECR_PROG | STM32Lx_NVM_PECR_FPRG;
+	if (flash->operation == FLASH_OPERATION_ERASE)
+		mode = STM32Lx_NVM_PECR_ERASE | STM32Lx_NVM_PECR_PROG;
+	return stm32lx_nvm_session_begin(target, stm32lx_nvm_phys(target), mode);
+}
+
+/* Prepare data Flash (EEPROM) for either word erasing or word programming */
+static bool stm32lx_nvm_data_prepare(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	uint32_t mode = stm32lx_is_stm32l1(target) ? 0U : STM32Lx_NVM_PECR_DATA;
+	if (flash->operation == FLASH_OPERATION_ERASE)
+		mode = STM32Lx_NVM_PECR_ERASE | STM32Lx_NVM_PECR_DATA;
+	return stm32lx_nvm_session_begin(target, stm32lx_nvm_phys(target), mode);
+}
+
+/*
+ * Finish a Flash session: wait for the last queued operation to complete, check
+ * the accumulated error state once, and re-lock PECR.
+ */
+static bool stm32lx_nvm_done(target_flash_s *const flash)
+{
+	target_s *const target = flash->t;
+	const uint32_t nvm = stm32lx_nvm_phys(target);
+
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, 500);
+	const bool result = stm32lx_nvm_busy_wait(target, nvm, &timeout);
+
+	/* Disable further programming by locking PECR */
+	stm32lx_nvm_lock(target, nvm);
+	return result;
+}
+
 /*
  * Erase a region of program flash using operations through the debug interface.
  * This is slower than stubbed versions (see NOTES).
  * The flash array is erased for all pages from addr to addr + length inclusive.
- * The NVM register base is automatically determined based on the target.
+ * PECR must already be set up for page erase by stm32lx_nvm_prog_prepare().
  */
 static bool stm32lx_nvm_prog_erase(target_flash_s *const flash, const target_addr_t addr, const size_t length)
 {
 	target_s *const target = flash->t;
-	const uint32_t nvm = stm32lx_nvm_phys(target);
 	const bool full_erase = addr == flash->start && length == flash->length;
-	if (!stm32lx_nvm_prog_data_unlock(target, nvm))
-		return false;
-
-	/* Flash page erase instruction */
-	target_mem_write32(target, STM32Lx_NVM_PECR(nvm), STM32Lx_NVM_PECR_ERASE | STM32Lx_NVM_PECR_PROG);
-
-	const uint32_t pecr =
-		target_mem_read32(target, STM32Lx_NVM_PECR(nvm)) & (STM32Lx_NVM_PECR_PROG | STM32Lx_NVM_PECR_ERASE);
-	if (pecr != (STM32Lx_NVM_PECR_PROG | STM32Lx_NVM_PECR_ERASE))
-		return false;
-
-	/*
-	 * Clear errors.
-	 * Note that this only works when we wait for the NVM block to complete the last operation.
-	 */
-	target_mem_write32(target, STM32Lx_NVM_SR(nvm), STM32Lx_NVM_SR_ERR_M);
 
 	platform_timeout_s timeout;
 	platform_timeout_set(&timeout, 500);
+	/*
+	 * Trigger the erase of each page by writing the first uint32_t of the page to 0.
+	 * The NVM stalls the bus while the previous page erase is in progress, so no polling is needed here.
+	 */
 	for (size_t offset = 0; offset < length; offset += flash->blocksize) {
-		/* Trigger the erase by writing the first uint32_t of the page to 0 */
 		target_mem_write32(target, addr + offset, 0U);
 		if (full_erase)
 			target_print_progress(&timeout);
 	}
-
-	/* Disable further programming by locking PECR */
-	stm32lx_nvm_lock(target, nvm);
-	/* Wait for completion or an error */
-	return stm32lx_nvm_busy_wait(target, nvm, full_erase ? &timeout : NULL);
+	return !target_check_error(target);
 }
 
-/* Write to program flash using operations through the debug interface. */
+/*
+ * Write a half-page to program flash using operations through the debug interface.
+ * PECR must already be set up for half-page programming by stm32lx_nvm_prog_prepare(),
+ * after which the whole half-page goes out as a single bulk transfer.
+ */
 static bool stm32lx_nvm_prog_write(
 	target_flash_s *const flash, const target_addr_t dest, const void *const src, const size_t length)
 {
 	target_s *const target = flash->t;
-	const uint32_t nvm = stm32lx_nvm_phys(target);
-
-	if (!stm32lx_nvm_prog_data_unlock(target, nvm))
-		return false;
-
-	/* Wait for BSY to clear because we cannot write the PECR until the previous operation completes */
-	if (!stm32lx_nvm_busy_wait(target, nvm, NULL))
-		return false;
-
-	target_mem_write32(target, STM32Lx_NVM_PECR(nvm), STM32Lx_NVM_PECR_PROG | STM32Lx_NVM_PECR_FPRG);
 	target_mem_write(target, dest, src, length);
-
-	/* Disable further programming by locking PECR */
-	stm32lx_nvm_lock(target, nvm);
-
-	/* Wait for completion or an error */
-	return stm32lx_nvm_busy_wait(target, nvm, NULL);
+	/* The next half-page can't be loaded until this one is programmed */
+	return stm32lx_nvm_busy_wait(target, stm32lx_nvm_phys(target), NULL);
 }
 
 /*
  * Erase a region of data flash using operations through the debug interface.
- * The flash is erased for all pages from addr to addr + length, inclusive, on a word boundary.
- * The NVM register base is automatically determined based on the target.
+ * The flash is erased for all words from addr to addr + length, inclusive, on a word boundary.
+ * PECR must already be set up for data erase by stm32lx_nvm_data_prepare().
  */
 static bool stm32lx_nvm_data_erase(target_flash_s *const flash, const target_addr_t addr, const size_t length)
 {
 	target_s *const target = flash->t;
-	const uint32_t nvm = stm32lx_nvm_phys(target);
-	if (!stm32lx_nvm_prog_data_unlock(target, nvm))
-		return false;
-
-	/* Flash data erase instruction */
-	target_mem_write32(target, STM32Lx_NVM_PECR(nvm), STM32Lx_NVM_PECR_ERASE | STM32Lx_NVM_PECR_DATA);
-
-	const uint32_t pecr =
-		target_mem_read32(target, STM32Lx_NVM_PECR(nvm)) & (STM32Lx_NVM_PECR_ERASE | STM32Lx_NVM_PECR_DATA);
-	if (pecr != (STM32Lx_NVM_PECR_ERASE | STM32Lx_NVM_PECR_DATA))
-		return false;
-
 	const uint32_t aligned_addr = addr & ~3U;
 	for (size_t offset = 0; offset < length; offset += flash->blocksize)
-		/* Trigger the erase by writing the first uint32_t of the page to 0 */
+		/* Trigger the erase by writing the word to 0 */
 		target_mem_write32(target, aligned_addr + offset, 0U);
-
-	/* Disable further programming by locking PECR */
-	stm32lx_nvm_lock(target, nvm);
-
-	/* Wait for completion or an error */
-	return stm32lx_nvm_busy_wait(target, nvm, NULL);
+	return !target_check_error(target);
 }
 
 /*
  * Write to data flash using operations through the debug interface.
- * The NVM register base is automatically determined based on the target.
- * Unaligned destination writes are supported (though unaligned sources are not).
+ * PECR must already be set up for data programming by stm32lx_nvm_data_prepare().
+ * The NVM stalls the bus while each word programs, so the data is handed over as one bulk
+ * transfer and the error state is only checked when the session completes in stm32lx_nvm_done().
  */
 static bool stm32lx_nvm_data_write(
 	target_flash_s *const flash, const target_addr_t dest, const void *const src, const size_t length)
 {
-	target_s *const target = flash->t;
-	const uint32_t nvm = stm32lx_nvm_phys(target);
-	const bool is_stm32l1 = stm32lx_is_stm32l1(target);
-
-	if (!stm32lx_nvm_prog_data_unlock(target, nvm))
-		return false;
-
-	target_mem_write32(target, STM32Lx_NVM_PECR(nvm), is_stm32l1 ? 0 : STM32Lx_NVM_PECR_DATA);
-
-	/* Sling data to the target one uint32_t at a time */
-	const uint32_t *const data = (const uint32_t *)src;
-	for (size_t offset = 0; offset < length; offset += 4U) {
-		/* XXX: Why is this not able to use target_mem_write()? */
-		target_mem_write32(target, dest + offset, data[offset]);
-		if (target_check_error(target))
-			return false;
-	}
-
-	/* Disable further programming by locking PECR */
-	stm32lx_nvm_lock(target, nvm);
-	/* Wait for completion or an error */
-	return stm32lx_nvm_busy_wait(target, nvm, NULL);
+	target_mem_write(flash->t, dest, src, length);
+	return true;
 }
 
 static bool stm32lx_protected_attach(target_s *const target)
@@ -482,8 +495,13 @@ static bool stm32lx_protected_mass_erase(target_s *const target)
 static bool stm32lx_mass_erase(target_s *const target)
 {
 	for (target_flash_s *flash = target->flash; flash; flash = flash->next) {
-		const int result = stm32lx_nvm_prog_erase(flash, flash->start, flash->length);
-		if (result != 0)
+		if (flash->erase != stm32lx_nvm_prog_erase)
+			continue;
+		flash->operation = FLASH_OPERATION_ERASE;
+		const bool result =
+			stm32lx_nvm_prog_prepare(flash) && stm32lx_nvm_prog_erase(flash, flash->start, flash->length);
+		flash->operation = FLASH_OPERATION_NONE;
+		if (!stm32lx_nvm_done(flash) || !result)
 			return false;
 	}
 	return true;
@@ -510,33 +528,37 @@ static bool stm32lx_option_write(target_s *const target, const uint32_t address,
 }
 
 /*
- * Write one eeprom value.
+ * Write a run of eeprom values.
  * This version is more flexible than that bulk version used for writing data from the executable file.
- * The address is the physical address of the word and the value is a complete word value.
- * The function returns when the operation is complete.
- * The return value is true if the write succeeded.
- * FWIW, byte writing isn't supported because the ADIv5 layer doesn't support byte-level operations.
+ * The address is the physical address of the first value and each value is written to the next
+ * block_size-aligned location. SR is cleared and PECR is set up once for the whole run, the values
+ * then go out back to back (the NVM stalls the bus while each one programs) and the result is
+ * checked once when the final value completes.
+ * The return value is true if all the writes succeeded.
  */
-static bool stm32lx_eeprom_write(
-	target_s *const target, const uint32_t address, const size_t block_size, const uint32_t value)
+static bool stm32lx_eeprom_write(target_s *const target, const uint32_t address, const size_t block_size,
+	const uint32_t *const values, const size_t count)
 {
 	const uint32_t nvm = stm32lx_nvm_phys(target);
 	const bool is_stm32l1 = stm32lx_is_stm32l1(target);
 
-	/* Clear errors. */
-	target_mem_write32(target, STM32Lx_NVM_SR(nvm), STM32Lx_NVM_SR_ERR_M);
+	if (block_size != 4U && block_size != 2U && block_size != 1U)
+		return false;
 
-	/* Erase and program option in one go. */
-	target_mem_write32(target, STM32Lx_NVM_PECR(nvm), (is_stm32l1 ? 0 : STM32Lx_NVM_PECR_DATA) | STM32Lx_NVM_PECR_FIX);
-	if (block_size == 4)
-		target_mem_write32(target, address, value);
-	else if (block_size == 2)
-		target_mem_write16(target, address, value);
-	else if (block_size == 1)
-		target_mem_write8(target, address, value);
-	else
+	/* Erase and program in one go. */
+	if (!stm32lx_nvm_session_begin(target, nvm, (is_stm32l1 ? 0 : STM32Lx_NVM_PECR_DATA) | STM32Lx_NVM_PECR_FIX))
 		return false;
 
+	for (size_t idx = 0; idx < count; ++idx) {
+		const uint32_t value_addr = address + (idx * block_size);
+		if (block_size == 4U)
+			target_mem_write32(target, value_addr, values[idx]);
+		else if (block_size == 2U)
+			target_mem_write16(target, value_addr, values[idx]);
+		else
+			target_mem_write8(target, value_addr, values[idx]);
+	}
+
 	/* Wait for completion or an error */
 	return stm32lx_nvm_busy_wait(target, nvm, NULL);
 }
@@ -635,6 +657,8 @@ static const char *stm32lx_block_size_str(const size_t block_size)
 	return "";
 }
 
+#define STM32Lx_EEPROM_CMD_MAX_VALUES 16U
+
 static bool stm32lx_cmd_eeprom(target_s *const target, const int argc, const char **const argv)
 {
 	const uint32_t nvm = stm32lx_nvm_phys(target);
@@ -644,37 +668,39 @@ static bool stm32lx_cmd_eeprom(target_s *const target, const int argc, const cha
 		return true;
 	}
 
-	if (argc == 4) {
-		uint32_t addr = strtoul(argv[2], NULL, 0);
-		uint32_t val = strtoul(argv[3], NULL, 0);
-
-		if (addr < STM32Lx_NVM_EEPROM_PHYS || addr >= STM32Lx_NVM_EEPROM_PHYS + stm32lx_nvm_eeprom_size(target))
-			goto usage;
+	if (argc >= 4 && (size_t)(argc - 3) <= STM32Lx_EEPROM_CMD_MAX_VALUES) {
+		const uint32_t addr = strtoul(argv[2], NULL, 0);
+		const size_t count = (size_t)argc - 3U;
 
 		const size_t command_len = strlen(argv[1]);
 		size_t block_size = 0U;
+		uint32_t mask = UINT32_MAX;
 		if (!strncasecmp(argv[1], "byte", command_len)) {
-			val &= 0xffU;
+			mask = 0xffU;
 			block_size = 1U;
 		} else if (!strncasecmp(argv[1], "halfword", command_len)) {
-			val &= 0xffffU;
+			mask = 0xffffU;
 			block_size = 2U;
-			if (addr & 1U) {
-				tc_printf(target, "Refusing to do unaligned write\n");
-				goto usage;
-			}
-		} else if (!strncasecmp(argv[1], "word", command_len)) {
+		} else if (!strncasecmp(argv[1], "word", command_len))
 			block_size = 4U;
-			if (addr & 3U) {
-				tc_printf(target, "Refusing to do unaligned write\n");
-				goto usage;
-			}
-		} else
+		else
+			goto usage;
+
+		if (addr & (block_size - 1U)) {
+			tc_printf(target, "Refusing to do unaligned write\n");
+			goto usage;
+		}
+		if (addr < STM32Lx_NVM_EEPROM_PHYS ||
+			addr + (count * block_size) > STM32Lx_NVM_EEPROM_PHYS + stm32lx_nvm_eeprom_size(target))
 			goto usage;
 
-		tc_printf(
-			target, "writing %s 0x%08" PRIx32 " with 0x%" PRIx32 "\n", stm32lx_block_size_str(block_size), addr, val);
-		if (!stm32lx_eeprom_write(target, addr, block_size, val))
+		uint32_t values[STM32Lx_EEPROM_CMD_MAX_VALUES];
+		for (size_t idx = 0; idx < count; ++idx) {
+			values[idx] = strtoul(argv[3U + idx], NULL, 0) & mask;
+			tc_printf(target, "writing %s 0x%08" PRIx32 " with 0x%" PRIx32 "\n", stm32lx_block_size_str(block_size),
+				(uint32_t)(addr + (idx * block_size)), values[idx]);
+		}
+		if (!stm32lx_eeprom_write(target, addr, block_size, values, count))
 			tc_printf(target, "eeprom write failed\n");
 	} else
 		goto usage;
@@ -683,9 +709,10 @@ static bool stm32lx_cmd_eeprom(target_s *const target, const int argc, const cha
 
 usage:
 	tc_printf(target, "usage: monitor eeprom [ARGS]\n");
-	tc_printf(target, "  byte     <addr> <value8>  - Write a byte\n");
-	tc_printf(target, "  halfword <addr> <value16> - Write a half-word\n");
-	tc_printf(target, "  word     <addr> <value32> - Write a word\n");
+	tc_printf(target, "  byte     <addr> <value8>...  - Write bytes\n");
+	tc_printf(target, "  halfword <addr> <value16>... - Write half-words\n");
+	tc_printf(target, "  word     <addr> <value32>... - Write words\n");
+	tc_printf(target, "Up to %u consecutive values may be written in one go\n", STM32Lx_EEPROM_CMD_MAX_VALUES);
 	tc_printf(target, "The value of <addr> must in the interval [0x%08x, 0x%x)\n", STM32Lx_NVM_EEPROM_PHYS,
 		STM32Lx_NVM_EEPROM_PHYS + stm32lx_nvm_eeprom_size(target));
 
@@ -31,12 +31,21 @@
 #include "target.h"
 #include "target_internal.h"
 #include "cortexm.h"
+#include "cortex.h"
+#include "adiv5.h"
 
 /* Memory map constants for STM32MP15x */
 #define STM32MP15_CM4_RETRAM_BASE  0x00000000U
-#define STM32MP15_RETRAM_SIZE      0x00001000U /* RETRAM, 64 KiB */
+#define STM32MP15_RETRAM_SIZE      0x00010000U /* RETRAM, 64 KiB */
 #define STM32MP15_CM4_AHBSRAM_BASE 0x10000000U
 #define STM32MP15_AHBSRAM_SIZE     0x00060000U /* AHB SRAM 1+2+3+4, 128+128+64+64 KiB */
+#define STM32MP15_CM4_RETRAM_END   (STM32MP15_CM4_RETRAM_BASE + STM32MP15_RETRAM_SIZE)
+#define STM32MP15_CM4_AHBSRAM_END  (STM32MP15_CM4_AHBSRAM_BASE + STM32MP15_AHBSRAM_SIZE)
+
+/* The same memories as seen from the Cortex-A7 side of the system, over the AXI-AP (AP0) */
+#define STM32MP15_AXI_AP           0U
+#define STM32MP15_AXI_RETRAM_BASE  0x38000000U
+#define STM32MP15_AXI_AHBSRAM_BASE 0x10000000U
 
 /* Access from processor address space.
  * Access via the debug APB is at 0xe0081000 over AP1. */
@@ -49,6 +58,13 @@
 #define DBGMCU_CTRL_DBGSTOP  (1U << 1U)
 #define DBGMCU_CTRL_DBGSTBY  (1U << 2U)
 
+/* Cortex-M4 boot and reset control from §10.7 of RM0436 rev 6 */
+#define STM32MP15_RCC_BASE   0x50000000U
+#define RCC_MP_GCR           (STM32MP15_RCC_BASE + 0x10cU)
+#define RCC_MP_GCR_BOOT_MCU  (1U << 0U)
+#define RCC_MP_GRSTCSETR     (STM32MP15_RCC_BASE + 0x404U)
+#define RCC_MP_GRSTCSETR_MCU (1U << 1U)
+
 /* Taken from DP_TARGETID.TPARTNO = 0x5000 in §66.8.3 of RM0436 rev 6, pg3669 */
 /* Taken from DBGMCU_IDC.DEV_ID = 0x500 in §66.10.9 of RM0436 rev 6, pg3825 */
 #define ID_STM32MP15x 0x5000U
@@ -57,17 +73,85 @@
 
 typedef struct stm32mp15_priv {
 	uint32_t dbgmcu_ctrl;
+	/* System AXI-AP used to load the coprocessor's memories, held for the duration of an attach */
+	adiv5_access_port_s *axi_ap;
+	void (*cortexm_mem_read)(target_s *target, void *dest, target_addr_t src, size_t len);
+	void (*cortexm_mem_write)(target_s *target, target_addr_t dest, const void *src, size_t len);
 } stm32mp15_priv_s;
 
 static bool stm32mp15_uid(target_s *target, int argc, const char **argv);
 static bool stm32mp15_cmd_rev(target_s *target, int argc, const char **argv);
+static bool stm32mp15_cmd_copro(target_s *target, int argc, const char **argv);
 
 const command_s stm32mp15_cmd_list[] = {
 	{"uid", stm32mp15_uid, "Print unique device ID"},
 	{"revision", stm32mp15_cmd_rev, "Returns the Device ID and Revision"},
+	{"copro", stm32mp15_cmd_copro, "Hold the Cortex-M4 in reset for loading, or boot it: (hold|boot)"},
 	{NULL, NULL, NULL},
 };
 
+/*
+ * Translate a Cortex-M4 address range in RETRAM or the AHB SRAMs to the system (AXI) address map,
+ * returning 0 if the range is not entirely contained within one of those memories.
+ */
+static uint32_t stm32mp15_axi_address(const target_addr_t addr, const size_t len)
+{
+	/* Check the length against what's left of the memory so a range running off the top can't wrap around */
+	if (addr < STM32MP15_CM4_RETRAM_END && len <= STM32MP15_CM4_RETRAM_END - addr)
+		return STM32MP15_AXI_RETRAM_BASE + (addr - STM32MP15_CM4_RETRAM_BASE);
+	if (addr >= STM32MP15_CM4_AHBSRAM_BASE && addr < STM32MP15_CM4_AHBSRAM_END &&
+		len <= STM32MP15_CM4_AHBSRAM_END - addr)
+		return STM32MP15_AXI_AHBSRAM_BASE + (addr - STM32MP15_CM4_AHBSRAM_BASE);
+	return 0U;
+}
+
+/*
+ * Accesses to the coprocessor's RAMs go over the AXI-AP rather than through the Cortex-M4's AHB-AP.
+ * This keeps working while the M4 is held in reset for loading, allows large auto-incrementing bursts
+ * and never involves the Cortex-A7s, so Linux keeps running while new M4 firmware is loaded and verified.
+ */
+static void stm32mp15_mem_read(target_s *const target, void *const dest, const target_addr_t src, const size_t len)
+{
+	stm32mp15_priv_s *const priv = (stm32mp15_priv_s *)target->target_storage;
+	const uint32_t axi_src = stm32mp15_axi_address(src, len);
+	if (priv->axi_ap && axi_src)
+		adiv5_mem_read(priv->axi_ap, dest, axi_src, len);
+	else
+		priv->cortexm_mem_read(target, dest, src, len);
+}
+
+static void stm32mp15_mem_write(target_s *const target, const target_addr_t dest, const void *src, const size_t len)
+{
+	stm32mp15_priv_s *const priv = (stm32mp15_priv_s *)target->target_storage;
+	const uint32_t axi_dest = stm32mp15_axi_address(dest, len);
+	if (priv->axi_ap && axi_dest)
+		adiv5_mem_write(priv->axi_ap, axi_dest, src, len);
+	else
+		priv->cortexm_mem_write(target, dest, src, len);
+}
+
+static void stm32mp15_axi_ap_acquire(target_s *const target)
+{
+	stm32mp15_priv_s *const priv = (stm32mp15_priv_s *)target->target_storage;
+	adiv5_access_port_s *const ap = adiv5_new_ap(cortex_ap(target)->dp, STM32MP15_AXI_AP);
+	if (!ap)
+		return;
+	if (ADIV5_AP_IDR_CLASS(ap->idr) != ADIV5_AP_CLASS_MEM || ADIV5_AP_IDR_TYPE(ap->idr) != ARM_AP_TYPE_AXI) {
+		adiv5_ap_unref(ap);
+		return;
+	}
+	priv->axi_ap = ap;
+}
+
+static void stm32mp15_axi_ap_release(target_s *const target)
+{
+	stm32mp15_priv_s *const priv = (stm32mp15_priv_s *)target->target_storage;
+	if (!priv->axi_ap)
+		return;
+	adiv5_ap_unref(priv->axi_ap);
+	priv->axi_ap = NULL;
+}
+
 static bool stm32mp15_attach(target_s *target)
 {
 	if (!cortexm_attach(target))
@@ -80,6 +164,7 @@ static bool stm32mp15_attach(target_s *target)
 	/* Disable C-Sleep, C-Stop, C-Standby for debugging */
 	target_mem_write32(target, DBGMCU_CTRL, DBGMCU_CTRL_DBGSLEEP | DBGMCU_CTRL_DBGSTOP | DBGMCU_CTRL_DBGSTBY);
 
+	stm32mp15_axi_ap_acquire(target);
 	return true;
 }
 
@@ -87,6 +172,7 @@ static void stm32mp15_detach(target_s *target)
 {
 	stm32mp15_priv_s *priv = (stm32mp15_priv_s *)target->target_storage;
 	target_mem_write32(target, DBGMCU_CTRL, priv->dbgmcu_ctrl);
+	stm32mp15_axi_ap_release(target);
 	cortexm_detach(target);
 }
 
@@ -102,7 +188,15 @@ bool stm32mp15_cm4_probe(target_s *target)
 
 	/* Allocate private storage */
 	stm32mp15_priv_s *priv = calloc(1, sizeof(*priv));
+	if (!priv) { /* calloc failed: heap exhaustion */
+		DEBUG_ERROR("calloc: failed in %s\n", __func__);
+		return false;
+	}
 	target->target_storage = priv;
+	priv->cortexm_mem_read = target->mem_read;
+	priv->cortexm_mem_write = target->mem_write;
+	target->mem_read = stm32mp15_mem_read;
+	target->mem_write = stm32mp15_mem_write;
 
 	/* Figure 4. Memory map from §2.5.2 in RM0436 rev 6, pg158 */
 	target_add_ram(target, STM32MP15_CM4_RETRAM_BASE, STM32MP15_RETRAM_SIZE);
@@ -168,3 +262,43 @@ static bool stm32mp15_cmd_rev(target_s *target, int argc, const char **argv)
 
 	return true;
 }
+
+/*
+ * Coprocessor firmware loading: "hold" stops the Cortex-M4 and keeps it in reset so GDB's load can
+ * place the ELF segments into RETRAM and the AHB SRAMs over the AXI-AP, "boot" then lets it start.
+ * The M4 always boots from the vector table at the start of RETRAM, so there is no address to set up.
+ */
+static bool stm32mp15_cmd_copro(target_s *target, int argc, const char **argv)
+{
+	stm32mp15_priv_s *const priv = (stm32mp15_priv_s *)target->target_storage;
+	if (argc != 2) {
+		tc_printf(target, "usage: monitor copro (hold|boot)\n");
+		return false;
+	}
+	if (!priv->axi_ap) {
+		tc_printf(target, "AXI-AP not available, cannot control the Cortex-M4 boot\n");
+		return false;
+	}
+
+	uint32_t boot_mcu;
+	if (!strcmp(argv[1], "hold"))
+		boot_mcu = 0U;
+	else if (!strcmp(argv[1], "boot"))
+		boot_mcu = RCC_MP_GCR_BOOT_MCU;
+	else {
+		tc_printf(target, "usage: monitor copro (hold|boot)\n");
+		return false;
+	}
+
+	/*
+	 * RCC is driven over the AXI-AP as the M4's own AHB-AP is unusable while it is held in reset.
+	 * Pulsing the MCU reset after setting BOOT_MCU either parks the core or starts it from RETRAM.
+	 */
+	uint32_t value = 0;
+	adiv5_mem_read(priv->axi_ap, &value, RCC_MP_GCR, sizeof(value));
+	value = (value & ~RCC_MP_GCR_BOOT_MCU) | boot_mcu;
+	adiv5_mem_write(priv->axi_ap, RCC_MP_GCR, &value, sizeof(value));
+	value = RCC_MP_GRSTCSETR_MCU;
+	adiv5_mem_write(priv->axi_ap, RCC_MP_GRSTCSETR, &value, sizeof(value));
+	return !target_check_error(target);
+}
@@ -21,6 +21,7 @@
 #include "general.h"
 #include "target_internal.h"
 #include "gdb_packet.h"
+#include "buffer_utils.h"
 
 #include <stdarg.h>
 #include <unistd.h>
@@ -30,8 +31,18 @@ target_s *target_list = NULL;
 #define STDOUT_READ_BUF_SIZE       64U
 #define FLASH_WRITE_BUFFER_CEILING 1024U
 
+/* Fills and copies smaller than this aren't worth the setup cost of doing them on the target */
+#define TARGET_MEM_OFFLOAD_MIN 4096U
+#define TARGET_MEM_WORKSIZE    256U
+
+/* Memory access broker timing, see target_mem_access_begin() */
+#define TARGET_MEM_BROKER_IDLE_MS         10U  /* Resume once no access has come in for this long */
+#define TARGET_MEM_BROKER_MAX_HALT_MS     50U  /* Never hold the target halted for longer than this */
+#define TARGET_MEM_BROKER_HALT_TIMEOUT_MS 100U /* How long to wait for the target to halt */
+
 static bool target_cmd_mass_erase(target_s *target, int argc, const char **argv);
 static bool target_cmd_range_erase(target_s *target, int argc, const char **argv);
+static void target_mem_broker_release(target_s *target);
 
 const command_s target_cmd_list[] = {
 	{"erase_mass", target_cmd_mass_erase, "Erase whole device Flash"},
@@ -247,6 +258,9 @@ void target_print_progress(platform_timeout_s *const timeout)
 /* Wrapper functions */
 void target_detach(target_s *target)
 {
+	if (target->mem_broker.halted)
+		target_mem_broker_release(target);
+	target->mem_broker.pending_reason = TARGET_HALT_RUNNING;
 	if (target->detach)
 		target->detach(target);
 	platform_target_clk_output_enable(false);
@@ -287,9 +301,87 @@ int target_mem_write(target_s *t, target_addr_t dest, const void *src, size_t le
 
 bool target_mem_access_needs_halt(target_s *t)
 {
-	/* assume all arm processors allow memory access while running, and no riscv does. */
+	/*
+	 * Assume all arm processors allow memory access while running unless their driver says otherwise,
+	 * and no riscv does.
+	 */
 	bool is_riscv = t && t->core && strstr(t->core, "RVDBG");
-	return is_riscv;
+	return is_riscv || (t && t->mem_access_needs_halt);
+}
+
+static void target_mem_broker_release(target_s *const t)
+{
+	target_mem_broker_s *const broker = &t->mem_broker;
+	broker->halted = false;
+	const uint32_t halt_ms = platform_time_ms() - broker->halt_start_ms;
+	broker->total_halt_ms += halt_ms;
+	if (halt_ms > broker->max_halt_ms)
+		broker->max_halt_ms = halt_ms;
+	DEBUG_TARGET("Memory broker: %" PRIu32 " accesses in %" PRIu32 "ms halted, %" PRIu32 " halts totalling %" PRIu32
+				 "ms (max %" PRIu32 "ms)\n",
+		broker->accesses, halt_ms, broker->halt_count, broker->total_halt_ms, broker->max_halt_ms);
+}
+
+/*
+ * Memory access broker for targets that can only be accessed while halted. Call this before
+ * accessing memory on a target that is running as far as GDB is concerned. If the target needs
+ * halting, this halts it and then holds it halted while further accesses keep arriving so a burst
+ * of requests costs one halt/resume cycle. target_halt_poll() resumes the target once accesses stop
+ * for TARGET_MEM_BROKER_IDLE_MS or it has been held for TARGET_MEM_BROKER_MAX_HALT_MS. Callers that
+ * know their burst is over (such as RTT polling) should call target_mem_access_end() to resume it
+ * straight away instead. Returns true if memory can be accessed.
+ */
+bool target_mem_access_begin(target_s *const t)
+{
+	if (!target_mem_access_needs_halt(t))
+		return true;
+	if (!t->halt_request || !t->halt_poll || !t->halt_resume)
+		return false;
+	target_mem_broker_s *const broker = &t->mem_broker;
+	/* If the target stopped for real while we were getting it halted, it's staying that way */
+	if (broker->pending_reason != TARGET_HALT_RUNNING)
+		return broker->pending_reason != TARGET_HALT_ERROR;
+
+	/* Bound how long any one stop can last, letting the target run before halting it again */
+	if (broker->halted && platform_time_ms() - broker->halt_start_ms >= TARGET_MEM_BROKER_MAX_HALT_MS) {
+		target_mem_broker_release(t);
+		t->halt_resume(t, false);
+	}
+
+	if (!broker->halted) {
+		t->halt_request(t);
+		platform_timeout_s timeout;
+		platform_timeout_set(&timeout, TARGET_MEM_BROKER_HALT_TIMEOUT_MS);
+		target_addr_t watch = 0;
+		target_halt_reason_e reason = TARGET_HALT_RUNNING;
+		while (reason == TARGET_HALT_RUNNING && !platform_timeout_is_expired(&timeout))
+			reason = t->halt_poll(t, &watch);
+		if (reason == TARGET_HALT_RUNNING)
+			return false;
+		/* The target stopped on its own (breakpoint, fault, etc) before the request took, keep that for GDB */
+		if (reason != TARGET_HALT_REQUEST) {
+			broker->pending_reason = reason;
+			broker->pending_watch = watch;
+			return reason != TARGET_HALT_ERROR;
+		}
+		broker->halted = true;
+		broker->halt_start_ms = platform_time_ms();
+		broker->accesses = 0;
+		++broker->halt_count;
+	}
+	++broker->accesses;
+	broker->last_access_ms = platform_time_ms();
+	return true;
+}
+
+/* Let a target held halted by target_mem_access_begin() run again now rather than when it next goes idle */
+void target_mem_access_end(target_s *const t)
+{
+	target_mem_broker_s *const broker = &t->mem_broker;
+	if (!broker->halted || broker->pending_reason != TARGET_HALT_RUNNING)
+		return;
+	target_mem_broker_release(t);
+	t->halt_resume(t, false);
 }
 
 /* Register access functions */
@@ -336,12 +428,37 @@ void target_reset(target_s *t)
 
 void target_halt_request(target_s *t)
 {
+	/* If the memory access broker is holding the target halted, turn that into a real stop */
+	if (t->mem_broker.halted) {
+		target_mem_broker_release(t);
+		t->mem_broker.pending_reason = TARGET_HALT_REQUEST;
+		return;
+	}
 	if (t->halt_request)
 		t->halt_request(t);
 }
 
 target_halt_reason_e target_halt_poll(target_s *t, target_addr_t *watch)
 {
+	target_mem_broker_s *const broker = &t->mem_broker;
+	/* Report any stop the memory access broker saw first */
+	if (broker->pending_reason != TARGET_HALT_RUNNING) {
+		const target_halt_reason_e reason = broker->pending_reason;
+		broker->pending_reason = TARGET_HALT_RUNNING;
+		if (watch)
+			*watch = broker->pending_watch;
+		return reason;
+	}
+	/* While the broker holds the target halted it's still running as far as the caller is concerned */
+	if (broker->halted) {
+		const uint32_t now = platform_time_ms();
+		if (now - broker->last_access_ms >= TARGET_MEM_BROKER_IDLE_MS ||
+			now - broker->halt_start_ms >= TARGET_MEM_BROKER_MAX_HALT_MS) {
+			target_mem_broker_release(t);
+			t->halt_resume(t, false);
+		}
+		return TARGET_HALT_RUNNING;
+	}
 	if (t->halt_poll)
 		return t->halt_poll(t, watch);
 	/* XXX: Is this actually the desired fallback behaviour? */
@@ -350,6 +467,9 @@ target_halt_reason_e target_halt_poll(target_s *t, target_addr_t *watch)
 
 void target_halt_resume(target_s *t, bool step)
 {
+	if (t->mem_broker.halted)
+		target_mem_broker_release(t);
+	t->mem_broker.pending_reason = TARGET_HALT_RUNNING;
 	if (t->halt_resume)
 		t->halt_resume(t, step);
 }
@@ -540,6 +660,122 @@ void target_mem_write8(target_s *t, uint32_t addr, uint8_t value)
 		t->mem_write(t, addr, &value, sizeof(value));
 }
 
+/*
+ * Read len bytes from the register at src as a run of accesses of the given width, without advancing
+ * the address between them. This is for draining peripheral data FIFOs, and falls back to individual
+ * accesses if the target has no faster way to do this.
+ */
+void target_mem_read_fifo(target_s *t, void *dest, target_addr_t src, size_t len, align_e align)
+{
+	if (t->mem_read_fifo) {
+		t->mem_read_fifo(t, dest, src, len, align);
+		return;
+	}
+	if (!t->mem_read)
+		return;
+	const size_t width = 1U << align;
+	uint8_t *const data = (uint8_t *)dest;
+	for (size_t offset = 0; offset + width <= len; offset += width)
+		t->mem_read(t, data + offset, src, width);
+}
+
+/* As target_mem_read_fifo(), but filling the FIFO at dest from src */
+void target_mem_write_fifo(target_s *t, target_addr_t dest, const void *src, size_t len, align_e align)
+{
+	if (t->mem_write_fifo) {
+		t->mem_write_fifo(t, dest, src, len, align);
+		return;
+	}
+	if (!t->mem_write)
+		return;
+	const size_t width = 1U << align;
+	const uint8_t *const data = (const uint8_t *)src;
+	for (size_t offset = 0; offset + width <= len; offset += width)
+		t->mem_write(t, dest, data + offset, width);
+}
+
+/*
+ * Fill len bytes at dest with pattern, repeated every 1, 2 or 4 bytes as given by width. Large fills are
+ * handed to the target to carry out if it can, leaving only the unaligned ends to be written over the link.
+ */
+int target_mem_fill(target_s *t, target_addr_t dest, uint32_t pattern, align_e width, size_t len)
+{
+	if (!t->mem_write)
+		return target_check_error(t);
+	/* Expand the pattern to a word, and that to a buffer of the bytes as they should appear from dest */
+	if (width == ALIGN_8BIT)
+		pattern = (pattern & 0xffU) * 0x01010101U;
+	else if (width == ALIGN_16BIT)
+		pattern = (pattern & 0xffffU) * 0x00010001U;
+	uint8_t data[TARGET_MEM_WORKSIZE];
+	for (size_t offset = 0; offset < sizeof(data); offset += 4U)
+		write_le4(data, offset, pattern);
+
+	size_t offset = 0;
+	if (t->mem_fill && len >= TARGET_MEM_OFFLOAD_MIN) {
+		/* The target only fills whole words, so write up to the first word boundary ourselves */
+		offset = (4U - (dest & 3U)) & 3U;
+		if (offset)
+			t->mem_write(t, dest, data, offset);
+		const size_t words = (len - offset) & ~3U;
+		if (t->mem_fill(t, dest + offset, read_le4(data, offset), words))
+			offset += words;
+		else
+			offset = 0;
+	}
+	/* Whatever's left of the fill goes over the link, keeping the pattern phase relative to dest */
+	while (offset < len) {
+		const size_t phase = offset & 3U;
+		const size_t chunk = MIN(len - offset, sizeof(data) - phase);
+		t->mem_write(t, dest + offset, data + phase, chunk);
+		offset += chunk;
+	}
+	return target_check_error(t);
+}
+
+/* Copy len bytes from src to dest in target memory, behaving like memmove() for overlapping blocks */
+int target_mem_copy(target_s *t, target_addr_t dest, target_addr_t src, size_t len)
+{
+	if (!t->mem_read || !t->mem_write || dest == src)
+		return target_check_error(t);
+	if (t->mem_copy && len >= TARGET_MEM_OFFLOAD_MIN) {
+		const int result = t->mem_copy(t, dest, src, len);
+		if (result == 0)
+			return target_check_error(t);
+		/*
+		 * If the target got part way through an overlapping copy, some of the source may already have been
+		 * overwritten, so starting over across the link would corrupt the block further. Report the failure.
+		 */
+		if (result < 0) {
+			DEBUG_ERROR("On-target copy failed part way through\n");
+			return -1;
+		}
+	}
+	/* Otherwise bounce it through a buffer, from the top down if that's what the overlap needs */
+	uint8_t data[TARGET_MEM_WORKSIZE];
+	const bool descending = dest > src;
+	for (size_t done = 0; done < len;) {
+		const size_t chunk = MIN(len - done, sizeof(data));
+		const size_t offset = descending ? len - done - chunk : done;
+		t->mem_read(t, data, src + offset, chunk);
+		t->mem_write(t, dest + offset, data, chunk);
+		done += chunk;
+	}
+	return target_check_error(t);
+}
+
+/*
+ * Destructively test len bytes of RAM at start, both word aligned. This returns how many faults were found and
+ * recorded in faults, at most one per block tested and no more than max_faults, or SIZE_MAX if the target can't
+ * run the test.
+ */
+size_t target_mem_test(target_s *t, target_addr_t start, size_t len, target_mem_fault_s *faults, size_t max_faults)
+{
+	if (!t->mem_test || !len || !max_faults || ((start | len) & 3U))
+		return SIZE_MAX;
+	return t->mem_test(t, start, len, faults, max_faults);
+}
+
 void target_command_help(target_s *t)
 {
 	for (const target_command_s *tc = t->commands; tc; tc = tc->next) {
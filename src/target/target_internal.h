@@ -99,6 +99,30 @@ struct breakwatch {
 
 #define MAX_CMDLINE 81
 
+/* State for the run-time memory access broker, see target_mem_access_begin() */
+typedef struct target_mem_broker {
+	bool halted;                         /* The broker is holding the target halted */
+	target_halt_reason_e pending_reason; /* A stop the broker saw that has yet to be reported */
+	target_addr_t pending_watch;
+	uint32_t halt_start_ms;
+	uint32_t last_access_ms;
+	uint32_t accesses;
+	/* Accounting for how much the broker has perturbed the target */
+	uint32_t halt_count;
+	uint32_t total_halt_ms;
+	uint32_t max_halt_ms;
+} target_mem_broker_s;
+
+/* A RAM test failure, see target_mem_test() */
+typedef struct target_mem_fault {
+	target_addr_t addr;
+	uint32_t expected;
+	uint32_t actual;
+} target_mem_fault_s;
+
+/* Faults beyond this many aren't going to tell anyone any more about what's wrong */
+#define MEMTEST_MAX_FAULTS 16U
+
 struct target {
 	target_controller_s *tc;
 
@@ -108,8 +132,20 @@ struct target {
 	bool (*check_error)(target_s *target);
 
 	/* Memory access functions */
+	bool mem_access_needs_halt;
+	target_mem_broker_s mem_broker;
 	void (*mem_read)(target_s *target, void *dest, target_addr_t src, size_t len);
 	void (*mem_write)(target_s *target, target_addr_t dest, const void *src, size_t len);
+	/* Optional repeated access to a single address (peripheral FIFOs), see target_mem_read_fifo() */
+	void (*mem_read_fifo)(target_s *target, void *dest, target_addr_t src, size_t len, align_e align);
+	void (*mem_write_fifo)(target_s *target, target_addr_t dest, const void *src, size_t len, align_e align);
+	/* Optional on-target fill, returning false if not possible here, see target_mem_fill() */
+	bool (*mem_fill)(target_s *target, target_addr_t dest, uint32_t pattern, size_t len);
+	/* Optional on-target copy, returning 0 if done, 1 if not possible here or -1 if it failed part way */
+	int (*mem_copy)(target_s *target, target_addr_t dest, target_addr_t src, size_t len);
+	/* Optional on-target RAM test, see target_mem_test() */
+	size_t (*mem_test)(
+		target_s *target, target_addr_t start, size_t len, target_mem_fault_s *faults, size_t max_faults);
 
 	/* Register access functions */
 	size_t regs_size;
@@ -196,6 +232,11 @@ uint8_t target_mem_read8(target_s *target, uint32_t addr);
 void target_mem_write32(target_s *target, uint32_t addr, uint32_t value);
 void target_mem_write16(target_s *target, uint32_t addr, uint16_t value);
 void target_mem_write8(target_s *target, uint32_t addr, uint8_t value);
+void target_mem_read_fifo(target_s *target, void *dest, target_addr_t src, size_t len, align_e align);
+void target_mem_write_fifo(target_s *target, target_addr_t dest, const void *src, size_t len, align_e align);
+int target_mem_fill(target_s *target, target_addr_t dest, uint32_t pattern, align_e width, size_t len);
+int target_mem_copy(target_s *target, target_addr_t dest, target_addr_t src, size_t len);
+size_t target_mem_test(target_s *target, target_addr_t start, size_t len, target_mem_fault_s *faults, size_t max_faults);
 bool target_check_error(target_s *target);
 
 /* Access to host controller interface */
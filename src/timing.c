@@ -20,6 +20,30 @@
 
 #include "general.h"
 
+#if PC_HOSTED == 1
+void platform_timeout_set(platform_timeout_s *const t, uint32_t ms)
+{
+	if (ms < SYSTICKMS)
+		ms = SYSTICKMS;
+	t->time = platform_time_us() + (ms * UINT64_C(1000));
+}
+
+void platform_timeout_set_us(platform_timeout_s *const t, const uint32_t us)
+{
+	t->time = platform_time_us() + us;
+}
+
+bool platform_timeout_is_expired(const platform_timeout_s *const t)
+{
+	return platform_time_us() > t->time;
+}
+
+uint64_t platform_timeout_remaining_us(const platform_timeout_s *const t)
+{
+	const uint64_t now = platform_time_us();
+	return now < t->time ? t->time - now : 0U;
+}
+#else
 void platform_timeout_set(platform_timeout_s *const t, uint32_t ms)
 {
 	if (ms < SYSTICKMS)
@@ -31,3 +55,4 @@ bool platform_timeout_is_expired(const platform_timeout_s *const t)
 {
 	return platform_time_ms() > t->time;
 }
+#endif